@@ -0,0 +1,56 @@
+#pragma once
+#include "AstNode.h"
+#include "semantic/Symbol.h"
+#include <llvm/Support/Allocator.h>
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// 1回のコンパイルで作るASTノードをまとめて持つアリーナ
+// ノードは1つずつnewせずにcreateで確保し、AstContextを破棄したときにまとめて解放する
+// ノード同士や、ノードからシンボルへは生ポインタでつなぐので、ASTを使い終わるまでAstContextを生かしておくこと
+class AstContext{
+private:
+    llvm::BumpPtrAllocator allocator;
+    std::vector<AstNode*> nodes; // std::stringなどを持つノードのデストラクタを呼ぶため
+    // ノードが指すシンボル (意味解析はワーカースレッドからも作るのでロックする)
+    std::mutex symbolsMutex;
+    std::vector<std::unique_ptr<Symbol>> symbols;
+public:
+    AstContext() = default;
+    AstContext(const AstContext&) = delete;
+    AstContext& operator=(const AstContext&) = delete;
+    ~AstContext(){
+        for(auto it = nodes.rbegin(); it != nodes.rend(); ++it) (*it)->~AstNode();
+    }
+
+    template<typename T, typename... Args>
+    T* create(Args&&... args){
+        T* node = new (allocator.Allocate<T>()) T(std::forward<Args>(args)...);
+        nodes.push_back(node);
+        return node;
+    }
+    // シンボルを作ってAstContextに持たせる (ノードやSymbolTableは生ポインタで指す)
+    template<typename T, typename... Args>
+    T* createSymbol(Args&&... args){
+        auto symbol = std::make_unique<T>(std::forward<Args>(args)...);
+        T* raw = symbol.get();
+        std::lock_guard<std::mutex> lock(symbolsMutex);
+        symbols.push_back(std::move(symbol));
+        return raw;
+    }
+    // 子ノードの並びをアリーナにコピーする (パース中はstd::vectorに集めておく)
+    template<typename T>
+    AstList<T> copyList(const std::vector<T*>& list){
+        if(list.empty()) return {};
+        T** data = allocator.Allocate<T*>(list.size());
+        std::copy(list.begin(), list.end(), data);
+        return AstList<T>(data, list.size());
+    }
+
+    size_t getNodeCount() const {return nodes.size();}
+    size_t getBytesAllocated() const {return allocator.getBytesAllocated();}
+};
@@ -1,4 +1,8 @@
 #pragma once
+#include "common/SourceManager.h"
+#include "common/StringInterner.h"
+#include <cstdint>
+#include <span>
 #include <string>
 #include <iostream> // std::cout, std::endl を使用するため
 
@@ -9,9 +13,51 @@ inline void printIndent(int indent) {
     }
 }
 
+// 子ノードの並び (AstContextのアリーナ上の配列を指す)
+template<typename T>
+using AstList = std::span<T*>;
+
+// ノードの種類 (dynamic_castせずに判別する。llvm::isa/cast/dyn_castは各ノードのclassofでこれを見る)
+// 文と式はそれぞれ連続して並べ、First/Lastで範囲を判定する
+enum class AstKind : uint8_t{
+    Program,
+    Block,
+    // 文 (StatementNode)
+    VarDecl,
+    ArrayDecl,
+    Assignment,
+    If,
+    For,
+    ExprStatement,
+    Return,
+    FunctionDef,
+    FirstStatement = VarDecl,
+    LastStatement = FunctionDef,
+    // 式 (ExprNode)
+    NumberLiteral,
+    DecimalLiteral,
+    ArrayLiteral,
+    VariableRef,
+    ArrayRef,
+    BinaryOp,
+    FunctionCall,
+    Cast,
+    FirstExpr = NumberLiteral,
+    LastExpr = Cast,
+};
+
+// ノードはAstContext::createで確保し、AstContextがまとめて解放する
 class AstNode{
+private:
+    const AstKind kind;
+    SourceLocation loc; // ノードの先頭のトークンの位置 (kindの後ろの隙間に入るのでノードは大きくならない)
+protected:
+    explicit AstNode(AstKind k) : kind(k) {}
 public:
     virtual ~AstNode() = default;
+    AstKind getKind() const {return kind;}
+    SourceLocation getLocation() const {return loc;}
+    void setLocation(SourceLocation l) {loc = l;}
     // ASTノードの情報を出力する仮想メソッド
-    virtual void dump(int indent = 0) const = 0;
+    virtual void dump(const StringInterner& names, int indent = 0) const = 0;
 };
\ No newline at end of file
@@ -0,0 +1,609 @@
+#include "AstSerializer.h"
+#include "AstVisitor.h"
+#include "ast/AstContext.h"
+#include "ast/Definition.h"
+#include "ast/Expression.h"
+#include "ast/Statement.h"
+#include "driver/CompilerInstance.h"
+#include "semantic/Symbol.h"
+#include "types/TypeContext.h"
+#include <llvm/Support/Casting.h>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+static constexpr char Magic[4] = {'L', 'A', 'S', 'T'};
+
+static void writeVarint(std::string& out, uint64_t value){
+    while(value >= 0x80){
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+// 負の数も短くなるようにzigzagで符号を最下位ビットに移す
+static uint64_t zigzag(int64_t value){
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+static int64_t unzigzag(uint64_t value){
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+namespace{
+
+// ASTを後順にたどって表を作る (各visitは書いたノードの添字を返す)
+class AstWriter : public AstVisitor<AstWriter, uint32_t, uint32_t>{
+    friend class AstVisitor<AstWriter, uint32_t, uint32_t>;
+private:
+    const StringInterner& names;
+    std::string stringsOut, typesOut, symbolsOut, nodesOut;
+    std::unordered_map<std::string_view, uint32_t> stringIndex; // キーはASTの文字列・文字列表の文字列を指す
+    std::unordered_map<const TypeNode*, uint32_t> typeIndex;
+    std::unordered_map<const Symbol*, uint32_t> symbolIndex;
+    uint32_t stringCount = 1; // 0番は空文字列
+    uint32_t nodeCount = 0;
+
+    uint32_t stringRef(std::string_view text){
+        if(text.empty()) return 0;
+        auto [it, inserted] = stringIndex.try_emplace(text, stringCount);
+        if(inserted){
+            writeVarint(stringsOut, text.size());
+            stringsOut.append(text);
+            stringCount++;
+        }
+        return it->second;
+    }
+    uint32_t stringRef(NameId name) {return name.empty() ? 0 : stringRef(std::string_view(names.str(name)));}
+
+    uint32_t typeRef(const TypeNode* type){
+        if(!type) return 0;
+        if(auto it = typeIndex.find(type); it != typeIndex.end()) return it->second;
+        std::string record;
+        record.push_back(static_cast<char>(type->getKind()));
+        if(type->getKind() == TypeKind::Array){
+            auto arrayType = static_cast<const ArrayTypeNode*>(type);
+            writeVarint(record, typeRef(arrayType->elementType)); // 要素の型を先に書く
+            writeVarint(record, arrayType->size);
+        }else{
+            writeVarint(record, stringRef(type->getTypeName()));
+        }
+        typesOut += record;
+        uint32_t index = static_cast<uint32_t>(typeIndex.size()) + 1;
+        typeIndex.emplace(type, index);
+        return index;
+    }
+
+    uint32_t symbolRef(const Symbol* symbol){
+        if(!symbol) return 0;
+        if(auto it = symbolIndex.find(symbol); it != symbolIndex.end()) return it->second;
+        std::string record;
+        record.push_back(static_cast<char>(symbol->kind));
+        writeVarint(record, stringRef(symbol->name));
+        writeVarint(record, typeRef(symbol->type));
+        writeVarint(record, symbol->scopeDepth);
+        if(symbol->kind == SymbolKind::FUNC){
+            // 引数のシンボルは本体のVariableRefNodeと同じものなので、添字で参照する
+            auto funcSymbol = static_cast<const FuncSymbol*>(symbol);
+            writeVarint(record, funcSymbol->parameters.size());
+            for(const auto& param : funcSymbol->parameters) writeVarint(record, symbolRef(param));
+        }
+        symbolsOut += record;
+        uint32_t index = static_cast<uint32_t>(symbolIndex.size()) + 1;
+        symbolIndex.emplace(symbol, index);
+        return index;
+    }
+
+    // ノードの先頭 (種類と位置)。子の添字はこれより前に求めておくこと
+    uint32_t begin(const AstNode* node){
+        nodesOut.push_back(static_cast<char>(node->getKind()));
+        SourceLocation loc = node->getLocation();
+        writeVarint(nodesOut, loc.isValid() ? static_cast<uint64_t>(loc.getOffset()) + 1 : 0);
+        return ++nodeCount;
+    }
+    uint32_t beginExpr(const ExprNode* node){
+        uint32_t type = typeRef(node->type);
+        uint32_t index = begin(node);
+        writeVarint(nodesOut, type);
+        return index;
+    }
+    void list(const std::vector<uint32_t>& children){
+        writeVarint(nodesOut, children.size());
+        for(uint32_t child : children) writeVarint(nodesOut, child);
+    }
+    uint32_t ref(ExprNode* node) {return node ? dispatch(node) : 0;}
+    uint32_t ref(StatementNode* node) {return node ? dispatch(node) : 0;}
+    uint32_t ref(BlockNode* node) {return node ? visit(node) : 0;}
+    template<typename T>
+    std::vector<uint32_t> refs(AstList<T> nodes){
+        std::vector<uint32_t> children;
+        children.reserve(nodes.size());
+        for(T* node : nodes) children.push_back(ref(node));
+        return children;
+    }
+
+    // 式
+    uint32_t visit(NumberLiteralNode* node){
+        uint32_t index = beginExpr(node);
+        writeVarint(nodesOut, zigzag(node->value));
+        return index;
+    }
+    uint32_t visit(DecimalLiteralNode* node){
+        uint32_t index = beginExpr(node);
+        char bytes[sizeof(double)];
+        std::memcpy(bytes, &node->value, sizeof(double));
+        nodesOut.append(bytes, sizeof(double));
+        return index;
+    }
+    uint32_t visit(ArrayLiteralNode* node){
+        auto elem = refs(node->elem);
+        uint32_t index = beginExpr(node);
+        list(elem);
+        return index;
+    }
+    uint32_t visit(VariableRefNode* node){
+        uint32_t name = stringRef(node->name), symbol = symbolRef(node->symbol);
+        uint32_t index = beginExpr(node);
+        writeVarint(nodesOut, name);
+        writeVarint(nodesOut, symbol);
+        return index;
+    }
+    uint32_t visit(ArrayRefNode* node){
+        uint32_t name = stringRef(node->name), idx = ref(node->idx), symbol = symbolRef(node->symbol);
+        uint32_t index = beginExpr(node);
+        writeVarint(nodesOut, name);
+        writeVarint(nodesOut, idx);
+        writeVarint(nodesOut, symbol);
+        return index;
+    }
+    uint32_t visit(BinaryOpNode* node){
+        uint32_t op = stringRef(node->op), left = ref(node->left), right = ref(node->right);
+        uint32_t index = beginExpr(node);
+        writeVarint(nodesOut, op);
+        writeVarint(nodesOut, left);
+        writeVarint(nodesOut, right);
+        return index;
+    }
+    uint32_t visit(FunctionCallNode* node){
+        uint32_t callee = stringRef(node->calleeName);
+        auto args = refs(node->args);
+        uint32_t symbol = symbolRef(node->symbol);
+        uint32_t index = beginExpr(node);
+        writeVarint(nodesOut, callee);
+        list(args);
+        writeVarint(nodesOut, symbol);
+        return index;
+    }
+    uint32_t visit(CastNode* node){
+        uint32_t expression = ref(node->expression);
+        uint32_t index = beginExpr(node);
+        writeVarint(nodesOut, expression);
+        return index;
+    }
+
+    // 文
+    uint32_t visit(VarDeclNode* node){
+        uint32_t name = stringRef(node->varName), initializer = ref(node->initializer), type = typeRef(node->type), symbol = symbolRef(node->symbol);
+        uint32_t index = begin(node);
+        writeVarint(nodesOut, name);
+        writeVarint(nodesOut, initializer);
+        writeVarint(nodesOut, type);
+        writeVarint(nodesOut, symbol);
+        return index;
+    }
+    uint32_t visit(ArrayDeclNode* node){
+        uint32_t name = stringRef(node->arrayName), type = typeRef(node->type), initializer = ref(node->initializer), symbol = symbolRef(node->symbol);
+        uint32_t index = begin(node);
+        writeVarint(nodesOut, name);
+        writeVarint(nodesOut, type);
+        writeVarint(nodesOut, node->size);
+        writeVarint(nodesOut, initializer);
+        writeVarint(nodesOut, symbol);
+        return index;
+    }
+    uint32_t visit(AssignmentNode* node){
+        uint32_t name = stringRef(node->varName), value = ref(node->value), symbol = symbolRef(node->symbol);
+        uint32_t index = begin(node);
+        writeVarint(nodesOut, name);
+        writeVarint(nodesOut, value);
+        writeVarint(nodesOut, symbol);
+        return index;
+    }
+    uint32_t visit(IfNode* node){
+        uint32_t condition = ref(node->condition), ifBlock = ref(node->if_block), elseBlock = ref(node->else_block);
+        uint32_t index = begin(node);
+        writeVarint(nodesOut, condition);
+        writeVarint(nodesOut, ifBlock);
+        writeVarint(nodesOut, elseBlock);
+        return index;
+    }
+    uint32_t visit(ForNode* node){
+        uint32_t condition = ref(node->condition), block = ref(node->block);
+        uint32_t index = begin(node);
+        writeVarint(nodesOut, condition);
+        writeVarint(nodesOut, block);
+        return index;
+    }
+    uint32_t visit(ExprStatementNode* node){
+        uint32_t expression = ref(node->expression);
+        uint32_t index = begin(node);
+        writeVarint(nodesOut, expression);
+        return index;
+    }
+    uint32_t visit(ReturnNode* node){
+        uint32_t value = ref(node->returnValue);
+        uint32_t index = begin(node);
+        writeVarint(nodesOut, value);
+        return index;
+    }
+    uint32_t visit(FunctionDefNode* node){
+        uint32_t name = stringRef(node->name);
+        std::vector<uint32_t> args, argTypes;
+        for(NameId arg : node->args) args.push_back(stringRef(arg));
+        for(TypeNode* argType : node->argTypes) argTypes.push_back(typeRef(argType));
+        uint32_t body = ref(node->body), returnType = typeRef(node->returnType), symbol = symbolRef(node->symbol);
+        uint32_t index = begin(node);
+        writeVarint(nodesOut, name);
+        list(args);
+        list(argTypes);
+        writeVarint(nodesOut, body);
+        writeVarint(nodesOut, returnType);
+        writeVarint(nodesOut, symbol);
+        return index;
+    }
+public:
+    explicit AstWriter(const StringInterner& nameTable) : names(nameTable) {}
+    uint32_t visit(BlockNode* node){
+        auto statements = refs(node->statements);
+        uint32_t index = begin(node);
+        list(statements);
+        return index;
+    }
+    uint32_t visit(ProgramNode* node){
+        auto statements = refs(node->statements);
+        uint32_t index = begin(node);
+        list(statements);
+        return index;
+    }
+    std::string finish() const {
+        std::string out(Magic, sizeof(Magic));
+        writeVarint(out, AstSerializer::Version);
+        writeVarint(out, stringCount);
+        writeVarint(out, typeIndex.size());
+        writeVarint(out, symbolIndex.size());
+        writeVarint(out, nodeCount);
+        out.reserve(out.size() + stringsOut.size() + typesOut.size() + symbolsOut.size() + nodesOut.size());
+        out += stringsOut;
+        out += typesOut;
+        out += symbolsOut;
+        out += nodesOut;
+        return out;
+    }
+};
+
+// 表を前から読み、ノードを作る
+// 範囲外の添字・種類の合わない子・途中で終わるデータはすべてfailedにする (ASTは返さない)
+class AstReader{
+private:
+    const uint8_t* pos;
+    const uint8_t* end;
+    bool failed = false;
+    AstContext& context;
+    StringInterner& names;
+    TypeContext& types;
+    std::vector<std::string_view> strings; // dataを指す
+    std::vector<NameId> nameIds;
+    std::vector<TypeNode*> typeTable;
+    std::vector<Symbol*> symbols;
+    std::vector<AstNode*> nodes;
+
+    uint8_t byte(){
+        if(pos >= end){
+            failed = true;
+            return 0;
+        }
+        return *pos++;
+    }
+    uint64_t varint(){
+        uint64_t value = 0;
+        for(unsigned shift = 0; shift < 64; shift += 7){
+            uint8_t b = byte();
+            value |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if(!(b & 0x80)) return value;
+        }
+        failed = true;
+        return 0;
+    }
+    // 表の大きさ (残りのバイト数より多いものは壊れている)
+    uint32_t count(){
+        uint64_t n = varint();
+        if(n > static_cast<uint64_t>(end - pos) + 1){
+            failed = true;
+            return 0;
+        }
+        return static_cast<uint32_t>(n);
+    }
+    uint32_t index(size_t size){
+        uint64_t i = varint();
+        if(i > size){
+            failed = true;
+            return 0;
+        }
+        return static_cast<uint32_t>(i);
+    }
+    std::string_view text() {return strings[index(strings.size() - 1)];}
+    NameId name() {return nameIds[index(nameIds.size() - 1)];}
+    TypeNode* type(){
+        uint32_t i = index(typeTable.size());
+        return i ? typeTable[i - 1] : nullptr;
+    }
+    Symbol* symbol(){
+        uint32_t i = index(symbols.size());
+        return i ? symbols[i - 1] : nullptr;
+    }
+    FuncSymbol* funcSymbol(){
+        auto sym = symbol();
+        if(!sym) return nullptr;
+        if(sym->kind != SymbolKind::FUNC){
+            failed = true;
+            return nullptr;
+        }
+        return static_cast<FuncSymbol*>(sym);
+    }
+    // 子のノード (optionalでなければnullptrは壊れている)
+    template<typename T>
+    T* node(bool optional = false){
+        uint32_t i = index(nodes.size());
+        if(i == 0){
+            if(!optional) failed = true;
+            return nullptr;
+        }
+        T* child = llvm::dyn_cast<T>(nodes[i - 1]);
+        if(!child) failed = true;
+        return child;
+    }
+    template<typename T>
+    AstList<T> nodeList(){
+        uint32_t n = count();
+        std::vector<T*> list;
+        list.reserve(n);
+        for(uint32_t i = 0; i < n && !failed; i++) list.push_back(node<T>());
+        return context.copyList(list);
+    }
+
+    bool readStrings(uint32_t n){
+        if(n == 0) return false;
+        strings.reserve(n);
+        nameIds.reserve(n);
+        strings.emplace_back();
+        nameIds.emplace_back();
+        for(uint32_t i = 1; i < n && !failed; i++){
+            uint64_t length = varint();
+            if(length > static_cast<uint64_t>(end - pos)) return false;
+            std::string_view s(reinterpret_cast<const char*>(pos), length);
+            pos += length;
+            strings.push_back(s);
+            nameIds.push_back(names.intern(s));
+        }
+        return !failed;
+    }
+    bool readTypes(uint32_t n){
+        typeTable.reserve(n);
+        for(uint32_t i = 0; i < n && !failed; i++){
+            auto kind = static_cast<TypeKind>(byte());
+            if(kind == TypeKind::Array){
+                TypeNode* elementType = type();
+                uint64_t size = varint();
+                if(!elementType) return false;
+                typeTable.push_back(types.getArrayType(elementType, size));
+            }else if(kind == TypeKind::Basic){
+                typeTable.push_back(types.getBasicType(text()));
+            }else{
+                return false;
+            }
+        }
+        return !failed;
+    }
+    bool readSymbols(uint32_t n){
+        symbols.reserve(n);
+        for(uint32_t i = 0; i < n && !failed; i++){
+            auto kind = static_cast<SymbolKind>(byte());
+            NameId symbolName = name();
+            TypeNode* symbolType = type();
+            auto depth = static_cast<uint32_t>(varint());
+            switch(kind){
+                case SymbolKind::VAR: symbols.push_back(context.createSymbol<VarSymbol>(symbolName, symbolType, depth)); break;
+                case SymbolKind::ARRAY: symbols.push_back(context.createSymbol<ArraySymbol>(symbolName, symbolType, depth)); break;
+                case SymbolKind::TYPE: symbols.push_back(context.createSymbol<TypeSymbol>(symbolName, symbolType, depth)); break;
+                case SymbolKind::FUNC:{
+                    // 引数のシンボルは関数より先に書かれている
+                    auto funcSymbol = context.createSymbol<FuncSymbol>(symbolName, symbolType, depth);
+                    uint32_t params = count();
+                    for(uint32_t p = 0; p < params && !failed; p++){
+                        auto param = symbol();
+                        if(!param || param->kind != SymbolKind::VAR) return false;
+                        funcSymbol->addParameter(static_cast<VarSymbol*>(param));
+                    }
+                    symbols.push_back(funcSymbol);
+                    break;
+                }
+                case SymbolKind::UNKNOWN: symbols.push_back(context.createSymbol<Symbol>(symbolName, kind, symbolType, depth)); break;
+                default: return false;
+            }
+        }
+        return !failed;
+    }
+
+    template<typename T, typename... Args>
+    T* create(SourceLocation loc, Args&&... args){
+        T* node = context.create<T>(std::forward<Args>(args)...);
+        node->setLocation(loc);
+        return node;
+    }
+    AstNode* readNode(){
+        auto kind = static_cast<AstKind>(byte());
+        uint64_t rawLoc = varint();
+        SourceLocation loc = rawLoc ? SourceLocation::fromOffset(static_cast<uint32_t>(rawLoc - 1)) : SourceLocation();
+        TypeNode* exprType = nullptr;
+        if(kind >= AstKind::FirstExpr && kind <= AstKind::LastExpr) exprType = type();
+        ExprNode* expr = nullptr;
+        switch(kind){
+            case AstKind::Program:{
+                auto program = create<ProgramNode>(loc);
+                program->statements = nodeList<StatementNode>();
+                return program;
+            }
+            case AstKind::Block:{
+                auto block = create<BlockNode>(loc);
+                block->statements = nodeList<StatementNode>();
+                return block;
+            }
+            case AstKind::VarDecl:{
+                NameId varName = name();
+                auto initializer = node<ExprNode>(true);
+                TypeNode* varType = type();
+                auto decl = create<VarDeclNode>(loc, varName, varType, initializer);
+                decl->symbol = symbol();
+                return decl;
+            }
+            case AstKind::ArrayDecl:{
+                NameId arrayName = name();
+                TypeNode* elementType = type();
+                uint64_t size = varint();
+                auto decl = create<ArrayDeclNode>(loc, arrayName, elementType, static_cast<size_t>(size));
+                decl->initializer = node<ExprNode>(true);
+                decl->symbol = symbol();
+                return decl;
+            }
+            case AstKind::Assignment:{
+                NameId varName = name();
+                auto value = node<ExprNode>();
+                auto assignment = create<AssignmentNode>(loc, varName, value);
+                assignment->symbol = symbol();
+                return assignment;
+            }
+            case AstKind::If:{
+                auto condition = node<ExprNode>();
+                auto ifBlock = node<BlockNode>();
+                auto elseBlock = node<BlockNode>(true);
+                return create<IfNode>(loc, condition, ifBlock, elseBlock);
+            }
+            case AstKind::For:{
+                auto condition = node<ExprNode>();
+                auto block = node<BlockNode>();
+                return create<ForNode>(loc, condition, block);
+            }
+            case AstKind::ExprStatement:
+                return create<ExprStatementNode>(loc, node<ExprNode>(true));
+            case AstKind::Return:
+                return create<ReturnNode>(loc, node<ExprNode>(true));
+            case AstKind::FunctionDef:{
+                NameId funcName = name();
+                std::vector<NameId> args(count());
+                for(auto& arg : args) arg = name();
+                std::vector<TypeNode*> argTypes(count());
+                for(auto& argType : argTypes) argType = type();
+                auto body = node<BlockNode>();
+                TypeNode* returnType = type();
+                auto symbol = funcSymbol();
+                // 解析済みの関数定義には必ずシンボルがあり、引数の名前・型・シンボルの引数の数はそろっている
+                if(!symbol || args.size() != argTypes.size() || args.size() != symbol->parameters.size()){
+                    failed = true;
+                    return nullptr;
+                }
+                auto def = create<FunctionDefNode>(loc, funcName, args, argTypes, body, returnType);
+                def->symbol = symbol;
+                return def;
+            }
+            case AstKind::NumberLiteral:
+                expr = create<NumberLiteralNode>(loc, static_cast<int>(unzigzag(varint())));
+                break;
+            case AstKind::DecimalLiteral:{
+                double value = 0.0;
+                if(end - pos < static_cast<std::ptrdiff_t>(sizeof(double))){
+                    failed = true;
+                }else{
+                    std::memcpy(&value, pos, sizeof(double));
+                    pos += sizeof(double);
+                }
+                expr = create<DecimalLiteralNode>(loc, value);
+                break;
+            }
+            case AstKind::ArrayLiteral:
+                expr = create<ArrayLiteralNode>(loc, nodeList<ExprNode>());
+                break;
+            case AstKind::VariableRef:{
+                auto ref = create<VariableRefNode>(loc, name());
+                ref->symbol = symbol();
+                expr = ref;
+                break;
+            }
+            case AstKind::ArrayRef:{
+                NameId arrayName = name();
+                auto idx = node<ExprNode>();
+                auto ref = create<ArrayRefNode>(loc, arrayName, idx);
+                ref->symbol = symbol();
+                expr = ref;
+                break;
+            }
+            case AstKind::BinaryOp:{
+                std::string op(text());
+                auto left = node<ExprNode>();
+                auto right = node<ExprNode>();
+                expr = create<BinaryOpNode>(loc, op, left, right);
+                break;
+            }
+            case AstKind::FunctionCall:{
+                NameId callee = name();
+                auto args = nodeList<ExprNode>();
+                auto call = create<FunctionCallNode>(loc, callee, args);
+                call->symbol = funcSymbol();
+                expr = call;
+                break;
+            }
+            case AstKind::Cast:{
+                auto expression = node<ExprNode>();
+                expr = create<CastNode>(loc, expression, exprType);
+                break;
+            }
+            default:
+                failed = true;
+                return nullptr;
+        }
+        expr->type = exprType;
+        return expr;
+    }
+public:
+    AstReader(std::string_view data, CompilerInstance& compiler)
+        : pos(reinterpret_cast<const uint8_t*>(data.data())), end(pos + data.size()),
+          context(compiler.getAstContext()), names(compiler.getNameTable()), types(compiler.getTypeContext()) {}
+    ProgramNode* read(){
+        if(end - pos < static_cast<std::ptrdiff_t>(sizeof(Magic)) || std::memcmp(pos, Magic, sizeof(Magic)) != 0) return nullptr;
+        pos += sizeof(Magic);
+        if(varint() != AstSerializer::Version) return nullptr;
+        uint32_t stringCount = count(), typeCount = count(), symbolCount = count(), nodeCount = count();
+        if(failed || !readStrings(stringCount) || !readTypes(typeCount) || !readSymbols(symbolCount)) return nullptr;
+        nodes.reserve(nodeCount);
+        for(uint32_t i = 0; i < nodeCount && !failed; i++){
+            AstNode* n = readNode();
+            if(!n) return nullptr;
+            nodes.push_back(n);
+        }
+        if(failed || pos != end || nodes.empty()) return nullptr;
+        return llvm::dyn_cast<ProgramNode>(nodes.back());
+    }
+};
+
+} // namespace
+
+std::string AstSerializer::serialize(const ProgramNode& program, const StringInterner& names){
+    AstWriter writer(names);
+    // 書き出すだけなので、ノードは変更しない
+    writer.visit(const_cast<ProgramNode*>(&program));
+    return writer.finish();
+}
+
+ProgramNode* AstSerializer::deserialize(std::string_view data, CompilerInstance& compiler){
+    AstReader reader(data, compiler);
+    return reader.read();
+}
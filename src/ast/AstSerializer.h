@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+class ProgramNode;
+class CompilerInstance;
+class StringInterner;
+
+// セマンティック解析が終わったASTをバイト列にする・バイト列から戻す (.lumaast, AstCacheが使う)
+// 文字列・型・シンボルはそれぞれ表に一度だけ書き、ノードからは表の添字で参照する
+// ノードは子を先に書く(後順)ので、読み込むときは前から順にノードを作るだけで子がそろっている
+// 整数はすべて可変長(LEB128)で書く
+//
+// 形式:
+//   "LAST" バージョン 文字列の数 型の数 シンボルの数 ノードの数
+//   文字列の表 (長さ+バイト列。0番は空文字列で書かない)
+//   型の表 (Basic: 名前 / Array: 要素の型+長さ)
+//   シンボルの表 (種類・名前・型・スコープの深さ。関数は引数のシンボル)
+//   ノードの表 (種類・位置・種類ごとの値と子の添字。最後のノードがProgramNode)
+// 添字は0をnullptrとし、1から数える
+class AstSerializer{
+public:
+    // AstKind・ノードのメンバー・形式を変えたら上げる (違うバージョンのファイルは読まない)
+    static constexpr uint32_t Version = 1;
+    // namesはASTの名前(NameId)を作った文字列表
+    static std::string serialize(const ProgramNode& program, const StringInterner& names);
+    // ノードはcompilerのAstContextに、名前・型はcompilerの文字列表・TypeContextに作る
+    // 形式が違う・壊れている場合はnullptr
+    static ProgramNode* deserialize(std::string_view data, CompilerInstance& compiler);
+};
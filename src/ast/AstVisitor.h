@@ -0,0 +1,46 @@
+#pragma once
+#include "AstNode.h"
+#include "Definition.h"
+#include "Expression.h"
+#include "Statement.h"
+
+// ノードの種類(AstKind)でswitchして、Derivedの具体的なノードのvisitを呼ぶ (CRTP)
+// dynamic_castを順に試さないので、ノードの種類が増えても1回の分岐で済む
+// Derivedは文・式の全ての種類についてvisitを用意する (privateならこのクラスをfriendにする)
+// 知らない種類のノードが来たときはunhandledExpr/unhandledStatementを呼ぶ (Derivedで同じ名前を定義すればエラーを出せる)
+template<typename Derived, typename ExprResult, typename StmtResult = void>
+class AstVisitor{
+protected:
+    ExprResult dispatch(ExprNode* node){
+        auto* self = static_cast<Derived*>(this);
+        switch(node->getKind()){
+            case AstKind::NumberLiteral: return static_cast<ExprResult>(self->visit(static_cast<NumberLiteralNode*>(node)));
+            case AstKind::DecimalLiteral: return static_cast<ExprResult>(self->visit(static_cast<DecimalLiteralNode*>(node)));
+            case AstKind::ArrayLiteral: return static_cast<ExprResult>(self->visit(static_cast<ArrayLiteralNode*>(node)));
+            case AstKind::VariableRef: return static_cast<ExprResult>(self->visit(static_cast<VariableRefNode*>(node)));
+            case AstKind::ArrayRef: return static_cast<ExprResult>(self->visit(static_cast<ArrayRefNode*>(node)));
+            case AstKind::BinaryOp: return static_cast<ExprResult>(self->visit(static_cast<BinaryOpNode*>(node)));
+            case AstKind::FunctionCall: return static_cast<ExprResult>(self->visit(static_cast<FunctionCallNode*>(node)));
+            case AstKind::Cast: return static_cast<ExprResult>(self->visit(static_cast<CastNode*>(node)));
+            default: break;
+        }
+        return self->unhandledExpr(node);
+    }
+    StmtResult dispatch(StatementNode* node){
+        auto* self = static_cast<Derived*>(this);
+        switch(node->getKind()){
+            case AstKind::VarDecl: return static_cast<StmtResult>(self->visit(static_cast<VarDeclNode*>(node)));
+            case AstKind::ArrayDecl: return static_cast<StmtResult>(self->visit(static_cast<ArrayDeclNode*>(node)));
+            case AstKind::Assignment: return static_cast<StmtResult>(self->visit(static_cast<AssignmentNode*>(node)));
+            case AstKind::If: return static_cast<StmtResult>(self->visit(static_cast<IfNode*>(node)));
+            case AstKind::For: return static_cast<StmtResult>(self->visit(static_cast<ForNode*>(node)));
+            case AstKind::ExprStatement: return static_cast<StmtResult>(self->visit(static_cast<ExprStatementNode*>(node)));
+            case AstKind::Return: return static_cast<StmtResult>(self->visit(static_cast<ReturnNode*>(node)));
+            case AstKind::FunctionDef: return static_cast<StmtResult>(self->visit(static_cast<FunctionDefNode*>(node)));
+            default: break;
+        }
+        return self->unhandledStatement(node);
+    }
+    ExprResult unhandledExpr(ExprNode*) {return ExprResult();}
+    StmtResult unhandledStatement(StatementNode*) {return StmtResult();}
+};
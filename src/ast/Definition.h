@@ -10,36 +10,39 @@
 class DefNode : public AstNode{
 public:
     // DefNodeは直接ダンプされないが、念のため実装
-    void dump(int indent = 0) const override {
+    void dump(const StringInterner& names, int indent = 0) const override {
         printIndent(indent);
         std::cout << "DefNode {}" << std::endl;
     }
+protected:
+    explicit DefNode(AstKind k) : AstNode(k) {}
 };
 
 // 関数定義を表すノード
 class FunctionDefNode : public StatementNode{
 public: 
-    std::string name; // 関数名
-    std::vector<std::string> args; // 仮引数名リスト
-    std::vector<std::shared_ptr<TypeNode>> argTypes; // 引数の型
-    std::shared_ptr<BlockNode> body; // 関数本体のブロック
-    std::shared_ptr<TypeNode> returnType = nullptr; // 戻り値の型を保持
-    std::shared_ptr<FuncSymbol> symbol = nullptr; // 関数シンボル
-    FunctionDefNode(const std::string& n, const std::vector<std::string>& a, const std::vector<std::shared_ptr<TypeNode>> argType,std::shared_ptr<BlockNode> b, std::shared_ptr<TypeNode> ret) : name(n), args(a), argTypes(argType), body(b), returnType(ret) {}
-    void dump(int indent = 0) const override {
+    NameId name; // 関数名
+    std::vector<NameId> args; // 仮引数名リスト
+    std::vector<TypeNode*> argTypes; // 引数の型
+    BlockNode* body; // 関数本体のブロック
+    TypeNode* returnType = nullptr; // 戻り値の型を保持
+    FuncSymbol* symbol = nullptr; // 関数シンボル
+    FunctionDefNode(NameId n, const std::vector<NameId>& a, const std::vector<TypeNode*> argType,BlockNode* b, TypeNode* ret) : StatementNode(AstKind::FunctionDef), name(n), args(a), argTypes(argType), body(b), returnType(ret) {}
+    static bool classof(const AstNode* node) {return node->getKind() == AstKind::FunctionDef;}
+    void dump(const StringInterner& names, int indent = 0) const override {
         printIndent(indent);
-        std::cout << "FunctionDefNode (Name: " << name << ", ReturnType: " << (returnType ? returnType->getTypeName() : "unknown") << ") {" << std::endl;
+        std::cout << "FunctionDefNode (Name: " << names.str(name) << ", ReturnType: " << (returnType ? returnType->getTypeName() : "unknown") << ") {" << std::endl;
         if (!args.empty()) {
             printIndent(indent + 1);
             std::cout << "Parameters: [";
             for (size_t i = 0; i < args.size(); ++i) {
-                std::cout << args[i] << (i == args.size() - 1 ? "" : ", ");
+                std::cout << names.str(args[i]) << (i == args.size() - 1 ? "" : ", ");
             }
             std::cout << "]" << std::endl;
         }
         printIndent(indent + 1);
         std::cout << "Body: " << std::endl;
-        body->dump(indent + 2);
+        body->dump(names, indent + 2);
         printIndent(indent);
         std::cout << "}" << std::endl;
     }
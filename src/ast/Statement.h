@@ -9,17 +9,24 @@
 #include <vector>
 
 // 文の基底クラス
-class StatementNode : public AstNode {};
+class StatementNode : public AstNode {
+public:
+    static bool classof(const AstNode* node) {return node->getKind() >= AstKind::FirstStatement && node->getKind() <= AstKind::LastStatement;}
+protected:
+    explicit StatementNode(AstKind k) : AstNode(k) {}
+};
 
 // プログラム全体を表すノード（文のリストを持つ）
 class ProgramNode : public AstNode {
 public:
-    std::vector<std::shared_ptr<StatementNode>> statements; // 文のリスト
-    void dump(int indent = 0) const override {
+    AstList<StatementNode> statements; // 文のリスト
+    ProgramNode() : AstNode(AstKind::Program) {}
+    static bool classof(const AstNode* node) {return node->getKind() == AstKind::Program;}
+    void dump(const StringInterner& names, int indent = 0) const override {
         printIndent(indent);
         std::cout << "ProgramNode {" << std::endl;
         for (const auto& stmt : statements) {
-            stmt->dump(indent + 1);
+            stmt->dump(names, indent + 1);
         }
         printIndent(indent);
         std::cout << "}" << std::endl;
@@ -29,12 +36,14 @@ public:
 // ブロックを表すノード
 class BlockNode : public AstNode {
 public:
-    std::vector<std::shared_ptr<StatementNode>> statements; // 文のリスト
-    void dump(int indent = 0) const override {
+    AstList<StatementNode> statements; // 文のリスト
+    BlockNode() : AstNode(AstKind::Block) {}
+    static bool classof(const AstNode* node) {return node->getKind() == AstKind::Block;}
+    void dump(const StringInterner& names, int indent = 0) const override {
         printIndent(indent);
         std::cout << "BlockNode {" << std::endl;
         for (const auto& stmt : statements) {
-            stmt->dump(indent + 1);
+            stmt->dump(names, indent + 1);
         }
         printIndent(indent);
         std::cout << "}" << std::endl;
@@ -45,19 +54,20 @@ public:
 // 変数宣言文を表すノード
 class VarDeclNode : public StatementNode{
 public:
-    std::string varName; // 変数名
+    NameId varName; // 変数名
     // 初期化式を保持するポインタ(式がない場合はnullptr)
-    std::shared_ptr<ExprNode> initializer;
-    std::shared_ptr<TypeNode> type; // 変数の型
-    std::shared_ptr<Symbol> symbol = nullptr;
-    VarDeclNode(const std::string& name, std::shared_ptr<TypeNode> t, std::shared_ptr<ExprNode> init) : varName(name), type(t),initializer(init){}
-    void dump(int indent = 0) const override {
-        printIndent(indent);
-        std::cout << "VarDeclNode (Name: " << varName << ", Type: " << (type ? type->getTypeName() : "unknown") << ") {" << std::endl;
+    ExprNode* initializer;
+    TypeNode* type; // 変数の型
+    Symbol* symbol = nullptr;
+    VarDeclNode(NameId name, TypeNode* t, ExprNode* init) : StatementNode(AstKind::VarDecl), varName(name), type(t),initializer(init){}
+    static bool classof(const AstNode* node) {return node->getKind() == AstKind::VarDecl;}
+    void dump(const StringInterner& names, int indent = 0) const override {
+        printIndent(indent);
+        std::cout << "VarDeclNode (Name: " << names.str(varName) << ", Type: " << (type ? type->getTypeName() : "unknown") << ") {" << std::endl;
         if (initializer) {
             printIndent(indent + 1);
             std::cout << "Initializer: " << std::endl;
-            initializer->dump(indent + 2);
+            initializer->dump(names, indent + 2);
         }
         printIndent(indent);
         std::cout << "}" << std::endl;
@@ -66,19 +76,20 @@ public:
 // 配列宣言文
 class ArrayDeclNode : public StatementNode{
 public:
-    std::string arrayName;
-    std::shared_ptr<TypeNode> type; // 配列の型
+    NameId arrayName;
+    TypeNode* type; // 配列の型
     size_t size;
-    std::shared_ptr<ExprNode> initializer = nullptr; // 初期化式
-    std::shared_ptr<Symbol> symbol = nullptr;
-    ArrayDeclNode(const std::string& name, std::shared_ptr<TypeNode> t, size_t siz) : arrayName(name), type(t), size(siz) {}
-    void dump(int indent = 0) const override{
+    ExprNode* initializer = nullptr; // 初期化式
+    Symbol* symbol = nullptr;
+    ArrayDeclNode(NameId name, TypeNode* t, size_t siz) : StatementNode(AstKind::ArrayDecl), arrayName(name), type(t), size(siz) {}
+    static bool classof(const AstNode* node) {return node->getKind() == AstKind::ArrayDecl;}
+    void dump(const StringInterner& names, int indent = 0) const override{
         printIndent(indent);
-        std::cout << "ArrayDeclNode (Name: " << arrayName << ", Type: " << (type ? type->getTypeName() : "unknown") << ") {" << std::endl;
+        std::cout << "ArrayDeclNode (Name: " << names.str(arrayName) << ", Type: " << (type ? type->getTypeName() : "unknown") << ") {" << std::endl;
         if (initializer) {
             printIndent(indent + 1);
             std::cout << "Initializer: " << std::endl;
-            initializer->dump(indent + 2);
+            initializer->dump(names, indent + 2);
         }
         printIndent(indent);
         std::cout << "}" << std::endl;
@@ -87,16 +98,17 @@ public:
 // 変数代入文を表すノード
 class AssignmentNode : public StatementNode{
 public:
-    std::string varName; // 代入先の変数名
-    std::shared_ptr<ExprNode> value; // 代入する値の式
-    std::shared_ptr<Symbol> symbol = nullptr;
-    AssignmentNode(const std::string& name, std::shared_ptr<ExprNode> val) : varName(name), value(val){}
-    void dump(int indent = 0) const override {
-        printIndent(indent);
-        std::cout << "AssignmentNode (Var: " << varName << ") {" << std::endl;
+    NameId varName; // 代入先の変数名
+    ExprNode* value; // 代入する値の式
+    Symbol* symbol = nullptr;
+    AssignmentNode(NameId name, ExprNode* val) : StatementNode(AstKind::Assignment), varName(name), value(val){}
+    static bool classof(const AstNode* node) {return node->getKind() == AstKind::Assignment;}
+    void dump(const StringInterner& names, int indent = 0) const override {
+        printIndent(indent);
+        std::cout << "AssignmentNode (Var: " << names.str(varName) << ") {" << std::endl;
         printIndent(indent + 1);
         std::cout << "Value: " << std::endl;
-        value->dump(indent + 2);
+        value->dump(names, indent + 2);
         printIndent(indent);
         std::cout << "}" << std::endl;
     }
@@ -104,28 +116,29 @@ public:
 // if文を表すノード
 class IfNode : public StatementNode{
 public:
-    std::shared_ptr<ExprNode> condition; // 条件式
-    std::shared_ptr<BlockNode> if_block; // ifブロック
-    std::shared_ptr<BlockNode> else_block; // elseブロック (オプション)
+    ExprNode* condition; // 条件式
+    BlockNode* if_block; // ifブロック
+    BlockNode* else_block; // elseブロック (オプション)
 
     // MIR生成のために追加する情報
     MIRBasicBlock* thenBlock = nullptr;
     MIRBasicBlock* elseBlock = nullptr;
     MIRBasicBlock* mergeBlock = nullptr;
-    IfNode(std::shared_ptr<ExprNode> cond, std::shared_ptr<BlockNode> ifblock, std::shared_ptr<BlockNode> elseblock = nullptr) : condition(cond), if_block(ifblock), else_block(elseblock){}
-    void dump(int indent = 0) const override {
+    IfNode(ExprNode* cond, BlockNode* ifblock, BlockNode* elseblock = nullptr) : StatementNode(AstKind::If), condition(cond), if_block(ifblock), else_block(elseblock){}
+    static bool classof(const AstNode* node) {return node->getKind() == AstKind::If;}
+    void dump(const StringInterner& names, int indent = 0) const override {
         printIndent(indent);
         std::cout << "IfNode {" << std::endl;
         printIndent(indent + 1);
         std::cout << "Condition: " << std::endl;
-        condition->dump(indent + 2);
+        condition->dump(names, indent + 2);
         printIndent(indent + 1);
         std::cout << "If Block: " << std::endl;
-        if_block->dump(indent + 2);
+        if_block->dump(names, indent + 2);
         if (else_block) {
             printIndent(indent + 1);
             std::cout << "Else Block: " << std::endl;
-            else_block->dump(indent + 2);
+            else_block->dump(names, indent + 2);
         }
         printIndent(indent);
         std::cout << "}" << std::endl;
@@ -134,18 +147,19 @@ public:
 // for文を表すノード
 class ForNode : public StatementNode{
 public:
-    std::shared_ptr<ExprNode> condition; // 条件式
-    std::shared_ptr<BlockNode> block; // forブロック
-    ForNode(std::shared_ptr<ExprNode> cond, std::shared_ptr<BlockNode> bnode) : condition(cond), block(bnode){}
-    void dump(int indent = 0) const override {
+    ExprNode* condition; // 条件式
+    BlockNode* block; // forブロック
+    ForNode(ExprNode* cond, BlockNode* bnode) : StatementNode(AstKind::For), condition(cond), block(bnode){}
+    static bool classof(const AstNode* node) {return node->getKind() == AstKind::For;}
+    void dump(const StringInterner& names, int indent = 0) const override {
         printIndent(indent);
         std::cout << "ForNode {" << std::endl;
         printIndent(indent + 1);
         std::cout << "Condition: " << std::endl;
-        condition->dump(indent + 2);
+        condition->dump(names, indent + 2);
         printIndent(indent + 1);
         std::cout << "Block: " << std::endl;
-        block->dump(indent + 2);
+        block->dump(names, indent + 2);
         printIndent(indent);
         std::cout << "}" << std::endl;
     }
@@ -153,12 +167,13 @@ public:
 // 式文を表すノード(print(123); や a = 5;など)
 class ExprStatementNode : public StatementNode{
 public:
-    std::shared_ptr<ExprNode> expression; // 式
-    ExprStatementNode(std::shared_ptr<ExprNode> expr) : expression(expr) {}
-    void dump(int indent = 0) const override {
+    ExprNode* expression; // 式
+    ExprStatementNode(ExprNode* expr) : StatementNode(AstKind::ExprStatement), expression(expr) {}
+    static bool classof(const AstNode* node) {return node->getKind() == AstKind::ExprStatement;}
+    void dump(const StringInterner& names, int indent = 0) const override {
         printIndent(indent);
         std::cout << "ExprStatementNode {" << std::endl;
-        expression->dump(indent + 1);
+        expression->dump(names, indent + 1);
         printIndent(indent);
         std::cout << "}" << std::endl;
     }
@@ -166,13 +181,14 @@ public:
 // Return文を表すノード
 class ReturnNode : public StatementNode{
 public:
-    std::shared_ptr<ExprNode> returnValue; // 戻り値の式 (オプション)
-    ReturnNode(std::shared_ptr<ExprNode> val) : returnValue(val) {}
-    void dump(int indent = 0) const override {
+    ExprNode* returnValue; // 戻り値の式 (オプション)
+    ReturnNode(ExprNode* val) : StatementNode(AstKind::Return), returnValue(val) {}
+    static bool classof(const AstNode* node) {return node->getKind() == AstKind::Return;}
+    void dump(const StringInterner& names, int indent = 0) const override {
         printIndent(indent);
         std::cout << "ReturnNode {" << std::endl;
         if (returnValue) {
-            returnValue->dump(indent + 1);
+            returnValue->dump(names, indent + 1);
         } else {
             printIndent(indent + 1);
             std::cout << "void" << std::endl;
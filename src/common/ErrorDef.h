@@ -30,7 +30,19 @@ enum class ErrorCode{
     VARREF_NOT_DEFINED,
     VARREF_NOT_VARIABLE,
     CAST_TO_NON_BASIC,
-    CAST_INVALID_TYPE
+    CAST_INVALID_TYPE,
+    ARRAYREF_NOT_DEFINED,
+    ARRAYREF_NOT_ARRAY,
+    ARRAYREF_TYPE_NOT_ARRAY,
+    ARRAYREF_NO_ELEMENT_TYPE,
+    ARRAYREF_INDEX_NOT_INT,
+    FUNCDEF_ALREADY_DEFINED,
+    FUNCDEF_ARG_REDEFINED,
+    RETURN_OUTSIDE_FUNCTION,
+    RETURN_TYPE_MISMATCH,
+    RETURN_VALUE_EXPECTED,
+    INPUT_NOT_VARIABLE,
+    BLOCK_STATEMENT_NOT_SUPPORTED
 };
 
 struct ErrorTemplate{
@@ -43,7 +55,7 @@ const std::map<ErrorCode, ErrorTemplate> errorMessages = {
     {
         ErrorCode::VARDECL_SYMBOL_ALREADY_DEFINED,
         {
-            "Symbol '%0 is already defined in this scope.",
+            "Symbol '%0' is already defined in this scope.",
             "シンボル '%0' はこのスコープですでに定義されています。"
         }
     },
@@ -67,7 +79,7 @@ const std::map<ErrorCode, ErrorTemplate> errorMessages = {
     {
         ErrorCode::VARDECL_INIT_TYPE_MISMATCH,
         {
-            "Cannot initialize variable '%0' (type: %1) with a value of type '%2.",
+            "Cannot initialize variable '%0' (type: %1) with a value of type '%2'.",
             "変数 '%0' (%1 型) を %2 型の値で初期化することはできません。"
         }
     },
@@ -206,6 +218,102 @@ const std::map<ErrorCode, ErrorTemplate> errorMessages = {
             "Type is not valid when using CastNode.",
             "キャストで指定された型は無効です。"
         }
+    },
+    // ARRAYREF_NOT_DEFINED
+    {
+        ErrorCode::ARRAYREF_NOT_DEFINED,
+        {
+            "Array '%0' not defined.",
+            "配列 '%0' は定義されていません。"
+        }
+    },
+    // ARRAYREF_NOT_ARRAY
+    {
+        ErrorCode::ARRAYREF_NOT_ARRAY,
+        {
+            "'%0' is not an array.",
+            "'%0' は配列ではありません。"
+        }
+    },
+    // ARRAYREF_TYPE_NOT_ARRAY
+    {
+        ErrorCode::ARRAYREF_TYPE_NOT_ARRAY,
+        {
+            "Internal error: Array symbol type is not an array type.",
+            "内部エラー: 配列のシンボルの型が配列型ではありません。"
+        }
+    },
+    // ARRAYREF_NO_ELEMENT_TYPE
+    {
+        ErrorCode::ARRAYREF_NO_ELEMENT_TYPE,
+        {
+            "Internal error: Could not determine element type for array '%0'.",
+            "内部エラー: 配列 '%0' の要素の型を判別できませんでした。"
+        }
+    },
+    // ARRAYREF_INDEX_NOT_INT
+    {
+        ErrorCode::ARRAYREF_INDEX_NOT_INT,
+        {
+            "Array index must be an integer for array '%0'.",
+            "配列 '%0' の添字は整数である必要があります。"
+        }
+    },
+    // FUNCDEF_ALREADY_DEFINED
+    {
+        ErrorCode::FUNCDEF_ALREADY_DEFINED,
+        {
+            "Function '%0' already defined.",
+            "関数 '%0' はすでに定義されています。"
+        }
+    },
+    // FUNCDEF_ARG_REDEFINED
+    {
+        ErrorCode::FUNCDEF_ARG_REDEFINED,
+        {
+            "Argument '%0' redefined.",
+            "引数 '%0' が重複しています。"
+        }
+    },
+    // RETURN_OUTSIDE_FUNCTION
+    {
+        ErrorCode::RETURN_OUTSIDE_FUNCTION,
+        {
+            "Return statement outside of a function.",
+            "関数の外に return 文があります。"
+        }
+    },
+    // RETURN_TYPE_MISMATCH
+    {
+        ErrorCode::RETURN_TYPE_MISMATCH,
+        {
+            "Return type mismatch. Expected '%0' but got '%1'.",
+            "戻り値の型が不正です。'%0' 型が期待されましたが、'%1' 型が返されました。"
+        }
+    },
+    // RETURN_VALUE_EXPECTED
+    {
+        ErrorCode::RETURN_VALUE_EXPECTED,
+        {
+            "Return value expected for function returning '%0'.",
+            "'%0' 型を返す関数の return には値が必要です。"
+        }
+    },
+    // INPUT_NOT_VARIABLE
+    {
+        ErrorCode::INPUT_NOT_VARIABLE,
+        {
+            "The argument of 'input' must be a variable.",
+            "'input' の引数は変数である必要があります。"
+        }
+    },
+    // BLOCK_STATEMENT_NOT_SUPPORTED
+    {
+        ErrorCode::BLOCK_STATEMENT_NOT_SUPPORTED,
+        {
+            "Block statements are not supported here.",
+            "ここではブロック文は使えません。"
+        }
     }
 };
 
@@ -235,11 +343,18 @@ const std::map<WarnCode, ErrorTemplate> warnMessages = {
 };
 
 enum class InfoCode{
-
+    DIAGNOSTICS_SUPPRESSED
 };
 
 const std::map<InfoCode, ErrorTemplate> infoMessages = {
-    
+    // DIAGNOSTICS_SUPPRESSED
+    {
+        InfoCode::DIAGNOSTICS_SUPPRESSED,
+        {
+            "%0 more diagnostics were not shown (-error-limit=%1).",
+            "ほかに %0 件のエラー・警告は表示していません (-error-limit=%1)。"
+        }
+    }
 };
 
 enum class CompilerErrorCode{
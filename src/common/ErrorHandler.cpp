@@ -2,121 +2,190 @@
 #include "ParserRuleContext.h"
 #include "Token.h"
 #include "common/ErrorDef.h"
+#include "types/Type.h"
 #include <iostream>
 
-ErrorHandler errorHandler;
+uint32_t ErrorHandler::internText(std::string_view text){
+    if(!texts) texts = std::make_unique<StringInterner>();
+    return texts->intern(text).getId();
+}
+
+std::string_view ErrorHandler::textOf(uint32_t id) const {
+    if(!texts || id == 0) return {};
+    return texts->str(NameId(id));
+}
 
-void ErrorHandler::errorReg(std::string name, int error_class, antlr4::ParserRuleContext *ctx){
-    Error error;
-    error.name = name;
-    error.errorClass = error_class;
+void ErrorHandler::count(int error_class){
     if(error_class == 0){
         errorCount++;
     }else if(error_class == 1){
         warnCount++;
     }else if(error_class == 2){
         infoCount++;
-    }else if(error_class == -1){
-        // コンパイラエラーのときの処理
-    }else{
-        errorReg("Unknown Error Happend in errorReg.", 0, ctx);
     }
-    if(ctx){
-        if(auto token = ctx->getStart()){
-            error.userCodeLine = token->getLine();
-            error.userCodeColumn = token->getCharPositionInLine();
-            error.userCodeStr = token->getText();
+    // -1 (コンパイラエラー) は数えない
+}
+
+Diagnostic* ErrorHandler::add(int error_class){
+    if(budget){
+        // 残りがあれば1つ取る (ほかのスレッドのバッファと取り合う)
+        size_t left = budget->load(std::memory_order_relaxed);
+        while(left > 0 && !budget->compare_exchange_weak(left, left - 1, std::memory_order_relaxed)){}
+        if(left == 0){
+            suppressedCount++;
+            return nullptr;
         }
+    }else if(limit != 0 && diagnostics.size() >= limit){
+        suppressedCount++;
+        return nullptr;
     }
-    errors.push_back(Error{error_class, name});
+    Diagnostic diagnostic;
+    diagnostic.errorClass = static_cast<int8_t>(error_class);
+    diagnostics.push_back(diagnostic);
+    return &diagnostics.back();
 }
-void ErrorHandler::errorReg(ErrorCode code, const std::vector<std::string>& args, int line){
-    auto it = errorMessages.find(code);
-    if(it == errorMessages.end()){
-        errorReg("Unknown error code.", -1);
-        return;
-    }
-    std::string format;
-    if(currentLang == Language::JA){
-        format = it->second.ja;
-    }else{
-        format = it->second.en;
-    }
-    std::string message = formatErrorMessage(format, args);
-    errorReg(message, 0);
-}
-void ErrorHandler::warnReg(WarnCode code, const std::vector<std::string>& args, int line){
-    auto it = warnMessages.find(code);
-    if(it == warnMessages.end()){
-        errorReg("Unknown warn code.", -1);
-        return;
-    }
-    std::string format;
-    if(currentLang == Language::JA){
-        format = it->second.ja;
-    }else{
-        format = it->second.en;
-    }
-    std::string message = formatErrorMessage(format, args);
-    errorReg(message, 1);
-}
-void ErrorHandler::infoReg(InfoCode code, const std::vector<std::string>& args, int line){
-    auto it = infoMessages.find(code);
-    if(it == infoMessages.end()){
-        errorReg("Unknown info code.", -1);
-        return;
-    }
-    std::string format;
-    if(currentLang == Language::JA){
-        format = it->second.ja;
-    }else{
-        format = it->second.en;
+
+void ErrorHandler::report(int error_class, uint16_t code, std::initializer_list<DiagArg> list, SourceLocation loc){
+    count(error_class);
+    Diagnostic* diagnostic = add(error_class);
+    if(!diagnostic) return;
+    diagnostic->code = code;
+    diagnostic->loc = loc;
+    diagnostic->firstArg = static_cast<uint32_t>(args.size());
+    diagnostic->argCount = static_cast<uint8_t>(list.size());
+    for(const auto& arg : list){
+        if(arg.getKind() == DiagArg::Kind::Text){
+            args.push_back({DiagArg::Kind::Text, internText(arg.getText())});
+        }else{
+            args.push_back({arg.getKind(), arg.getValue()});
+        }
     }
-    std::string message = formatErrorMessage(format, args);
-    errorReg(message, 2);
-}
-void ErrorHandler::compilerErrorReg(CompilerErrorCode code, const std::vector<std::string>& args, int line){
-    auto it = compilerErrorMessages.find(code);
-    if(it == compilerErrorMessages.end()){
-        errorReg("Unknown compiler error code.", -1);
-        return;
+}
+
+void ErrorHandler::errorReg(std::string_view name, int error_class, antlr4::ParserRuleContext *ctx){
+    if(error_class < -1 || error_class > 2){
+        errorReg("Unknown Error Happend in errorReg.", 0, ctx);
     }
-    std::string format;
-    if(currentLang == Language::JA){
-        format = it->second.ja;
-    }else{
-        format = it->second.en;
+    count(error_class);
+    Diagnostic* diagnostic = add(error_class);
+    if(!diagnostic) return;
+    diagnostic->text = internText(name);
+    if(ctx){
+        // パースツリーは持っておかないので、ここで位置とトークンの文字列に変える
+        if(auto token = ctx->getStart()){
+            if(sourceManager) diagnostic->loc = sourceManager->getLocation(static_cast<uint32_t>(token->getLine()), static_cast<uint32_t>(token->getCharPositionInLine()));
+            diagnostic->snippet = internText(token->getText());
+        }
     }
-    std::string message = formatErrorMessage(format, args);
-    errorReg(message, -1);
+}
+void ErrorHandler::errorReg(ErrorCode code, std::initializer_list<DiagArg> list, SourceLocation loc){
+    report(0, static_cast<uint16_t>(code), list, loc);
+}
+void ErrorHandler::warnReg(WarnCode code, std::initializer_list<DiagArg> list, SourceLocation loc){
+    report(1, static_cast<uint16_t>(code), list, loc);
+}
+void ErrorHandler::infoReg(InfoCode code, std::initializer_list<DiagArg> list, SourceLocation loc){
+    report(2, static_cast<uint16_t>(code), list, loc);
+}
+void ErrorHandler::compilerErrorReg(CompilerErrorCode code, std::initializer_list<DiagArg> list, SourceLocation loc){
+    report(-1, static_cast<uint16_t>(code), list, loc);
 }
 
-void ErrorHandler::conditionErrorReg(bool cond, std::string name, int error_class, antlr4::ParserRuleContext *ctx){
+void ErrorHandler::conditionErrorReg(bool cond, std::string_view name, int error_class, antlr4::ParserRuleContext *ctx){
     if(cond) errorReg(name, error_class, ctx);
 }
 
-void ErrorHandler::printError(Error error){
-    if(error.errorClass == 0) std::cout << "[Error]: ";
-    else if(error.errorClass == 1) std::cout << "[Warn]: ";
-    else if(error.errorClass == 2) std::cout << "[Info]: ";
-    else if(error.errorClass == -1) std::cout << "[Compiler Error]: ";
-    else{
-        std::cout << "[Unknown Error]: \n\t";
+std::string ErrorHandler::argToString(const StoredArg& arg) const {
+    switch(arg.kind){
+        case DiagArg::Kind::Text: return std::string(textOf(static_cast<uint32_t>(arg.value)));
+        case DiagArg::Kind::Name:{
+            // 名前の表がないバッファ(スレッドごとのバッファなど)はappendした先で文字列にする
+            NameId name(static_cast<uint32_t>(arg.value));
+            return nameTable ? nameTable->str(name) : "#" + std::to_string(name.getId());
+        }
+        case DiagArg::Kind::Type:{
+            auto type = reinterpret_cast<TypeNode*>(static_cast<uintptr_t>(arg.value));
+            return type ? type->getTypeName() : "unknown";
+        }
+        case DiagArg::Kind::Int: return std::to_string(static_cast<int64_t>(arg.value));
+    }
+    return "";
+}
+
+// 表からテンプレートを探す (見つからなければnullptr)
+template<typename Code>
+static const ErrorTemplate* findTemplate(const std::map<Code, ErrorTemplate>& messages, uint16_t code){
+    auto it = messages.find(static_cast<Code>(code));
+    return it != messages.end() ? &it->second : nullptr;
+}
+
+std::string ErrorHandler::format(const Diagnostic& diagnostic) const {
+    if(diagnostic.code == Diagnostic::NoCode) return std::string(textOf(diagnostic.text));
+    const ErrorTemplate* messageTemplate = nullptr;
+    const char* unknown = "Unknown error code.";
+    switch(diagnostic.errorClass){
+        case 0: messageTemplate = findTemplate(errorMessages, diagnostic.code); break;
+        case 1: messageTemplate = findTemplate(warnMessages, diagnostic.code); unknown = "Unknown warn code."; break;
+        case 2: messageTemplate = findTemplate(infoMessages, diagnostic.code); unknown = "Unknown info code."; break;
+        case -1: messageTemplate = findTemplate(compilerErrorMessages, diagnostic.code); unknown = "Unknown compiler error code."; break;
+    }
+    if(!messageTemplate) return unknown;
+    std::vector<std::string> formatted;
+    formatted.reserve(diagnostic.argCount);
+    for(uint32_t i = 0; i < diagnostic.argCount; i++){
+        formatted.push_back(argToString(args[diagnostic.firstArg + i]));
     }
-    std::cout << error.name << "\n";
-    if(error.userCodeStr != "")std::cout << "\t\n" << "at Line: " << error.userCodeLine << " Col: " << error.userCodeColumn << " text: " << error.userCodeStr << "\n";
+    return formatErrorMessage(currentLang == Language::JA ? messageTemplate->ja : messageTemplate->en, formatted);
 }
 
-void ErrorHandler::printAllErrors(){
-    for(auto error: errors){
-        printError(error);
+void ErrorHandler::printDiagnostic(const Diagnostic& diagnostic) const {
+    if(diagnostic.errorClass == 0) std::cout << "[Error]: ";
+    else if(diagnostic.errorClass == 1) std::cout << "[Warn]: ";
+    else if(diagnostic.errorClass == 2) std::cout << "[Info]: ";
+    else if(diagnostic.errorClass == -1) std::cout << "[Compiler Error]: ";
+    else{
+        std::cout << "[Unknown Error]: \n\t";
     }
+    std::cout << format(diagnostic) << "\n";
+    if(!diagnostic.loc.isValid() || !sourceManager) return;
+    LineColumn position = sourceManager->getLineColumn(diagnostic.loc);
+    std::cout << "\t\n" << "at Line: " << position.line << " Col: " << position.column;
+    if(diagnostic.snippet != 0) std::cout << " text: " << textOf(diagnostic.snippet);
+    std::cout << "\n";
 }
 
-bool ErrorHandler::hasError() {
-    return errorCount > 0;
+void ErrorHandler::printAllErrors() const {
+    for(const auto& diagnostic : diagnostics){
+        printDiagnostic(diagnostic);
+    }
+    if(suppressedCount > 0){
+        const ErrorTemplate& messageTemplate = infoMessages.at(InfoCode::DIAGNOSTICS_SUPPRESSED);
+        std::cout << "[Info]: " << formatErrorMessage(currentLang == Language::JA ? messageTemplate.ja : messageTemplate.en,
+                                                      {std::to_string(suppressedCount), std::to_string(limit)}) << "\n";
+    }
 }
 
 void ErrorHandler::setLang(Language lang){
     currentLang = lang;
-}
\ No newline at end of file
+}
+
+// バッファの順番どおりに追加する (文字列はこちらの文字列表に登録し直す)
+void ErrorHandler::append(const ErrorHandler& other){
+    errorCount += other.errorCount;
+    warnCount += other.warnCount;
+    infoCount += other.infoCount;
+    suppressedCount += other.suppressedCount;
+    for(const auto& diagnostic : other.diagnostics){
+        Diagnostic* copy = add(diagnostic.errorClass);
+        if(!copy) continue;
+        *copy = diagnostic;
+        copy->firstArg = static_cast<uint32_t>(args.size());
+        for(uint32_t i = 0; i < diagnostic.argCount; i++){
+            StoredArg arg = other.args[diagnostic.firstArg + i];
+            if(arg.kind == DiagArg::Kind::Text) arg.value = internText(other.textOf(static_cast<uint32_t>(arg.value)));
+            args.push_back(arg);
+        }
+        if(diagnostic.text != 0) copy->text = internText(other.textOf(diagnostic.text));
+        if(diagnostic.snippet != 0) copy->snippet = internText(other.textOf(diagnostic.snippet));
+    }
+}
@@ -1,33 +1,115 @@
 #pragma once
 #include "ParserRuleContext.h"
 #include "ErrorDef.h"
+#include "SourceManager.h"
+#include "StringInterner.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
-struct Error{
-    int errorClass;
-    std::string name;
-    size_t userCodeLine = 0;
-    size_t userCodeColumn = 0;
-    std::string userCodeStr;
+class TypeNode;
+
+// エラーメッセージの引数 (登録するときは文字列にせず、表示するときに文字列にする)
+// 文字列は登録するときにErrorHandlerの文字列表にコピーするので、一時的な文字列を渡してよい
+class DiagArg{
+public:
+    enum class Kind : uint8_t{
+        Text, // 文字列 (valueはErrorHandlerの文字列表のID)
+        Name, // NameId (表示するときに文字列表から引く)
+        Type, // TypeNode* (型はTypeContextが最後まで持っている)
+        Int   // 整数
+    };
+private:
+    Kind kind;
+    std::string_view text; // Textのときだけ使う (登録するまで生きていればよい)
+    uint64_t value = 0;
+public:
+    DiagArg(std::string_view s) : kind(Kind::Text), text(s) {}
+    DiagArg(const std::string& s) : kind(Kind::Text), text(s) {}
+    DiagArg(const char* s) : kind(Kind::Text), text(s) {}
+    DiagArg(NameId name) : kind(Kind::Name), value(name.getId()) {}
+    DiagArg(TypeNode* type) : kind(Kind::Type), value(reinterpret_cast<uintptr_t>(type)) {}
+    template<typename T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+    DiagArg(T n) : kind(Kind::Int), value(static_cast<uint64_t>(static_cast<int64_t>(n))) {}
+    Kind getKind() const {return kind;}
+    std::string_view getText() const {return text;}
+    uint64_t getValue() const {return value;}
 };
 
+// 登録されたエラー1つ分 (メッセージは表示するまで作らない)
+struct Diagnostic{
+    static constexpr uint16_t NoCode = 0xFFFF; // コードのないエラー (メッセージはtextに入っている)
+    int8_t errorClass;   // 0: エラー, 1: 警告, 2: 情報, -1: コンパイラのエラー
+    uint8_t argCount = 0;
+    uint16_t code = NoCode; // errorClassに対応するErrorCode/WarnCode/InfoCode/CompilerErrorCodeの値
+    uint32_t firstArg = 0;  // 引数の表の最初の添字
+    uint32_t text = 0;      // コードのないエラーのメッセージ (文字列表のID)
+    uint32_t snippet = 0;   // エラーの位置のトークンの文字列 (文字列表のID, 0ならなし)
+    SourceLocation loc;     // 行と列は表示するときにSourceManagerで計算する
+};
+
+// 登録されたエラー・警告を持っておき、まとめて表示する (コンパイルごとにCompilerInstanceが持つ)
+// メッセージは表示するときに今の言語で組み立てるので、登録はコードと引数を記録するだけ
+// 1つのErrorHandlerは1つのスレッドで使う。並列に解析するときはスレッドごとのバッファに登録し、
+// 最後にappendで決まった順番にまとめる
+// 記録するのはlimit個まで (それを超えた分は数だけ数え、最後にまとめて件数を表示する)
+// バッファはsetBudgetで残りの記録数を共有するので、バッファ全部でもlimit個しか持たない
 class ErrorHandler{
+public:
+    static constexpr size_t DefaultLimit = 10000;
 private:
-    std::vector<Error> errors;
-    size_t errorCount, warnCount, infoCount;
+    // 引数の表の1要素 (DiagArgを文字列の参照なしで持つ形)
+    struct StoredArg{
+        DiagArg::Kind kind;
+        uint64_t value;
+    };
+    std::vector<Diagnostic> diagnostics;
+    std::vector<StoredArg> args;
+    std::unique_ptr<StringInterner> texts; // 引数・メッセージの文字列 (同じ文字列は1つだけ持つ。最初に使うときに作る)
+    size_t errorCount = 0, warnCount = 0, infoCount = 0;
+    size_t suppressedCount = 0; // limitを超えて記録しなかった数
+    size_t limit = DefaultLimit; // 0なら無制限
+    std::atomic<size_t>* budget = nullptr; // 複数のバッファで共有する残りの記録数 (あればlimitの代わりに使う)
     Language currentLang = Language::EN;
+    const SourceManager* sourceManager = nullptr; // 位置を行と列にする (なければ位置は表示しない)
+    const StringInterner* nameTable = nullptr; // DiagArgの名前(NameId)を文字列にする
+
+    uint32_t internText(std::string_view text);
+    std::string_view textOf(uint32_t id) const;
+    void count(int errorClass);
+    // 記録できるならDiagnosticを追加して返す (limitを超えていたらnullptr)
+    Diagnostic* add(int errorClass);
+    void report(int errorClass, uint16_t code, std::initializer_list<DiagArg> list, SourceLocation loc);
+    std::string argToString(const StoredArg& arg) const;
+    std::string format(const Diagnostic& diagnostic) const;
+    void printDiagnostic(const Diagnostic& diagnostic) const;
 public:
-    void errorReg(ErrorCode code, const std::vector<std::string>& args, int line = 0);
-    void warnReg(WarnCode code, const std::vector<std::string>& args, int line = 0);
-    void infoReg(InfoCode code, const std::vector<std::string>& args, int line = 0);
-    void compilerErrorReg(CompilerErrorCode code, const std::vector<std::string>& args, int line = 0);
-    void errorReg(std::string name, int errorClass, antlr4::ParserRuleContext *ctx = nullptr);
-    void conditionErrorReg(bool cond, std::string name, int errorClass, antlr4::ParserRuleContext *ctx = nullptr);
-    void printError(Error error);
-    void printAllErrors();
-    bool hasError();
+    void errorReg(ErrorCode code, std::initializer_list<DiagArg> list = {}, SourceLocation loc = SourceLocation());
+    void warnReg(WarnCode code, std::initializer_list<DiagArg> list = {}, SourceLocation loc = SourceLocation());
+    void infoReg(InfoCode code, std::initializer_list<DiagArg> list = {}, SourceLocation loc = SourceLocation());
+    void compilerErrorReg(CompilerErrorCode code, std::initializer_list<DiagArg> list = {}, SourceLocation loc = SourceLocation());
+    void errorReg(std::string_view name, int errorClass, antlr4::ParserRuleContext *ctx = nullptr);
+    void conditionErrorReg(bool cond, std::string_view name, int errorClass, antlr4::ParserRuleContext *ctx = nullptr);
+    void printAllErrors() const;
+    bool hasError() const {return errorCount > 0;}
     void setLang(Language lang);
+    Language getLang() const {return currentLang;}
+    void setSourceManager(const SourceManager* manager) {sourceManager = manager;}
+    void setNameTable(const StringInterner* names) {nameTable = names;}
+    // 記録するエラーの数の上限 (-error-limit, 0なら無制限)
+    void setLimit(size_t n) {limit = n;}
+    size_t getLimit() const {return limit;}
+    // 並列に使うバッファ同士で記録数の上限を共有する (remainingはバッファより長く生かしておく)
+    void setBudget(std::atomic<size_t>* remaining) {budget = remaining;}
+    // 記録したエラーの数と、limitを超えて記録しなかった数
+    size_t size() const {return diagnostics.size();}
+    size_t getSuppressedCount() const {return suppressedCount;}
+    // 別のErrorHandler(スレッドごとのバッファなど)に登録されたエラーを後ろに追加する
+    void append(const ErrorHandler& other);
 };
-
-extern ErrorHandler errorHandler;
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// フェーズごとの実行時間を計測するヘルパー (-time で有効)
+class PhaseTimer{
+private:
+    bool enabled;
+    std::chrono::steady_clock::time_point last;
+    std::vector<std::pair<std::string, double>> phases; // (フェーズ名, ミリ秒)
+public:
+    explicit PhaseTimer(bool enable = false) : enabled(enable), last(std::chrono::steady_clock::now()) {}
+    bool isEnabled() const {return enabled;}
+    // 前回のmark(またはコンストラクタ)からの経過時間をphaseとして記録する
+    void mark(const std::string& phase){
+        auto now = std::chrono::steady_clock::now();
+        if(enabled){
+            phases.emplace_back(phase, std::chrono::duration<double, std::milli>(now - last).count());
+        }
+        last = now;
+    }
+    void print(std::ostream& os) const {
+        if(!enabled) return;
+        double total = 0.0;
+        os << "--- Time Report ---" << std::endl;
+        for(const auto& [name, ms] : phases){
+            os << "  " << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(3) << ms << " ms" << std::endl;
+            total += ms;
+        }
+        os << "  " << std::left << std::setw(20) << "total" << std::right << std::fixed << std::setprecision(3) << total << " ms" << std::endl;
+        os << "-------------------" << std::endl;
+    }
+};
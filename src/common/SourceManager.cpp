@@ -0,0 +1,46 @@
+#include "SourceManager.h"
+#include <algorithm>
+#include <cstring>
+
+// UTF-8の続きのバイト (10xxxxxx) は列に数えない
+static bool isContinuationByte(char c){
+    return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+}
+
+void SourceManager::setSource(std::string name, std::string_view text){
+    fileName = std::move(name);
+    buffer = text;
+    lineStarts.clear();
+    lineStarts.push_back(0);
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+    for(const char* p = begin; p < end;){
+        auto newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if(!newline) break;
+        lineStarts.push_back(static_cast<uint32_t>(newline + 1 - begin));
+        p = newline + 1;
+    }
+}
+
+SourceLocation SourceManager::getLocation(uint32_t line, uint32_t column) const {
+    if(line == 0 || line > lineStarts.size()) return SourceLocation();
+    size_t pos = lineStarts[line - 1];
+    // 列は文字数なので、マルチバイト文字の分だけバイト位置を進める
+    for(uint32_t i = 0; i < column && pos < buffer.size(); i++){
+        pos++;
+        while(pos < buffer.size() && isContinuationByte(buffer[pos])) pos++;
+    }
+    return SourceLocation::fromOffset(static_cast<uint32_t>(pos));
+}
+
+LineColumn SourceManager::getLineColumn(SourceLocation loc) const {
+    if(!loc.isValid() || lineStarts.empty()) return {};
+    uint32_t offset = std::min<uint32_t>(loc.getOffset(), static_cast<uint32_t>(buffer.size()));
+    auto it = std::upper_bound(lineStarts.begin(), lineStarts.end(), offset);
+    size_t lineIndex = static_cast<size_t>(it - lineStarts.begin()) - 1;
+    uint32_t column = 0;
+    for(size_t pos = lineStarts[lineIndex]; pos < offset; pos++){
+        if(!isContinuationByte(buffer[pos])) column++;
+    }
+    return {static_cast<uint32_t>(lineIndex + 1), column};
+}
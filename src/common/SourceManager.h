@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ソース上の位置 (ファイル先頭からのバイト位置を32bitで持つ)
+// ASTのノード・MIRの命令ごとに持つので小さくしておく。行と列は必要になったときにSourceManagerで計算する
+class SourceLocation{
+private:
+    uint32_t value = 0; // バイト位置+1 (0は位置なし)
+public:
+    SourceLocation() = default;
+    static SourceLocation fromOffset(uint32_t offset) {SourceLocation loc; loc.value = offset + 1; return loc;}
+    bool isValid() const {return value != 0;}
+    uint32_t getOffset() const {return value - 1;}
+    bool operator==(const SourceLocation& other) const = default;
+};
+
+// 行と列 (行は1始まり、列は0始まりの文字数。ANTLRのgetLine/getCharPositionInLineと同じ)
+struct LineColumn{
+    uint32_t line = 0;
+    uint32_t column = 0;
+};
+
+// コンパイルするソースを持ち、SourceLocationと行・列を変換する (CompilerInstanceが持つ)
+// ソースの文字列はコピーしない (mmapした領域を指す) ので、コンパイルが終わるまで生かしておくこと
+// 行の先頭の表はsetSourceで作るので、あとは複数のスレッドから読んでよい
+class SourceManager{
+private:
+    std::string fileName;
+    std::string_view buffer;
+    std::vector<uint32_t> lineStarts; // 各行の先頭のバイト位置
+public:
+    void setSource(std::string name, std::string_view text);
+    const std::string& getFileName() const {return fileName;}
+    std::string_view getBuffer() const {return buffer;}
+    // 行と列 (ANTLRのトークンの位置) からSourceLocationを作る (範囲外なら位置なし)
+    SourceLocation getLocation(uint32_t line, uint32_t column) const;
+    // 位置なしなら{0, 0}
+    LineColumn getLineColumn(SourceLocation loc) const;
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// 識別子・関数名などを表すID (StringInternerで文字列と1対1に対応する)
+// 比較とハッシュは整数だけで済む。文字列はIDを作ったStringInternerのstrで引く
+class NameId{
+private:
+    uint32_t id = 0; // 0は空文字列
+public:
+    NameId() = default;
+    explicit NameId(uint32_t i) : id(i) {}
+    uint32_t getId() const {return id;}
+    bool empty() const {return id == 0;}
+    bool operator==(const NameId& other) const = default;
+    bool operator<(const NameId& other) const {return id < other.id;}
+};
+
+template<>
+struct std::hash<NameId>{
+    size_t operator()(const NameId& name) const noexcept {return name.getId();}
+};
+
+// コンパイル1回で共有する文字列表 (CompilerInstanceが持つ)
+// 同じ文字列には必ず同じNameIdを返す。登録した文字列は最後まで消えない
+// 登録(intern)はメインスレッドだけで行うこと (strは並行して呼んでよいが、internと同時には呼べない)
+class StringInterner{
+private:
+    std::deque<std::string> strings; // NameIdで引く (dequeなので追加しても既存の要素は動かない)
+    std::unordered_map<std::string_view, uint32_t> ids; // キーはstringsの要素を指す
+public:
+    StringInterner(){
+        strings.emplace_back();
+        ids.emplace(strings.back(), 0);
+    }
+    NameId intern(std::string_view text){
+        auto it = ids.find(text);
+        if(it != ids.end()) return NameId(it->second);
+        uint32_t id = static_cast<uint32_t>(strings.size());
+        strings.emplace_back(text);
+        ids.emplace(strings.back(), id);
+        return NameId(id);
+    }
+    // 登録済みなら対応するNameIdを返す (未登録なら空のNameId。表は変更しない)
+    NameId find(std::string_view text) const {
+        auto it = ids.find(text);
+        return it != ids.end() ? NameId(it->second) : NameId();
+    }
+    const std::string& str(NameId name) const {return strings[name.getId()];}
+    size_t size() const {return strings.size();}
+};
+
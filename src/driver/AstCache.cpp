@@ -0,0 +1,67 @@
+#include "AstCache.h"
+#include "ast/AstSerializer.h"
+#include "jit/JITObjectCache.h"
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/SHA1.h>
+#include <llvm/Support/raw_ostream.h>
+
+AstCache::AstCache(const std::string& dir) : cacheDir(dir){
+    if(cacheDir.empty()){
+        llvm::SmallString<128> path;
+        if(!llvm::sys::path::cache_directory(path)){
+            llvm::sys::path::system_temp_directory(false, path);
+        }
+        llvm::sys::path::append(path, "luma", "ast");
+        cacheDir = path.str().str();
+    }
+    llvm::sys::fs::create_directories(cacheDir);
+}
+
+std::string AstCache::computeKey(std::string_view source, const std::string& argv0){
+    llvm::SHA1 hasher;
+    auto addField = [&hasher](llvm::StringRef field){
+        hasher.update(field);
+        hasher.update(llvm::ArrayRef<uint8_t>{0}); // 区切り
+    };
+    addField(std::to_string(AstSerializer::Version));
+    addField(llvm::StringRef(source.data(), source.size()));
+    addField(JITObjectCache::buildId(argv0));
+    return llvm::toHex(hasher.final(), true);
+}
+
+std::string AstCache::entryPath(const std::string& key) const {
+    llvm::SmallString<128> path(cacheDir);
+    llvm::sys::path::append(path, key + ".lumaast");
+    return path.str().str();
+}
+
+std::unique_ptr<llvm::MemoryBuffer> AstCache::lookup(const std::string& key) const {
+    auto buffer = llvm::MemoryBuffer::getFile(entryPath(key), false, false);
+    if(!buffer) return nullptr;
+    return std::move(*buffer);
+}
+
+bool AstCache::store(const std::string& key, std::string_view data) const {
+    // JITObjectCacheと同じく、一時ファイルに書いてからrenameする
+    llvm::SmallString<128> tempPath;
+    int fd;
+    llvm::SmallString<128> model(cacheDir);
+    llvm::sys::path::append(model, key + "-%%%%%%.tmp");
+    if(llvm::sys::fs::createUniqueFile(model, fd, tempPath)) return false;
+    {
+        llvm::raw_fd_ostream os(fd, true);
+        os << llvm::StringRef(data.data(), data.size());
+        if(os.has_error()){
+            os.clear_error();
+            llvm::sys::fs::remove(tempPath);
+            return false;
+        }
+    }
+    if(llvm::sys::fs::rename(tempPath, entryPath(key))){
+        llvm::sys::fs::remove(tempPath);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <llvm/Support/MemoryBuffer.h>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// セマンティック解析が終わったAST(.lumaast)をディスクに保存するキャッシュ (-ast-cache)
+// キーはソースの内容・ASTの形式のバージョン・コンパイラのビルドから計算する。
+// キャッシュに当たったときは字句解析・構文解析(ANTLR)・セマンティック解析を飛ばせる。
+// 1ファイルはソースと同じくらいの大きさなので、JITObjectCacheと違い追い出しはしない
+class AstCache{
+private:
+    std::string cacheDir;
+    std::string entryPath(const std::string& key) const;
+public:
+    // dirが空ならデフォルトのキャッシュディレクトリ(~/.cache/luma/ast など)を使う
+    explicit AstCache(const std::string& dir);
+    static std::string computeKey(std::string_view source, const std::string& argv0);
+    // キーに対応するASTのバイト列を探す。なければnullptr
+    std::unique_ptr<llvm::MemoryBuffer> lookup(const std::string& key) const;
+    // 書き込めなかった場合はfalse (キャッシュなので、失敗してもコンパイルは続ける)
+    bool store(const std::string& key, std::string_view data) const;
+    const std::string& getDirectory() const {return cacheDir;}
+};
@@ -0,0 +1,15 @@
+#include "CompilerInstance.h"
+#include <llvm/IR/LLVMContext.h>
+
+CompilerInstance::CompilerInstance(Language lang)
+    : semanticAnalysis(*this), llvmContext(std::make_unique<llvm::LLVMContext>()) {
+    diagnostics.setLang(lang);
+    diagnostics.setSourceManager(&sourceManager);
+    diagnostics.setNameTable(&nameTable);
+}
+
+CompilerInstance::~CompilerInstance() = default;
+
+std::unique_ptr<llvm::LLVMContext> CompilerInstance::releaseLLVMContext(){
+    return std::move(llvmContext);
+}
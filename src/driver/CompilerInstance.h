@@ -0,0 +1,46 @@
+#pragma once
+#include "ast/AstContext.h"
+#include "common/ErrorDef.h"
+#include "common/ErrorHandler.h"
+#include "common/SourceManager.h"
+#include "common/StringInterner.h"
+#include "semantic/SemanticAnalysis.h"
+#include "types/TypeContext.h"
+#include <memory>
+
+namespace llvm{
+class LLVMContext;
+}
+
+// コンパイル1回分の状態をまとめて持つ (ソース、エラー、文字列表、型、AST、シンボル表、LLVMのコンテキスト)
+// グローバル変数を使わないので、別々のCompilerInstanceなら別々のスレッドで同時にコンパイルできる
+// 各フェーズ(パーサー・SemanticAnalysis・MIRGen・LLVMGen)はここから状態を受け取る
+// NameIdの文字列はgetNameTableで引く (ErrorHandlerにも渡してあるので、エラーメッセージの名前はそこで引かれる)
+class CompilerInstance{
+private:
+    SourceManager sourceManager; // エラーの位置とデバッグ情報の行・列を計算する
+    ErrorHandler diagnostics;
+    StringInterner nameTable;
+    TypeContext typeContext;
+    AstContext astContext; // ASTのノードはすべてここに確保される
+    SemanticAnalysis semanticAnalysis; // 上の状態を使うので最後に作る
+    std::unique_ptr<llvm::LLVMContext> llvmContext; // LLVMGenが生成するモジュールのコンテキスト
+    bool debugInfo = false; // LLVMGenでデバッグ情報(DILocation)を付けるか (-g)
+public:
+    explicit CompilerInstance(Language lang = Language::EN);
+    ~CompilerInstance();
+    CompilerInstance(const CompilerInstance&) = delete;
+    CompilerInstance& operator=(const CompilerInstance&) = delete;
+
+    SourceManager& getSourceManager() {return sourceManager;}
+    ErrorHandler& getDiagnostics() {return diagnostics;}
+    StringInterner& getNameTable() {return nameTable;}
+    TypeContext& getTypeContext() {return typeContext;}
+    AstContext& getAstContext() {return astContext;}
+    SemanticAnalysis& getSemanticAnalysis() {return semanticAnalysis;}
+    llvm::LLVMContext& getLLVMContext() {return *llvmContext;}
+    // コンテキストの所有権を渡す (ThreadSafeModule用。これ以降getLLVMContextは使えない)
+    std::unique_ptr<llvm::LLVMContext> releaseLLVMContext();
+    void setDebugInfo(bool enable) {debugInfo = enable;}
+    bool getDebugInfo() const {return debugInfo;}
+};
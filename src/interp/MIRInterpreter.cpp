@@ -0,0 +1,478 @@
+#include "MIRInterpreter.h"
+#include "mir/MIRBasicBlock.h"
+#include "mir/MIRInstruction.h"
+#include "mir/MIRTerminator.h"
+#include "mir/MIRValue.h"
+#include <llvm/Support/Casting.h>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// レジスタとallocaのスタックの大きさ
+static const size_t REGISTER_STACK_SLOTS = 1 << 20;
+static const size_t MEMORY_STACK_BYTES = 8 << 20;
+
+static uint64_t fromDouble(double value){ return std::bit_cast<uint64_t>(value); }
+static double toDouble(uint64_t slot){ return std::bit_cast<double>(slot); }
+
+// 結果を種類に合わせて切り詰める (整数は符号拡張、f32は丸める)
+static inline uint64_t normalize(MIRInterpreter::ValueKind kind, uint64_t value){
+    using Kind = MIRInterpreter::ValueKind;
+    switch(kind){
+        case Kind::I1: return value & 1;
+        case Kind::I8: return static_cast<uint64_t>(static_cast<int64_t>(static_cast<int8_t>(value)));
+        case Kind::I32: return static_cast<uint64_t>(static_cast<int64_t>(static_cast<int32_t>(value)));
+        case Kind::F32: return fromDouble(static_cast<double>(static_cast<float>(toDouble(value))));
+        default: return value;
+    }
+}
+
+// 符号付き整数として読む (LLVMと同じく、i1のtrueは-1として扱う)
+static inline int64_t asSigned(MIRInterpreter::ValueKind kind, uint64_t value){
+    if(kind == MIRInterpreter::ValueKind::I1) return -static_cast<int64_t>(value & 1);
+    return static_cast<int64_t>(value);
+}
+
+MIRInterpreter::ValueKind MIRInterpreter::kindOf(const MIRType* type){
+    if(!type) return ValueKind::None;
+    switch(type->id){
+        case MIRType::TypeID::Int:
+            if(type->bitWidth == 8) return ValueKind::I8;
+            if(type->bitWidth == 1) return ValueKind::I1;
+            if(type->bitWidth == 32) return ValueKind::I32;
+            if(type->bitWidth == 64) return ValueKind::I64;
+            return ValueKind::None;
+        case MIRType::TypeID::Float:
+            if(type->bitWidth == 32) return ValueKind::F32;
+            return ValueKind::F64;
+        case MIRType::TypeID::Bool: return ValueKind::I1;
+        case MIRType::TypeID::Ptr: return ValueKind::Ptr;
+        default: return ValueKind::None;
+    }
+}
+
+// メモリ上の大きさ (LLVMのレイアウトと同じ。0なら扱えない型)
+static uint32_t sizeOf(const MIRType* type){
+    if(!type) return 0;
+    switch(MIRInterpreter::kindOf(type)){
+        case MIRInterpreter::ValueKind::I1:
+        case MIRInterpreter::ValueKind::I8: return 1;
+        case MIRInterpreter::ValueKind::I32:
+        case MIRInterpreter::ValueKind::F32: return 4;
+        case MIRInterpreter::ValueKind::I64:
+        case MIRInterpreter::ValueKind::F64:
+        case MIRInterpreter::ValueKind::Ptr: return 8;
+        default: break;
+    }
+    if(type->isArray()) return sizeOf(type->elementType) * static_cast<uint32_t>(type->arraySize);
+    return 0;
+}
+
+// MIRのオペコードに対応するインタプリタの命令 (MIROpcodeの順番に並べる)
+static constexpr MIRInterpreter::Op opcodeOps[] = {
+    MIRInterpreter::Op::Add, MIRInterpreter::Op::FAdd,
+    MIRInterpreter::Op::Sub, MIRInterpreter::Op::FSub,
+    MIRInterpreter::Op::Mul, MIRInterpreter::Op::FMul,
+    MIRInterpreter::Op::SDiv, MIRInterpreter::Op::FDiv,
+    MIRInterpreter::Op::ICmpEq, MIRInterpreter::Op::FCmpEq,
+    MIRInterpreter::Op::ICmpNe, MIRInterpreter::Op::FCmpNe,
+    MIRInterpreter::Op::ICmpLt, MIRInterpreter::Op::FCmpLt,
+    MIRInterpreter::Op::ICmpGt, MIRInterpreter::Op::FCmpGt,
+    MIRInterpreter::Op::ICmpLe, MIRInterpreter::Op::FCmpLe,
+    MIRInterpreter::Op::ICmpGe, MIRInterpreter::Op::FCmpGe,
+    MIRInterpreter::Op::Neg, MIRInterpreter::Op::FNeg,
+    MIRInterpreter::Op::Not,
+};
+static_assert(sizeof(opcodeOps) / sizeof(opcodeOps[0]) == MIROpcodeCount, "opcodeOps must list every MIROpcode in order");
+
+static MIRInterpreter::Op opOf(MIROpcode opcode){
+    return opcodeOps[static_cast<size_t>(opcode)];
+}
+
+MIRInterpreter::MIRInterpreter(MIRModule& mirModule, const StringInterner& nameTable, TierUpCompiler* compiler, uint64_t tierThreshold)
+    : module(mirModule), names(nameTable), tierUp(compiler), threshold(tierThreshold),
+      registerStack(new uint64_t[REGISTER_STACK_SLOTS]), memoryStack(new uint8_t[MEMORY_STACK_BYTES]){
+    for(auto& function : module.functions){
+        auto state = std::make_unique<FunctionState>();
+        state->mir = function.get();
+        functionIndex[function->name] = static_cast<uint32_t>(functions.size());
+        functions.push_back(std::move(state));
+    }
+}
+
+bool MIRInterpreter::trap(const std::string& message){
+    if(errorMessage.empty()) errorMessage = message;
+    return false;
+}
+
+bool MIRInterpreter::translate(FunctionState& state){
+    MIRFunction* function = state.mir;
+    auto code = std::make_unique<Code>();
+    // MIRValue::id・MIRBasicBlock::idを添字にする
+    std::vector<uint32_t> slots(function->numValues, NoSlot);
+    std::vector<uint32_t> blockStart(function->basicBlocks.size(), NoSlot);
+    uint32_t nextSlot = 0;
+    bool ok = true;
+    auto setSlot = [&](const MIRValue* value, uint32_t slot){
+        if(value->id < slots.size()) slots[value->id] = slot;
+        else ok = false;
+    };
+
+    // 引数はスロットの先頭
+    for(auto& arg : function->arguments){
+        setSlot(arg.get(), static_cast<uint32_t>(arg->argIndex));
+    }
+    code->numArgs = static_cast<uint32_t>(function->arguments.size());
+    nextSlot = code->numArgs;
+    // 命令の結果にスロットを割り当てる (後のブロックで定義された値を参照していてもよいように先に全部)
+    for(auto& block : function->basicBlocks){
+        for(auto& inst : block->instructions){
+            if(inst.result) setSlot(inst.result.get(), nextSlot++);
+        }
+    }
+    auto operand = [&](const std::shared_ptr<MIRValue>& value) -> uint32_t {
+        if(!value){
+            ok = false;
+            return NoSlot;
+        }
+        if(value->id < slots.size() && slots[value->id] != NoSlot) return slots[value->id];
+        // リテラルは使われるたびに定数のスロットを作る
+        auto literal = llvm::dyn_cast<MIRLiteralValue>(value.get());
+        if(!literal){
+            ok = false;
+            return NoSlot;
+        }
+        ValueKind kind = kindOf(literal->type);
+        uint64_t constant = 0;
+        try{
+            if(literal->stringValue == "true") constant = 1;
+            else if(literal->stringValue == "false") constant = 0;
+            else if(kind == ValueKind::F32 || kind == ValueKind::F64) constant = fromDouble(std::stod(literal->stringValue));
+            else if(kind != ValueKind::None) constant = static_cast<uint64_t>(std::stoll(literal->stringValue));
+            else ok = false;
+        }catch(const std::exception&){
+            ok = false;
+        }
+        uint32_t slot = nextSlot++;
+        code->constants.push_back({slot, normalize(kind, constant)});
+        return slot;
+    };
+
+    // 分岐先は後で埋める
+    std::vector<std::pair<size_t, const MIRBasicBlock*>> branchFixupsB;
+    std::vector<std::pair<size_t, const MIRBasicBlock*>> branchFixupsC;
+    for(auto& block : function->basicBlocks){
+        blockStart[block->id] = static_cast<uint32_t>(code->insts.size());
+        for(auto& instRef : block->instructions){
+            MIRInstruction* node = &instRef;
+            Inst inst{};
+            inst.dst = node->result && node->result->id < slots.size() ? slots[node->result->id] : NoSlot;
+            if(auto binary = llvm::dyn_cast<MIRBinaryInstruction>(node)){
+                const MIROpcodeInfo& info = getOpcodeInfo(binary->opcode);
+                inst.operandKind = kindOf(binary->leftOperand ? binary->leftOperand->type : nullptr);
+                bool isFloat = inst.operandKind == ValueKind::F32 || inst.operandKind == ValueKind::F64;
+                inst.kind = info.isCompare ? ValueKind::I1 : inst.operandKind;
+                inst.a = operand(binary->leftOperand);
+                inst.b = operand(binary->rightOperand);
+                inst.op = opOf(binary->opcode);
+                if(info.operands != 2 || info.isFloat != isFloat) ok = false;
+                if(inst.operandKind == ValueKind::None || inst.operandKind == ValueKind::Ptr) ok = false;
+            }else if(auto unary = llvm::dyn_cast<MIRUnaryInstruction>(node)){
+                const MIROpcodeInfo& info = getOpcodeInfo(unary->opcode);
+                inst.operandKind = inst.kind = kindOf(unary->operand ? unary->operand->type : nullptr);
+                bool isFloat = inst.kind == ValueKind::F32 || inst.kind == ValueKind::F64;
+                inst.a = operand(unary->operand);
+                inst.op = opOf(unary->opcode);
+                if(info.operands != 1 || info.isFloat != isFloat) ok = false;
+                if(inst.kind == ValueKind::None) ok = false;
+            }else if(auto cast = llvm::dyn_cast<MIRCastInstruction>(node)){
+                inst.kind = kindOf(cast->targetType);
+                inst.operandKind = kindOf(cast->operand ? cast->operand->type : nullptr);
+                inst.a = operand(cast->operand);
+                switch(cast->opcode){
+                    case CastOpcode::SIToFP: inst.op = Op::SIToFP; break;
+                    case CastOpcode::FPToSI: inst.op = Op::FPToSI; break;
+                    case CastOpcode::IntCast: inst.op = Op::IntCast; break;
+                    case CastOpcode::FPCast: inst.op = Op::FPCast; break;
+                    case CastOpcode::PtrToInt:
+                    case CastOpcode::IntToPtr:
+                    case CastOpcode::PtrCast: inst.op = Op::Move; break;
+                }
+                if(inst.kind == ValueKind::None || inst.operandKind == ValueKind::None) ok = false;
+            }else if(auto alloca = llvm::dyn_cast<MIRAllocaInstruction>(node)){
+                // ループの中のallocaも同じ場所を使う
+                uint32_t bytes = sizeOf(alloca->allocatedType) * static_cast<uint32_t>(std::max<size_t>(alloca->size, 1));
+                if(bytes == 0) ok = false;
+                inst.op = Op::Alloca;
+                inst.kind = ValueKind::Ptr;
+                inst.c = code->frameBytes;
+                code->frameBytes += (bytes + 7) & ~7u;
+            }else if(auto load = llvm::dyn_cast<MIRLoadInstruction>(node)){
+                inst.op = Op::Load;
+                inst.kind = kindOf(load->result->type);
+                inst.a = operand(load->pointer);
+                if(inst.kind == ValueKind::None) ok = false;
+            }else if(auto store = llvm::dyn_cast<MIRStoreInstruction>(node)){
+                inst.op = Op::Store;
+                inst.kind = kindOf(store->value ? store->value->type : nullptr);
+                inst.a = operand(store->value);
+                inst.b = operand(store->pointer);
+                if(inst.kind == ValueKind::None) ok = false;
+            }else if(auto gep = llvm::dyn_cast<MIRGepInstruction>(node)){
+                inst.op = Op::Gep;
+                inst.kind = ValueKind::Ptr;
+                inst.operandKind = kindOf(gep->index ? gep->index->type : nullptr);
+                inst.a = operand(gep->basePtr);
+                inst.b = operand(gep->index);
+                const MIRType* arrayType = gep->ptrOrArrayType;
+                inst.c = arrayType && arrayType->isArray() ? sizeOf(arrayType->elementType) : sizeOf(gep->elementType);
+                if(inst.c == 0) ok = false;
+            }else if(auto callInst = llvm::dyn_cast<MIRCallInstruction>(node)){
+                auto callee = functionIndex.find(callInst->calleeName);
+                // ランタイム関数(print/input)などモジュールの外の関数はインタプリタでは呼べない
+                if(callee == functionIndex.end() ||
+                   functions[callee->second]->mir->arguments.size() != callInst->arguments.size()){
+                    ok = false;
+                }else{
+                    inst.op = Op::Call;
+                    inst.a = callee->second;
+                    inst.b = static_cast<uint32_t>(code->callArgs.size());
+                    inst.c = static_cast<uint32_t>(callInst->arguments.size());
+                    for(auto& arg : callInst->arguments) code->callArgs.push_back(operand(arg));
+                }
+            }else{
+                ok = false;
+            }
+            if(!ok) break;
+            code->insts.push_back(inst);
+        }
+        if(!ok) break;
+
+        Inst term{};
+        if(auto ret = llvm::dyn_cast_if_present<MIRReturnInstruction>(block->terminator.get())){
+            term.op = Op::Ret;
+            term.a = ret->returnValue ? operand(ret->returnValue) : NoSlot;
+        }else if(auto br = llvm::dyn_cast_if_present<MIRBranchInstruction>(block->terminator.get())){
+            term.op = Op::Br;
+            branchFixupsB.push_back({code->insts.size(), br->targetBlock.get()});
+        }else if(auto condBr = llvm::dyn_cast_if_present<MIRConditionBranchInstruction>(block->terminator.get())){
+            term.op = Op::CondBr;
+            term.a = operand(condBr->condition);
+            branchFixupsB.push_back({code->insts.size(), condBr->trueBlock.get()});
+            branchFixupsC.push_back({code->insts.size(), condBr->falseBlock.get()});
+        }else{
+            ok = false; // 終端命令のないブロック
+            break;
+        }
+        code->insts.push_back(term);
+    }
+    // 別の関数のブロックへの分岐は失敗にする
+    auto startOf = [&](const MIRBasicBlock* target) -> uint32_t {
+        if(target->id >= blockStart.size() || function->basicBlocks[target->id].get() != target) return NoSlot;
+        return blockStart[target->id];
+    };
+    for(auto& [index, target] : branchFixupsB){
+        uint32_t start = startOf(target);
+        if(start == NoSlot) ok = false;
+        else code->insts[index].b = start;
+    }
+    for(auto& [index, target] : branchFixupsC){
+        uint32_t start = startOf(target);
+        if(start == NoSlot) ok = false;
+        else code->insts[index].c = start;
+    }
+    if(!ok){
+        state.translateFailed = true;
+        return false;
+    }
+    code->numSlots = std::max<uint32_t>(nextSlot, 1);
+    state.code = std::move(code);
+    return true;
+}
+
+void MIRInterpreter::countHotness(FunctionState& state, uint64_t& counter){
+    counter++;
+    if(!tierUp || threshold == 0 || state.tierUpRequested) return;
+    if(state.calls + state.backEdges < threshold) return;
+    state.tierUpRequested = true;
+    tierUp->request(state.mir, &state.native);
+}
+
+bool MIRInterpreter::call(FunctionState& state, uint64_t* args, uint64_t& result){
+    countHotness(state, state.calls);
+    TierUpCompiler::NativeEntry native = state.native.load(std::memory_order_acquire);
+    if(!native && !state.code){
+        if(!state.translateFailed) translate(state);
+        if(state.translateFailed){
+            // インタプリタで実行できない関数は、その場でネイティブコードにする
+            if(tierUp && !state.tierUpRequested){
+                state.tierUpRequested = true;
+                native = tierUp->compileNow(state.mir);
+                if(native) state.native.store(native, std::memory_order_release);
+            }
+            if(!native) return trap("Cannot execute function '" + names.str(state.mir->name) + "' in the interpreter.");
+        }
+    }
+    if(native){
+        stats.nativeCalls++;
+        native(args);
+        result = args[0];
+        return true;
+    }
+    stats.interpretedCalls++;
+    return execute(state, args, result);
+}
+
+bool MIRInterpreter::execute(FunctionState& state, uint64_t* args, uint64_t& result){
+    const Code& code = *state.code;
+    if(registerTop + code.numSlots > REGISTER_STACK_SLOTS || memoryTop + code.frameBytes > MEMORY_STACK_BYTES){
+        return trap("Stack overflow in function '" + names.str(state.mir->name) + "'.");
+    }
+    uint64_t* regs = registerStack.get() + registerTop;
+    uint8_t* memory = memoryStack.get() + memoryTop;
+    registerTop += code.numSlots;
+    memoryTop += code.frameBytes;
+    // 呼び出し元は引数をこのフレームの先頭に直接置いているのでコピー不要
+    if(args != regs) std::copy(args, args + code.numArgs, regs);
+    for(const auto& [slot, value] : code.constants) regs[slot] = value;
+
+    uint32_t pc = 0;
+    while(true){
+        const Inst& inst = code.insts[pc];
+        stats.instructions++;
+        switch(inst.op){
+            case Op::Add: regs[inst.dst] = normalize(inst.kind, regs[inst.a] + regs[inst.b]); break;
+            case Op::Sub: regs[inst.dst] = normalize(inst.kind, regs[inst.a] - regs[inst.b]); break;
+            case Op::Mul: regs[inst.dst] = normalize(inst.kind, regs[inst.a] * regs[inst.b]); break;
+            case Op::SDiv:{
+                int64_t left = asSigned(inst.operandKind, regs[inst.a]);
+                int64_t right = asSigned(inst.operandKind, regs[inst.b]);
+                if(right == 0) return trap("Division by zero in function '" + names.str(state.mir->name) + "'.");
+                if(left == std::numeric_limits<int64_t>::min() && right == -1) return trap("Integer overflow in division in function '" + names.str(state.mir->name) + "'.");
+                regs[inst.dst] = normalize(inst.kind, static_cast<uint64_t>(left / right));
+                break;
+            }
+            case Op::FAdd: regs[inst.dst] = normalize(inst.kind, fromDouble(toDouble(regs[inst.a]) + toDouble(regs[inst.b]))); break;
+            case Op::FSub: regs[inst.dst] = normalize(inst.kind, fromDouble(toDouble(regs[inst.a]) - toDouble(regs[inst.b]))); break;
+            case Op::FMul: regs[inst.dst] = normalize(inst.kind, fromDouble(toDouble(regs[inst.a]) * toDouble(regs[inst.b]))); break;
+            case Op::FDiv: regs[inst.dst] = normalize(inst.kind, fromDouble(toDouble(regs[inst.a]) / toDouble(regs[inst.b]))); break;
+            case Op::ICmpEq: regs[inst.dst] = regs[inst.a] == regs[inst.b]; break;
+            case Op::ICmpNe: regs[inst.dst] = regs[inst.a] != regs[inst.b]; break;
+            case Op::ICmpLt: regs[inst.dst] = asSigned(inst.operandKind, regs[inst.a]) < asSigned(inst.operandKind, regs[inst.b]); break;
+            case Op::ICmpGt: regs[inst.dst] = asSigned(inst.operandKind, regs[inst.a]) > asSigned(inst.operandKind, regs[inst.b]); break;
+            case Op::ICmpLe: regs[inst.dst] = asSigned(inst.operandKind, regs[inst.a]) <= asSigned(inst.operandKind, regs[inst.b]); break;
+            case Op::ICmpGe: regs[inst.dst] = asSigned(inst.operandKind, regs[inst.a]) >= asSigned(inst.operandKind, regs[inst.b]); break;
+            // LLVMGenと同じく順序付き比較 (NaNが混じると偽)
+            case Op::FCmpEq: regs[inst.dst] = toDouble(regs[inst.a]) == toDouble(regs[inst.b]); break;
+            case Op::FCmpNe:{
+                double left = toDouble(regs[inst.a]);
+                double right = toDouble(regs[inst.b]);
+                regs[inst.dst] = !std::isnan(left) && !std::isnan(right) && left != right;
+                break;
+            }
+            case Op::FCmpLt: regs[inst.dst] = toDouble(regs[inst.a]) < toDouble(regs[inst.b]); break;
+            case Op::FCmpGt: regs[inst.dst] = toDouble(regs[inst.a]) > toDouble(regs[inst.b]); break;
+            case Op::FCmpLe: regs[inst.dst] = toDouble(regs[inst.a]) <= toDouble(regs[inst.b]); break;
+            case Op::FCmpGe: regs[inst.dst] = toDouble(regs[inst.a]) >= toDouble(regs[inst.b]); break;
+            case Op::Neg: regs[inst.dst] = normalize(inst.kind, 0 - regs[inst.a]); break;
+            case Op::FNeg: regs[inst.dst] = fromDouble(-toDouble(regs[inst.a])); break;
+            case Op::Not: regs[inst.dst] = normalize(inst.kind, ~regs[inst.a]); break;
+            case Op::IntCast: regs[inst.dst] = normalize(inst.kind, static_cast<uint64_t>(asSigned(inst.operandKind, regs[inst.a]))); break;
+            case Op::SIToFP: regs[inst.dst] = normalize(inst.kind, fromDouble(static_cast<double>(asSigned(inst.operandKind, regs[inst.a])))); break;
+            case Op::FPToSI:{
+                double value = toDouble(regs[inst.a]);
+                // 範囲外はLLVMではpoisonになるので、ここでは0にしておく
+                int64_t converted = 0;
+                if(std::isfinite(value) && value >= -9223372036854775808.0 && value < 9223372036854775808.0) converted = static_cast<int64_t>(value);
+                regs[inst.dst] = normalize(inst.kind, static_cast<uint64_t>(converted));
+                break;
+            }
+            case Op::FPCast:
+            case Op::Move: regs[inst.dst] = normalize(inst.kind, regs[inst.a]); break;
+            case Op::Alloca: regs[inst.dst] = reinterpret_cast<uint64_t>(memory + inst.c); break;
+            case Op::Load:{
+                const uint8_t* address = reinterpret_cast<const uint8_t*>(regs[inst.a]);
+                uint64_t value = 0;
+                switch(inst.kind){
+                    case ValueKind::I1: value = *address & 1; break;
+                    case ValueKind::I8:{ int8_t v; std::memcpy(&v, address, 1); value = static_cast<uint64_t>(static_cast<int64_t>(v)); break; }
+                    case ValueKind::I32:{ int32_t v; std::memcpy(&v, address, 4); value = static_cast<uint64_t>(static_cast<int64_t>(v)); break; }
+                    case ValueKind::F32:{ float v; std::memcpy(&v, address, 4); value = fromDouble(v); break; }
+                    default: std::memcpy(&value, address, 8); break;
+                }
+                regs[inst.dst] = value;
+                break;
+            }
+            case Op::Store:{
+                uint8_t* address = reinterpret_cast<uint8_t*>(regs[inst.b]);
+                uint64_t value = regs[inst.a];
+                switch(inst.kind){
+                    case ValueKind::I1:
+                    case ValueKind::I8:{ uint8_t v = static_cast<uint8_t>(value); std::memcpy(address, &v, 1); break; }
+                    case ValueKind::I32:{ uint32_t v = static_cast<uint32_t>(value); std::memcpy(address, &v, 4); break; }
+                    case ValueKind::F32:{ float v = static_cast<float>(toDouble(value)); std::memcpy(address, &v, 4); break; }
+                    default: std::memcpy(address, &value, 8); break;
+                }
+                break;
+            }
+            case Op::Gep: regs[inst.dst] = regs[inst.a] + static_cast<uint64_t>(asSigned(inst.operandKind, regs[inst.b])) * inst.c; break;
+            case Op::Call:{
+                // 引数は呼び出し先のフレームの位置に直接並べる
+                uint64_t* calleeArgs = registerStack.get() + registerTop;
+                if(registerTop + std::max<uint32_t>(inst.c, 1) > REGISTER_STACK_SLOTS){
+                    return trap("Stack overflow in function '" + names.str(state.mir->name) + "'.");
+                }
+                for(uint32_t i = 0; i < inst.c; i++) calleeArgs[i] = regs[code.callArgs[inst.b + i]];
+                uint64_t returned = 0;
+                if(!call(*functions[inst.a], calleeArgs, returned)) return false;
+                if(inst.dst != NoSlot) regs[inst.dst] = returned;
+                break;
+            }
+            case Op::Br:
+                if(inst.b <= pc) countHotness(state, state.backEdges);
+                pc = inst.b;
+                continue;
+            case Op::CondBr:{
+                uint32_t target = (regs[inst.a] & 1) ? inst.b : inst.c;
+                if(target <= pc) countHotness(state, state.backEdges);
+                pc = target;
+                continue;
+            }
+            case Op::Ret:
+                result = inst.a == NoSlot ? 0 : regs[inst.a];
+                registerTop -= code.numSlots;
+                memoryTop -= code.frameBytes;
+                return true;
+        }
+        pc++;
+    }
+}
+
+bool MIRInterpreter::runMain(int64_t& exitValue){
+    auto mainIndex = functionIndex.find(names.find("main"));
+    if(mainIndex == functionIndex.end()) return trap("main function not found.");
+    FunctionState& mainState = *functions[mainIndex->second];
+    if(!mainState.mir->arguments.empty()) return trap("main function must not take arguments.");
+    uint64_t result = 0;
+    uint64_t* args = registerStack.get();
+    if(!call(mainState, args, result)) return false;
+    exitValue = asSigned(kindOf(mainState.mir->returnType), result);
+    return true;
+}
+
+void MIRInterpreter::printStats(std::ostream& os) const {
+    os << "--- Tiered Execution ---" << std::endl;
+    os << "  interpreted calls: " << stats.interpretedCalls << ", native calls: " << stats.nativeCalls
+       << ", interpreted instructions: " << stats.instructions << std::endl;
+    if(tierUp){
+        TierUpCompiler::Stats tierStats = tierUp->getStats();
+        os << "  tier-up: requested " << tierStats.requested << ", compiled " << tierStats.compiled << ", failed " << tierStats.failed << std::endl;
+    }
+    for(const auto& state : functions){
+        if(state->calls == 0) continue;
+        os << "  " << names.str(state->mir->name) << ": calls " << state->calls << ", back edges " << state->backEdges
+           << (state->native.load() ? " (native)" : "") << std::endl;
+    }
+}
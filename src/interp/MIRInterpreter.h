@@ -0,0 +1,96 @@
+#pragma once
+#include "jit/TierUpCompiler.h"
+#include "mir/MIRFunction.h"
+#include "mir/MIRModule.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// MIRを直接実行するレジスタ型インタプリタ
+// 関数ごとにMIRを平らな命令列に変換し、値はすべて64bitのスロットに入れて実行する。
+// 呼び出し回数とループの後方分岐の回数が閾値を超えた関数はTierUpCompilerでネイティブコードにし、
+// コンパイルが終わった後の呼び出しからはそちらを使う。
+class MIRInterpreter{
+public:
+    // スロットに入っている値の種類 (整数は64bitに符号拡張、boolは0/1、f32もdoubleで持つ)
+    enum class ValueKind : uint8_t{
+        I1, I8, I32, I64, F32, F64, Ptr, None
+    };
+    enum class Op : uint8_t{
+        Add, Sub, Mul, SDiv,
+        FAdd, FSub, FMul, FDiv,
+        ICmpEq, ICmpNe, ICmpLt, ICmpGt, ICmpLe, ICmpGe,
+        FCmpEq, FCmpNe, FCmpLt, FCmpGt, FCmpLe, FCmpGe,
+        Neg, FNeg, Not,
+        IntCast, SIToFP, FPToSI, FPCast, Move,
+        Alloca, Load, Store, Gep,
+        Call, Br, CondBr, Ret
+    };
+    static constexpr uint32_t NoSlot = UINT32_MAX;
+    // 命令 (dst = a op b の形。cは即値や分岐先などに使う)
+    // 基本ブロックは関数内の順番に並べるので、前に戻る分岐をループの後方分岐とみなす
+    struct Inst{
+        Op op;
+        ValueKind kind;         // 結果(Storeでは格納する値)の種類
+        ValueKind operandKind;  // オペランドの種類 (キャストや比較で使う)
+        uint32_t dst = NoSlot;
+        uint32_t a = NoSlot;
+        uint32_t b = NoSlot;
+        uint32_t c = 0;
+    };
+    // 命令列に変換した関数
+    struct Code{
+        std::vector<Inst> insts;
+        std::vector<std::pair<uint32_t, uint64_t>> constants; // フレームに置く定数 (スロット, 値)
+        std::vector<uint32_t> callArgs;    // Callの引数スロット (Inst::bが先頭位置、Inst::cが個数)
+        uint32_t numArgs = 0;              // 引数はスロットの先頭に置く
+        uint32_t numSlots = 0;             // 引数 + 定数 + 一時変数
+        uint32_t frameBytes = 0;           // allocaで使うメモリ
+    };
+    struct FunctionState{
+        MIRFunction* mir;
+        std::unique_ptr<Code> code; // 最初に呼ばれたときに作る
+        bool translateFailed = false;
+        uint64_t calls = 0;
+        uint64_t backEdges = 0;
+        bool tierUpRequested = false;
+        std::atomic<TierUpCompiler::NativeEntry> native{nullptr};
+    };
+    struct Stats{
+        uint64_t interpretedCalls = 0;
+        uint64_t nativeCalls = 0;
+        uint64_t instructions = 0;
+    };
+private:
+    MIRModule& module;
+    const StringInterner& names; // 関数名の文字列 (エラーメッセージ・統計の表示とmainを探すのに使う)
+    TierUpCompiler* tierUp; // nullptrならtier-upしない
+    uint64_t threshold;     // 0ならtier-upしない
+    std::vector<std::unique_ptr<FunctionState>> functions;
+    std::unordered_map<NameId, uint32_t> functionIndex;
+    // レジスタとallocaのメモリはそれぞれ一つのスタックから取る (伸ばすとallocaのアドレスが変わるので固定長)
+    std::unique_ptr<uint64_t[]> registerStack;
+    size_t registerTop = 0;
+    std::unique_ptr<uint8_t[]> memoryStack;
+    size_t memoryTop = 0;
+    std::string errorMessage;
+    Stats stats;
+
+    bool translate(FunctionState& state);
+    bool call(FunctionState& state, uint64_t* args, uint64_t& result);
+    bool execute(FunctionState& state, uint64_t* args, uint64_t& result);
+    void countHotness(FunctionState& state, uint64_t& counter);
+    bool trap(const std::string& message);
+public:
+    MIRInterpreter(MIRModule& mirModule, const StringInterner& nameTable, TierUpCompiler* compiler, uint64_t tierThreshold);
+    // main関数を実行する。実行時エラーならfalse
+    bool runMain(int64_t& exitValue);
+    const std::string& getError() const {return errorMessage;}
+    void printStats(std::ostream& os) const;
+    static ValueKind kindOf(const MIRType* type);
+};
@@ -0,0 +1,180 @@
+#include "JITObjectCache.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/Chrono.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Process.h>
+#include <llvm/Support/SHA1.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/TargetParser/Host.h>
+#include <vector>
+
+// キャッシュのファイル形式が変わったら上げる
+static const char* CACHE_FORMAT_VERSION = "1";
+
+JITObjectCache::JITObjectCache(const std::string& dir, uint64_t maxBytes) : cacheDir(dir), maxSizeBytes(maxBytes){
+    if(cacheDir.empty()){
+        llvm::SmallString<128> path;
+        if(!llvm::sys::path::cache_directory(path)){
+            llvm::sys::path::system_temp_directory(false, path);
+        }
+        llvm::sys::path::append(path, "luma", "jit");
+        cacheDir = path.str().str();
+    }
+    llvm::sys::fs::create_directories(cacheDir);
+    loadStats();
+}
+
+JITObjectCache::~JITObjectCache(){
+    saveStats();
+}
+
+std::string JITObjectCache::buildId(const std::string& argv0){
+    // コンパイラのビルドは実行ファイルのサイズと更新時刻で区別する
+    std::string id = LLVM_VERSION_STRING;
+    std::string exePath = llvm::sys::fs::getMainExecutable(argv0.c_str(), (void*)&JITObjectCache::computeKey);
+    llvm::sys::fs::file_status status;
+    if(!exePath.empty() && !llvm::sys::fs::status(exePath, status)){
+        id += ":" + std::to_string(status.getSize());
+        id += ":" + std::to_string(llvm::sys::toTimeT(status.getLastModificationTime()));
+    }
+    return id;
+}
+
+std::string JITObjectCache::computeKey(std::string_view source, OptLevel optLevel, bool debugInfo, const std::string& argv0){
+    llvm::SHA1 hasher;
+    auto addField = [&hasher](llvm::StringRef field){
+        hasher.update(field);
+        hasher.update(llvm::ArrayRef<uint8_t>{0}); // 区切り
+    };
+    addField(CACHE_FORMAT_VERSION);
+    addField(llvm::StringRef(source.data(), source.size()));
+    addField(std::to_string(static_cast<int>(optLevel)));
+    addField(debugInfo ? "g" : "");
+    addField(llvm::sys::getProcessTriple());
+    addField(llvm::sys::getHostCPUName());
+    addField(buildId(argv0));
+    return llvm::toHex(hasher.final(), true);
+}
+
+std::string JITObjectCache::entryPath(const std::string& key) const {
+    llvm::SmallString<128> path(cacheDir);
+    llvm::sys::path::append(path, key + ".o");
+    return path.str().str();
+}
+
+std::unique_ptr<llvm::MemoryBuffer> JITObjectCache::lookup(const std::string& key){
+    std::string path = entryPath(key);
+    auto buffer = llvm::MemoryBuffer::getFile(path, false, false);
+    if(!buffer){
+        runStats.misses++;
+        totalStats.misses++;
+        return nullptr;
+    }
+    runStats.hits++;
+    totalStats.hits++;
+    // LRUで追い出すために最終アクセス時刻を更新する
+    int fd;
+    if(!llvm::sys::fs::openFileForRead(path, fd)){
+        llvm::sys::fs::setLastAccessAndModificationTime(fd, std::chrono::system_clock::now());
+        llvm::sys::Process::SafelyCloseFileDescriptor(fd);
+    }
+    return std::move(*buffer);
+}
+
+void JITObjectCache::notifyObjectCompiled(const llvm::Module* module, llvm::MemoryBufferRef obj){
+    const std::string& key = module->getModuleIdentifier();
+    if(key.empty()) return;
+    // 別のプロセスが同時に書き込んでも壊れないように、一時ファイルに書いてからrenameする
+    llvm::SmallString<128> tempPath;
+    int fd;
+    llvm::SmallString<128> model(cacheDir);
+    llvm::sys::path::append(model, key + "-%%%%%%.tmp");
+    if(llvm::sys::fs::createUniqueFile(model, fd, tempPath)) return;
+    {
+        llvm::raw_fd_ostream os(fd, true);
+        os << obj.getBuffer();
+        if(os.has_error()){
+            os.clear_error();
+            llvm::sys::fs::remove(tempPath);
+            return;
+        }
+    }
+    if(llvm::sys::fs::rename(tempPath, entryPath(key))){
+        llvm::sys::fs::remove(tempPath);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    evict();
+}
+
+std::unique_ptr<llvm::MemoryBuffer> JITObjectCache::getObject(const llvm::Module* module){
+    // 事前にlookupで確認しているので、ここでは統計を数えない
+    auto buffer = llvm::MemoryBuffer::getFile(entryPath(module->getModuleIdentifier()), false, false);
+    if(!buffer) return nullptr;
+    return std::move(*buffer);
+}
+
+void JITObjectCache::evict(){
+    struct Entry{
+        std::string path;
+        uint64_t size;
+        llvm::sys::TimePoint<> lastUsed;
+    };
+    std::vector<Entry> entries;
+    uint64_t totalSize = 0;
+    std::error_code ec;
+    for(llvm::sys::fs::directory_iterator it(cacheDir, ec), end; it != end && !ec; it.increment(ec)){
+        if(llvm::sys::path::extension(it->path()) != ".o") continue;
+        llvm::sys::fs::file_status status;
+        if(llvm::sys::fs::status(it->path(), status)) continue;
+        entries.push_back({it->path(), status.getSize(), status.getLastModificationTime()});
+        totalSize += status.getSize();
+    }
+    if(totalSize <= maxSizeBytes) return;
+    // 古く使われていないものから消す
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b){ return a.lastUsed < b.lastUsed; });
+    for(const auto& entry : entries){
+        if(totalSize <= maxSizeBytes) break;
+        if(!llvm::sys::fs::remove(entry.path)){
+            totalSize -= entry.size;
+            runStats.evictions++;
+            totalStats.evictions++;
+        }
+    }
+}
+
+void JITObjectCache::loadStats(){
+    llvm::SmallString<128> path(cacheDir);
+    llvm::sys::path::append(path, "stats");
+    std::ifstream file(path.str().str());
+    std::string name;
+    uint64_t value;
+    while(file >> name >> value){
+        if(name == "hits") totalStats.hits = value;
+        else if(name == "misses") totalStats.misses = value;
+        else if(name == "evictions") totalStats.evictions = value;
+    }
+}
+
+void JITObjectCache::saveStats(){
+    // 累計は目安なので、複数プロセスが同時に更新したときの取りこぼしは気にしない
+    llvm::SmallString<128> path(cacheDir);
+    llvm::sys::path::append(path, "stats");
+    std::ofstream file(path.str().str(), std::ios::trunc);
+    file << "hits " << totalStats.hits << "\n";
+    file << "misses " << totalStats.misses << "\n";
+    file << "evictions " << totalStats.evictions << "\n";
+}
+
+void JITObjectCache::printStats(std::ostream& os) const {
+    os << "--- JIT Cache (" << cacheDir << ") ---" << std::endl;
+    os << "  this run: hits " << runStats.hits << ", misses " << runStats.misses << ", evictions " << runStats.evictions << std::endl;
+    os << "  total:    hits " << totalStats.hits << ", misses " << totalStats.misses << ", evictions " << totalStats.evictions << std::endl;
+    os << "  limit:    " << maxSizeBytes / (1024 * 1024) << " MB" << std::endl;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "llvmgen/LLVMOptimizer.h"
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// JITでコンパイルしたオブジェクトをディスクに保存するキャッシュ
+// キーはソースの内容・最適化レベル・ターゲットCPU・コンパイラのビルドから計算する。
+// キャッシュに当たったときはフロントエンドもLLVMGenも機械語生成も飛ばせる。
+class JITObjectCache : public llvm::ObjectCache{
+public:
+    struct Stats{
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+private:
+    std::string cacheDir;
+    uint64_t maxSizeBytes;
+    Stats runStats;   // 今回の実行での統計
+    Stats totalStats; // キャッシュディレクトリに保存されている累計
+    std::mutex mutex; // notifyObjectCompiledはJITのコンパイルスレッドから呼ばれる
+    std::string entryPath(const std::string& key) const;
+    void loadStats();
+    void saveStats();
+    void evict();
+public:
+    // dirが空ならデフォルトのキャッシュディレクトリ(~/.cache/luma/jit など)を使う
+    JITObjectCache(const std::string& dir, uint64_t maxBytes);
+    ~JITObjectCache() override;
+    // コンパイラのビルドを区別する文字列 (LLVMのバージョンと実行ファイルのサイズ・更新時刻。AstCacheのキーにも使う)
+    static std::string buildId(const std::string& argv0);
+    // キャッシュキーを計算する (debugInfo: -gでデバッグ情報付きのオブジェクトを作るか)
+    static std::string computeKey(std::string_view source, OptLevel optLevel, bool debugInfo, const std::string& argv0);
+    // キーに対応するオブジェクトを探す。なければnullptr (ミスとして数える)
+    std::unique_ptr<llvm::MemoryBuffer> lookup(const std::string& key);
+    // llvm::ObjectCache
+    // モジュールIDをキーとして使うので、コンパイル前にModule::setModuleIdentifierでキーを設定しておく
+    void notifyObjectCompiled(const llvm::Module* module, llvm::MemoryBufferRef obj) override;
+    std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module* module) override;
+    const std::string& getDirectory() const {return cacheDir;}
+    void printStats(std::ostream& os) const;
+};
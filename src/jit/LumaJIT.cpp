@@ -0,0 +1,171 @@
+#include "LumaJIT.h"
+#include "runtime/RuntimeFunctions.h"
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/ExecutionEngine/Orc/CompileOnDemandLayer.h>
+#include <llvm/ExecutionEngine/Orc/CompileUtils.h>
+#include <llvm/ExecutionEngine/Orc/IRCompileLayer.h>
+#include <llvm/ExecutionEngine/Orc/Shared/ExecutorSymbolDef.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+#include <algorithm>
+
+template<typename BuilderT>
+void LumaJIT::setupBuilder(BuilderT& builder, llvm::orc::JITTargetMachineBuilder jtmb, const JITOptions& options){
+    builder.setJITTargetMachineBuilder(std::move(jtmb));
+    // コンパイルスレッドを指定するとConcurrentIRCompilerとスレッドプールが使われる
+    if(options.compileThreads > 0) builder.setNumCompileThreads(options.compileThreads);
+    if(options.objectCache){
+        // コンパイル結果をキャッシュに通知するコンパイラを使う
+        JITObjectCache* cache = options.objectCache;
+        builder.setCompileFunctionCreator(
+            [cache](llvm::orc::JITTargetMachineBuilder machineBuilder) -> llvm::Expected<std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler>> {
+                return std::make_unique<llvm::orc::ConcurrentIRCompiler>(std::move(machineBuilder), cache);
+            });
+    }
+}
+
+llvm::Expected<std::unique_ptr<LumaJIT>> LumaJIT::create(const JITOptions& options){
+    std::unique_ptr<LumaJIT> lumaJit(new LumaJIT());
+
+    auto jtmb = llvm::orc::JITTargetMachineBuilder::detectHost();
+    if(!jtmb) return jtmb.takeError();
+    // 指定しないとバックエンドは-O2相当で動くので、-O0でもコード生成に時間がかかる
+    jtmb->setCodeGenOptLevel(LLVMOptimizer::toCodeGenOptLevel(options.optLevel));
+    lumaJit->optLevel = options.optLevel;
+    lumaJit->compileThreads = options.compileThreads;
+
+    if(options.lazy){
+        llvm::orc::LLLazyJITBuilder builder;
+        setupBuilder(builder, std::move(*jtmb), options);
+        auto jit = builder.create();
+        if(!jit) return jit.takeError();
+        // デフォルトでは呼ばれた関数を含むモジュールの残り全部がまとめてコンパイルされるので、
+        // 要求された関数だけを取り出すようにする
+        (*jit)->setPartitionFunction(llvm::orc::CompileOnDemandLayer::compileRequested);
+        lumaJit->lazyJit = jit->get();
+        lumaJit->jit = std::move(*jit);
+    }else{
+        llvm::orc::LLJITBuilder builder;
+        setupBuilder(builder, std::move(*jtmb), options);
+        auto jit = builder.create();
+        if(!jit) return jit.takeError();
+        lumaJit->jit = std::move(*jit);
+    }
+
+    if(auto err = lumaJit->defineRuntimeSymbols(lumaJit->jit->getMainJITDylib())) return std::move(err);
+
+    // JITでマテリアライズされるモジュールに関数単位の最適化パイプラインをかける
+    // (lazyモードではCompileOnDemandLayerで分割された後の各関数にかかる。O0では何もしないので変換も入れない)
+    // 変換はコンパイルスレッドやtier-upのスレッドから同時に呼ばれることがある
+    if(options.optLevel != OptLevel::O0){
+        LumaJIT* self = lumaJit.get();
+        lumaJit->jit->getIRTransformLayer().setTransform(
+            [self](llvm::orc::ThreadSafeModule tsm, llvm::orc::MaterializationResponsibility&) -> llvm::Expected<llvm::orc::ThreadSafeModule> {
+                auto optimizer = self->getThreadOptimizer();
+                if(!optimizer) return optimizer.takeError();
+                tsm.withModuleDo([&optimizer](llvm::Module& m){ (*optimizer)->optimizeFunctions(m); });
+                return std::move(tsm);
+            });
+    }
+    return std::move(lumaJit);
+}
+
+llvm::Expected<LLVMOptimizer*> LumaJIT::getThreadOptimizer(){
+    std::lock_guard<std::mutex> lock(optimizersMutex);
+    ThreadOptimizer& entry = optimizers[std::this_thread::get_id()];
+    if(!entry.optimizer){
+        auto machineBuilder = llvm::orc::JITTargetMachineBuilder::detectHost();
+        if(!machineBuilder) return machineBuilder.takeError();
+        machineBuilder->setCodeGenOptLevel(LLVMOptimizer::toCodeGenOptLevel(optLevel));
+        auto machine = machineBuilder->createTargetMachine();
+        if(!machine) return machine.takeError();
+        entry.targetMachine = std::move(*machine);
+        entry.optimizer = std::make_unique<LLVMOptimizer>(optLevel, entry.targetMachine.get());
+    }
+    return entry.optimizer.get();
+}
+
+llvm::Error LumaJIT::defineRuntimeSymbols(llvm::orc::JITDylib& dylib){
+    // ランタイムはLuma本体にリンクされているので、そのアドレスをそのまま使う
+    llvm::orc::SymbolMap symbols;
+    for(const auto& function : RuntimeFunctionTable){
+        symbols[jit->mangleAndIntern(function.name)] = llvm::orc::ExecutorSymbolDef(
+            llvm::orc::ExecutorAddr::fromPtr(function.address),
+            llvm::JITSymbolFlags::Exported | llvm::JITSymbolFlags::Callable);
+    }
+    return dylib.define(llvm::orc::absoluteSymbols(std::move(symbols)));
+}
+
+llvm::Error LumaJIT::addModule(llvm::orc::ThreadSafeModule module){
+    if(lazyJit) return lazyJit->addLazyIRModule(std::move(module));
+    return jit->addIRModule(std::move(module));
+}
+
+llvm::Error LumaJIT::addSplitModule(std::unique_ptr<llvm::Module> module, unsigned parts){
+    std::vector<llvm::Function*> functions;
+    size_t totalSize = 0;
+    for(auto& function : *module){
+        if(function.isDeclaration()) continue;
+        definedFunctions.push_back(function.getName().str());
+        functions.push_back(&function);
+        totalSize += function.getInstructionCount();
+    }
+    parts = std::max(1u, std::min<unsigned>(parts, functions.size()));
+    // SplitModuleは名前のハッシュで振り分けるので、ほとんどの呼び出しが分割先をまたいでしまい、
+    // 呼び出しの連鎖が長いとORCがモジュール間の依存関係を解決するのに極端に時間がかかる
+    // 近くに書かれた関数どうしはよく呼び合うので、定義順に命令数がほぼ等しくなるように区切る
+    llvm::DenseMap<const llvm::GlobalValue*, unsigned> partOf;
+    size_t accumulated = 0;
+    for(llvm::Function* function : functions){
+        partOf[function] = std::min<size_t>(accumulated * parts / std::max<size_t>(totalSize, 1), parts - 1);
+        accumulated += function->getInstructionCount();
+    }
+    // 内部リンケージのシンボルは別の分割先から参照できるように外部に出す (SplitModuleと同じ)
+    // 名前のないものは名前で引けないので名前を付ける (重複した名前はLLVMが番号を付けて区別する)
+    for(auto& value : module->global_values()){
+        if(!value.hasLocalLinkage()) continue;
+        value.setLinkage(llvm::GlobalValue::ExternalLinkage);
+        value.setVisibility(llvm::GlobalValue::HiddenVisibility);
+        if(!value.hasName()) value.setName("__luma_split_unnamed");
+    }
+    for(unsigned part = 0; part < parts; part++){
+        llvm::ValueToValueMapTy valueMap;
+        // 関数以外のグローバルは最初の分割先にだけ定義を置く
+        auto partModule = llvm::CloneModule(*module, valueMap, [&partOf, part](const llvm::GlobalValue* value){
+            auto it = partOf.find(value);
+            return it != partOf.end() ? it->second == part : part == 0;
+        });
+        // 分割したモジュールは元のコンテキストを共有しているので、
+        // ビットコードを経由してそれぞれ独立したコンテキストに移す (コンテキストごとにロックが分かれる)
+        llvm::SmallVector<char, 0> bitcode;
+        llvm::raw_svector_ostream os(bitcode);
+        llvm::WriteBitcodeToFile(*partModule, os);
+        auto context = std::make_unique<llvm::LLVMContext>();
+        auto parsed = llvm::parseBitcodeFile(llvm::MemoryBufferRef(llvm::StringRef(bitcode.data(), bitcode.size()), module->getModuleIdentifier()), *context);
+        if(!parsed) return parsed.takeError();
+        if(auto err = jit->addIRModule(llvm::orc::ThreadSafeModule(std::move(*parsed), std::move(context)))) return err;
+    }
+    return llvm::Error::success();
+}
+
+llvm::Error LumaJIT::compileAll(){
+    if(definedFunctions.empty()) return llvm::Error::success();
+    llvm::orc::SymbolLookupSet symbols;
+    for(const auto& name : definedFunctions) symbols.add(jit->mangleAndIntern(name));
+    auto& session = jit->getExecutionSession();
+    auto result = session.lookup(llvm::orc::makeJITDylibSearchOrder(&jit->getMainJITDylib()), std::move(symbols));
+    if(!result) return result.takeError();
+    return llvm::Error::success();
+}
+
+llvm::Error LumaJIT::addObject(std::unique_ptr<llvm::MemoryBuffer> object){
+    return jit->addObjectFile(std::move(object));
+}
+
+llvm::Expected<int (*)()> LumaJIT::lookupMain(){
+    auto mainSym = jit->lookup("main");
+    if(!mainSym) return mainSym.takeError();
+    return mainSym->toPtr<int()>();
+}
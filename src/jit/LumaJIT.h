@@ -0,0 +1,67 @@
+#pragma once
+#include "jit/JITObjectCache.h"
+#include "llvmgen/LLVMOptimizer.h"
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Target/TargetMachine.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// JITの設定
+struct JITOptions{
+    OptLevel optLevel = OptLevel::O0;
+    JITObjectCache* objectCache = nullptr; // nullptrならキャッシュしない
+    bool lazy = false; // trueなら関数ごとに最初に呼ばれたときにコンパイルする (LLLazyJIT)
+    unsigned compileThreads = 0; // 0なら呼び出し元のスレッドでコンパイルする
+};
+
+// LLJITのラッパー
+// 最適化パイプライン(IRTransformLayer)とオブジェクトキャッシュ(IRCompileLayer)を組み込んだJITを作る
+// lazyモードではCompileOnDemandLayerで関数ごとにスタブを置き、最初の呼び出しでコンパイルする
+// compileThreadsを指定するとモジュールを分割してスレッドプールで並列にコンパイルする
+class LumaJIT{
+private:
+    OptLevel optLevel = OptLevel::O0;
+    // 最適化パイプライン用のTargetMachineとパイプラインはスレッドセーフではないので、
+    // 変換を呼んだスレッドごとに作って使い回す (jitより先に宣言して、jitより後に破棄する)
+    struct ThreadOptimizer{
+        std::unique_ptr<llvm::TargetMachine> targetMachine;
+        std::unique_ptr<LLVMOptimizer> optimizer;
+    };
+    std::mutex optimizersMutex;
+    std::unordered_map<std::thread::id, ThreadOptimizer> optimizers;
+    std::unique_ptr<llvm::orc::LLJIT> jit;
+    llvm::orc::LLLazyJIT* lazyJit = nullptr; // lazyモードのときだけ設定される (jitと同じもの)
+    unsigned compileThreads = 0;
+    std::vector<std::string> definedFunctions; // addModuleで追加された関数 (並列コンパイルの要求用)
+    LumaJIT() = default;
+    llvm::Expected<LLVMOptimizer*> getThreadOptimizer();
+    template<typename BuilderT>
+    static void setupBuilder(BuilderT& builder, llvm::orc::JITTargetMachineBuilder jtmb, const JITOptions& options);
+public:
+    static llvm::Expected<std::unique_ptr<LumaJIT>> create(const JITOptions& options);
+    // IRモジュールを追加する (コンパイルはシンボルが参照されたときに行われる)
+    // lazyモードでは関数単位で分割され、呼ばれた関数だけがコンパイルされる
+    llvm::Error addModule(llvm::orc::ThreadSafeModule module);
+    // モジュールを定義順に最大parts個に分割し、それぞれ別のコンテキストに移してから追加する
+    // 分割したモジュールは別々のスレッドで最適化・コンパイルできる
+    llvm::Error addSplitModule(std::unique_ptr<llvm::Module> module, unsigned parts);
+    // キャッシュから読み込んだオブジェクトを追加する
+    llvm::Error addObject(std::unique_ptr<llvm::MemoryBuffer> object);
+    // 追加済みの関数をすべてまとめて要求し、コンパイルを並列に走らせる
+    // (mainだけを探すと、依存先が見つかるまで順番にコンパイルされてしまう)
+    llvm::Error compileAll();
+    // ランタイム関数(print/input)のアドレスをdylibに登録する (メインのJITDylibにはcreateで登録済み)
+    llvm::Error defineRuntimeSymbols(llvm::orc::JITDylib& dylib);
+    // Lumaのmain関数を探す (必要ならここでコンパイルされる)
+    llvm::Expected<int (*)()> lookupMain();
+    llvm::orc::LLJIT& getLLJIT() {return *jit;}
+    bool isLazy() const {return lazyJit != nullptr;}
+};
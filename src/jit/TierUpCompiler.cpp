@@ -0,0 +1,199 @@
+#include "TierUpCompiler.h"
+#include "llvmgen/LLVMGen.h"
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Support/Casting.h>
+#include <llvm/Support/TargetSelect.h>
+#include <set>
+#include <vector>
+
+TierUpCompiler::TierUpCompiler(MIRModule& module, CompilerInstance& ci, OptLevel level)
+    : mirModule(module), compiler(ci), optLevel(level){
+    for(auto& function : mirModule.functions){
+        functionsByName[function->name] = function.get();
+    }
+}
+
+TierUpCompiler::~TierUpCompiler(){
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+        queue.clear(); // まだ始まっていないコンパイルは捨てる
+    }
+    queueCondition.notify_all();
+    if(worker.joinable()) worker.join();
+}
+
+// LLVMの値をスロット(uint64_t)の表現に変換する
+static llvm::Value* toSlot(llvm::IRBuilder<>& builder, llvm::Value* value){
+    llvm::Type* type = value->getType();
+    llvm::Type* i64 = builder.getInt64Ty();
+    if(type->isIntegerTy(1)) return builder.CreateZExt(value, i64);
+    if(type->isIntegerTy()) return builder.CreateSExtOrTrunc(value, i64);
+    if(type->isFloatTy()) return builder.CreateBitCast(builder.CreateFPExt(value, builder.getDoubleTy()), i64);
+    if(type->isDoubleTy()) return builder.CreateBitCast(value, i64);
+    if(type->isPointerTy()) return builder.CreatePtrToInt(value, i64);
+    return nullptr;
+}
+
+// スロットの表現からLLVMの値に戻す
+static llvm::Value* fromSlot(llvm::IRBuilder<>& builder, llvm::Value* slot, llvm::Type* type){
+    if(type->isIntegerTy()) return builder.CreateTrunc(slot, type);
+    if(type->isFloatTy()) return builder.CreateFPTrunc(builder.CreateBitCast(slot, builder.getDoubleTy()), type);
+    if(type->isDoubleTy()) return builder.CreateBitCast(slot, type);
+    if(type->isPointerTy()) return builder.CreateIntToPtr(slot, type);
+    return nullptr;
+}
+
+std::optional<llvm::orc::ThreadSafeModule> TierUpCompiler::buildModule(MIRFunction* function, std::string& entryName){
+    // 呼び出される関数を推移的に集める (LLVMGenは呼び出し先がモジュール内にある必要がある)
+    std::set<MIRFunction*> reachable;
+    std::vector<MIRFunction*> worklist{function};
+    while(!worklist.empty()){
+        MIRFunction* current = worklist.back();
+        worklist.pop_back();
+        if(!reachable.insert(current).second) continue;
+        for(auto& block : current->basicBlocks){
+            for(auto& inst : block->instructions){
+                auto call = llvm::dyn_cast<MIRCallInstruction>(&inst);
+                if(!call) continue;
+                auto callee = functionsByName.find(call->calleeName);
+                if(callee != functionsByName.end()) worklist.push_back(callee->second);
+            }
+        }
+    }
+    // 元のモジュールの順番を保ってサブモジュールを作る
+    MIRModule subModule(mirModule.name, mirModule.types);
+    for(auto& candidate : mirModule.functions){
+        if(reachable.count(candidate.get())) subModule.addFunction(candidate);
+    }
+
+    // JITDylibごとに別のコンテキストを使う (メインのモジュールのコンテキストとは別)
+    auto context = std::make_unique<llvm::LLVMContext>();
+    // 失敗してもインタプリタで実行を続けるだけなので、エラーは使い捨てのErrorHandlerに入れて表示しない
+    ErrorHandler scratchDiagnostics;
+    LLVMGen llvmGen(compiler, scratchDiagnostics, *context);
+    if(!llvmGen.generate(&subModule) || scratchDiagnostics.hasError()) return std::nullopt;
+    std::unique_ptr<llvm::Module> module = llvmGen.releaseModule();
+
+    const std::string& functionName = compiler.getNameTable().str(function->name);
+    llvm::Function* target = module->getFunction(functionName);
+    if(!target) return std::nullopt;
+    entryName = "__luma_tier_entry_" + functionName;
+    llvm::IRBuilder<> builder(*context);
+    llvm::Function* entry = llvm::Function::Create(
+        llvm::FunctionType::get(builder.getVoidTy(), {builder.getPtrTy()}, false),
+        llvm::Function::ExternalLinkage,
+        entryName,
+        module.get()
+    );
+    builder.SetInsertPoint(llvm::BasicBlock::Create(*context, "entry", entry));
+    llvm::Value* slots = entry->getArg(0);
+    std::vector<llvm::Value*> args;
+    for(unsigned i = 0; i < target->arg_size(); i++){
+        llvm::Value* slotPtr = builder.CreateConstGEP1_64(builder.getInt64Ty(), slots, i);
+        llvm::Value* arg = fromSlot(builder, builder.CreateLoad(builder.getInt64Ty(), slotPtr), target->getArg(i)->getType());
+        if(!arg) return std::nullopt;
+        args.push_back(arg);
+    }
+    llvm::Value* result = builder.CreateCall(target, args);
+    if(!target->getReturnType()->isVoidTy()){
+        llvm::Value* slotValue = toSlot(builder, result);
+        if(!slotValue) return std::nullopt;
+        builder.CreateStore(slotValue, slots);
+    }
+    builder.CreateRetVoid();
+    if(llvm::verifyModule(*module)) return std::nullopt;
+    return llvm::orc::ThreadSafeModule(std::move(module), std::move(context));
+}
+
+llvm::Expected<TierUpCompiler::NativeEntry> TierUpCompiler::materialize(llvm::orc::ThreadSafeModule module, const std::string& entryName){
+    llvm::orc::JITDylib* dylib = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(jitMutex);
+        if(!jit){
+            llvm::InitializeNativeTarget();
+            llvm::InitializeNativeTargetAsmPrinter();
+            auto created = LumaJIT::create({optLevel});
+            if(!created) return created.takeError();
+            jit = std::move(*created);
+        }
+        // 同じ関数が複数のモジュールに含まれることがあるので、モジュールごとに別のJITDylibに入れる
+        auto created = jit->getLLJIT().createJITDylib("tier" + std::to_string(dylibCounter++));
+        if(!created) return created.takeError();
+        dylib = &*created;
+        if(auto err = jit->defineRuntimeSymbols(*dylib)) return std::move(err);
+    }
+    // コンパイル自体はロックの外で行う (ExecutionSessionはスレッドセーフ)
+    auto& lljit = jit->getLLJIT();
+    if(auto err = lljit.addIRModule(*dylib, std::move(module))) return std::move(err);
+    auto symbol = lljit.lookup(*dylib, entryName);
+    if(!symbol) return symbol.takeError();
+    return symbol->toPtr<void(uint64_t*)>();
+}
+
+bool TierUpCompiler::request(MIRFunction* function, std::atomic<NativeEntry>* slot){
+    requestedCount++;
+    std::string entryName;
+    auto module = buildModule(function, entryName);
+    if(!module){
+        failedCount++;
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queue.push_back({std::move(*module), entryName, slot});
+        if(!worker.joinable()) worker = std::thread([this]{ workerLoop(); });
+    }
+    queueCondition.notify_one();
+    return true;
+}
+
+TierUpCompiler::NativeEntry TierUpCompiler::compileNow(MIRFunction* function){
+    requestedCount++;
+    std::string entryName;
+    auto module = buildModule(function, entryName);
+    if(!module){
+        failedCount++;
+        return nullptr;
+    }
+    auto entry = materialize(std::move(*module), entryName);
+    if(!entry){
+        // 失敗は数えるだけで表示しない (呼び出し元のインタプリタが実行できない関数として報告する)
+        llvm::consumeError(entry.takeError());
+        failedCount++;
+        return nullptr;
+    }
+    compiledCount++;
+    return *entry;
+}
+
+void TierUpCompiler::workerLoop(){
+    while(true){
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this]{ return stopping || !queue.empty(); });
+            if(stopping) return;
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+        auto entry = materialize(std::move(job.module), job.entryName);
+        if(!entry){
+            llvm::consumeError(entry.takeError());
+            failedCount++;
+            continue;
+        }
+        // インタプリタは次の呼び出しからネイティブコードを使う
+        job.slot->store(*entry, std::memory_order_release);
+        compiledCount++;
+    }
+}
+
+TierUpCompiler::Stats TierUpCompiler::getStats() const {
+    Stats stats;
+    stats.requested = requestedCount;
+    stats.compiled = compiledCount.load();
+    stats.failed = failedCount.load();
+    return stats;
+}
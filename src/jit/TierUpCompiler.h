@@ -0,0 +1,70 @@
+#pragma once
+#include "jit/LumaJIT.h"
+#include "llvmgen/LLVMOptimizer.h"
+#include "mir/MIRFunction.h"
+#include "mir/MIRModule.h"
+#include "driver/CompilerInstance.h"
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+// インタプリタで熱くなった関数をLLVMGen + LLJITでネイティブコードにするクラス
+// 呼び出し規約をそろえるため、関数ごとに void entry(uint64_t* slots) というラッパーを作る。
+// 引数はslots[0..n)から読み、戻り値はslots[0]に書く。
+// (整数は64bitに符号拡張、boolは0/1、浮動小数点数はdoubleのビット列、ポインタはアドレス)
+class TierUpCompiler{
+public:
+    using NativeEntry = void (*)(uint64_t*);
+    struct Stats{
+        uint64_t requested = 0; // コンパイルを依頼された回数
+        uint64_t compiled = 0;  // ネイティブコードに置き換わった回数
+        uint64_t failed = 0;    // LLVMGenやJITで失敗した回数
+    };
+private:
+    struct Job{
+        llvm::orc::ThreadSafeModule module;
+        std::string entryName;
+        std::atomic<NativeEntry>* slot;
+    };
+    MIRModule& mirModule;
+    CompilerInstance& compiler;
+    OptLevel optLevel;
+    std::unordered_map<NameId, MIRFunction*> functionsByName;
+    // JITはLLVMの初期化に時間がかかるので、最初のtier-upまで作らない
+    std::unique_ptr<LumaJIT> jit;
+    std::mutex jitMutex;
+    unsigned dylibCounter = 0;
+    // バックグラウンドのコンパイルスレッド
+    std::thread worker;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::deque<Job> queue;
+    bool stopping = false;
+    std::atomic<uint64_t> compiledCount{0};
+    std::atomic<uint64_t> failedCount{0};
+    uint64_t requestedCount = 0;
+
+    // functionと、そこから呼ばれる関数すべてをLLVM IRにしてラッパーを付け加える (呼び出し元のスレッドで行う)
+    std::optional<llvm::orc::ThreadSafeModule> buildModule(MIRFunction* function, std::string& entryName);
+    // 新しいJITDylibにモジュールを追加してラッパーのアドレスを得る
+    llvm::Expected<NativeEntry> materialize(llvm::orc::ThreadSafeModule module, const std::string& entryName);
+    void workerLoop();
+public:
+    TierUpCompiler(MIRModule& module, CompilerInstance& compiler, OptLevel level);
+    ~TierUpCompiler();
+    // バックグラウンドでコンパイルし、終わったらslotにラッパーを書き込む
+    // IRの生成に失敗したらfalse
+    bool request(MIRFunction* function, std::atomic<NativeEntry>* slot);
+    // その場でコンパイルする (インタプリタで実行できない関数用)。失敗したらnullptr
+    NativeEntry compileNow(MIRFunction* function);
+    Stats getStats() const;
+};
@@ -0,0 +1,212 @@
+#include "FastLexer.h"
+#include "LumaLexer.h"
+#include <bit>
+#include <cstring>
+#include <iostream>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using L = Luma::LumaLexer;
+
+static inline bool isDigit(char c){ return c >= '0' && c <= '9'; }
+static inline bool isAlpha(char c){ return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+static inline bool isWhitespace(char c){ return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+size_t FastLexer::skipWhitespace(size_t pos){
+    const char* data = source.data();
+    size_t size = source.size();
+#if defined(__SSE2__)
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i carriage = _mm_set1_epi8('\r');
+    while(pos + 16 <= size){
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        __m128i isNewline = _mm_cmpeq_epi8(chunk, newline);
+        __m128i isSpace = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+                                       _mm_or_si128(isNewline, _mm_cmpeq_epi8(chunk, carriage)));
+        unsigned spaceMask = static_cast<unsigned>(_mm_movemask_epi8(isSpace));
+        unsigned newlineMask = static_cast<unsigned>(_mm_movemask_epi8(isNewline));
+        // 空白でない最初の文字より前の改行だけを数える
+        unsigned stop = spaceMask == 0xFFFF ? 16 : static_cast<unsigned>(std::countr_zero(~spaceMask));
+        newlineMask &= (1u << stop) - 1;
+        if(newlineMask){
+            line += std::popcount(newlineMask);
+            lineStart = pos + (31 - std::countl_zero(newlineMask)) + 1;
+        }
+        pos += stop;
+        if(stop < 16) return pos;
+    }
+#endif
+    while(pos < size && isWhitespace(data[pos])){
+        if(data[pos] == '\n'){
+            line++;
+            lineStart = pos + 1;
+        }
+        pos++;
+    }
+    return pos;
+}
+
+size_t FastLexer::scanIdentifierTail(size_t pos) const {
+    const char* data = source.data();
+    size_t size = source.size();
+#if defined(__SSE2__)
+    // 0x80以上のバイトは符号付き比較で負になるので、どの範囲にも入らない
+    const __m128i lowerA = _mm_set1_epi8('a' - 1);
+    const __m128i lowerZ = _mm_set1_epi8('z' + 1);
+    const __m128i digit0 = _mm_set1_epi8('0' - 1);
+    const __m128i digit9 = _mm_set1_epi8('9' + 1);
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    while(pos + 16 <= size){
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        __m128i lower = _mm_or_si128(chunk, caseBit);
+        __m128i isLetter = _mm_and_si128(_mm_cmpgt_epi8(lower, lowerA), _mm_cmplt_epi8(lower, lowerZ));
+        __m128i isNumber = _mm_and_si128(_mm_cmpgt_epi8(chunk, digit0), _mm_cmplt_epi8(chunk, digit9));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(isLetter, isNumber)));
+        if(mask != 0xFFFF) return pos + std::countr_zero(~mask);
+        pos += 16;
+    }
+#endif
+    while(pos < size && (isAlpha(data[pos]) || isDigit(data[pos]))) pos++;
+    return pos;
+}
+
+size_t FastLexer::scanDigits(size_t pos) const {
+    const char* data = source.data();
+    size_t size = source.size();
+#if defined(__SSE2__)
+    const __m128i digit0 = _mm_set1_epi8('0' - 1);
+    const __m128i digit9 = _mm_set1_epi8('9' + 1);
+    while(pos + 16 <= size){
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        __m128i isNumber = _mm_and_si128(_mm_cmpgt_epi8(chunk, digit0), _mm_cmplt_epi8(chunk, digit9));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(isNumber));
+        if(mask != 0xFFFF) return pos + std::countr_zero(~mask);
+        pos += 16;
+    }
+#endif
+    while(pos < size && isDigit(source[pos])) pos++;
+    return pos;
+}
+
+size_t FastLexer::codePointLength(size_t pos) const {
+    // ANTLRInputStreamはUTF-8をコードポイント単位で読むので、エラーもコードポイント単位で読み飛ばす
+    unsigned char lead = static_cast<unsigned char>(source[pos]);
+    size_t length = 1;
+    if(lead >= 0xF0) length = 4;
+    else if(lead >= 0xE0) length = 3;
+    else if(lead >= 0xC0) length = 2;
+    size_t end = pos + 1;
+    while(end < source.size() && end < pos + length && (static_cast<unsigned char>(source[end]) & 0xC0) == 0x80) end++;
+    return end - pos;
+}
+
+void FastLexer::reportError(size_t start, size_t end){
+    errorCount++;
+    // ANTLRのConsoleErrorListenerと同じ形式
+    std::cerr << "line " << line << ":" << (start - lineStart) << " token recognition error at: '"
+              << source.substr(start, end - start) << "'" << std::endl;
+    // 読み飛ばした部分の改行を数え、マルチバイト文字は1文字として列を数える
+    for(size_t pos = start; pos < end; pos++){
+        if(source[pos] == '\n'){
+            line++;
+            lineStart = pos + 1;
+        }else if((static_cast<unsigned char>(source[pos]) & 0xC0) == 0x80){
+            lineStart++;
+        }
+    }
+}
+
+int32_t FastLexer::keywordOrIdentifier(std::string_view text){
+    // キーワードと同じ綴りならキーワード (ANTLRでは同じ長さの一致は先に定義したルールが勝つ)
+    switch(text.size()){
+        case 2:
+            if(text == "if") return L::IF;
+            if(text == "fn") return L::FN;
+            if(text == "as") return L::AS;
+            break;
+        case 3:
+            if(text == "var") return L::VAR;
+            if(text == "let") return L::LET;
+            if(text == "for") return L::FOR;
+            if(text == "int") return L::TYPE_INT64;
+            if(text == "i32") return L::TYPE_INT32;
+            if(text == "f32") return L::TYPE_FLOAT32;
+            break;
+        case 4:
+            if(text == "else") return L::ELSE;
+            if(text == "char") return L::TYPE_CHAR;
+            break;
+        case 5:
+            if(text == "float") return L::TYPE_FLOAT64;
+            break;
+        case 6:
+            if(text == "return") return L::RETURN;
+            break;
+    }
+    return L::IDENTIFIER;
+}
+
+std::vector<LexToken> FastLexer::tokenize(){
+    std::vector<LexToken> tokens;
+    tokens.reserve(source.size() / 4 + 1);
+    const char* data = source.data();
+    size_t size = source.size();
+    size_t pos = 0;
+    while(true){
+        pos = skipWhitespace(pos);
+        if(pos >= size) break;
+        size_t start = pos;
+        char c = data[pos];
+        int32_t type = 0;
+        if(isAlpha(c)){
+            pos = scanIdentifierTail(pos + 1);
+            type = keywordOrIdentifier(source.substr(start, pos - start));
+        }else if(isDigit(c) || ((c == '+' || c == '-') && pos + 1 < size && isDigit(data[pos + 1]))){
+            // 符号付きの数値は演算子より長く一致するので優先される
+            pos = scanDigits(c == '+' || c == '-' ? pos + 1 : pos);
+            type = L::INTEGER;
+            if(pos + 1 < size && data[pos] == '.' && isDigit(data[pos + 1])){
+                pos = scanDigits(pos + 1);
+                type = L::DECIMAL;
+            }
+        }else{
+            char next = pos + 1 < size ? data[pos + 1] : '\0';
+            pos++;
+            switch(c){
+                case '=': if(next == '='){ pos++; type = L::EQEQ; } else type = L::EQ; break;
+                case '>': if(next == '='){ pos++; type = L::GE; } else type = L::GT; break;
+                case '<': if(next == '='){ pos++; type = L::LE; } else type = L::LT; break;
+                case '!':
+                    if(next == '='){ pos++; type = L::NE; break; }
+                    // ANTLRは'!'の次の文字まで読んでから失敗し、その文字も読み飛ばす
+                    if(pos < size) pos += codePointLength(pos);
+                    reportError(start, pos);
+                    continue;
+                case '+': type = L::ADD; break;
+                case '-': type = L::SUB; break;
+                case '*': type = L::MUL; break;
+                case '/': type = L::DIV; break;
+                case ':': type = L::COLON; break;
+                case ';': type = L::SEMI; break;
+                case ',': type = L::COMMA; break;
+                case '(': type = L::LPAREN; break;
+                case ')': type = L::RPAREN; break;
+                case '{': type = L::LBRACE; break;
+                case '}': type = L::RBRACE; break;
+                case '[': type = L::LBRACKET; break;
+                case ']': type = L::RBRACKET; break;
+                default:
+                    pos = start + codePointLength(start);
+                    reportError(start, pos);
+                    continue;
+            }
+        }
+        tokens.push_back({static_cast<uint32_t>(start), static_cast<uint32_t>(pos - start),
+                          static_cast<uint32_t>(line), static_cast<uint32_t>(start - lineStart), type});
+    }
+    tokens.push_back({static_cast<uint32_t>(size), 0, static_cast<uint32_t>(line), static_cast<uint32_t>(size - lineStart), -1});
+    return tokens;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// 字句解析の結果 (ソースへの位置だけを持ち、文字列はコピーしない)
+struct LexToken{
+    uint32_t offset; // ソース上のバイト位置
+    uint32_t length; // バイト数
+    uint32_t line;   // 行 (1始まり)
+    uint32_t column; // 行内の位置 (0始まり、ANTLRのcharPositionInLineと同じ)
+    int32_t type;    // LumaLexerのトークン種別 (EOFは-1)
+};
+
+// grammar/LumaLexer.g4 と同じトークンを切り出す手書きの字句解析器
+// ANTLRの最長一致のルールをそのまま再現している (例: "a-1" は IDENTIFIER INTEGER(-1) になる)
+// 空白・識別子・数字の読み飛ばしにはSSE2を使う (使えない環境では1文字ずつ読む)
+class FastLexer{
+private:
+    std::string_view source;
+    size_t line = 1;
+    size_t lineStart = 0; // 現在の行の先頭のバイト位置 (マルチバイト文字の分だけ後ろにずらして列を文字数にする)
+    size_t errorCount = 0;
+    size_t skipWhitespace(size_t pos);
+    size_t scanIdentifierTail(size_t pos) const;
+    size_t scanDigits(size_t pos) const;
+    size_t codePointLength(size_t pos) const;
+    void reportError(size_t start, size_t end);
+    static int32_t keywordOrIdentifier(std::string_view text);
+public:
+    explicit FastLexer(std::string_view src) : source(src) {}
+    // 末尾にEOFトークンを付けたトークン列を返す
+    // 認識できない文字はANTLRと同じようにエラーを表示して読み飛ばす
+    std::vector<LexToken> tokenize();
+    size_t getErrorCount() const {return errorCount;}
+};
@@ -0,0 +1,61 @@
+#include "FastTokenSource.h"
+#include "LumaLexer.h"
+#include <algorithm>
+
+std::unique_ptr<antlr4::Token> FastTokenSource::nextToken(){
+    const LexToken& lexToken = tokens[std::min(next, tokens.size() - 1)];
+    if(next < tokens.size()) next++;
+    std::unique_ptr<antlr4::CommonToken> token;
+    if(lexToken.type < 0){
+        token = std::make_unique<antlr4::CommonToken>(antlr4::Token::EOF, "<EOF>");
+    }else{
+        token = std::make_unique<antlr4::CommonToken>(static_cast<size_t>(lexToken.type), std::string(source.substr(lexToken.offset, lexToken.length)));
+    }
+    token->setLine(lexToken.line);
+    token->setCharPositionInLine(lexToken.column);
+    // ANTLRの位置はコードポイント単位だが、ここではバイト単位 (パーサーはテキストと行・列しか使わない)
+    token->setStartIndex(lexToken.offset);
+    token->setStopIndex(lexToken.offset + lexToken.length - 1);
+    return token;
+}
+
+size_t FastTokenSource::getLine() const {
+    return tokens[std::min(next, tokens.size() - 1)].line;
+}
+
+size_t FastTokenSource::getCharPositionInLine(){
+    return tokens[std::min(next, tokens.size() - 1)].column;
+}
+
+antlr4::TokenFactory<antlr4::CommonToken>* FastTokenSource::getTokenFactory(){
+    return antlr4::CommonTokenFactory::DEFAULT.get();
+}
+
+bool FastTokenSource::crossCheck(std::string_view src, const std::vector<LexToken>& lexTokens, std::ostream& os){
+    antlr4::ANTLRInputStream input(src);
+    Luma::LumaLexer lexer(&input);
+    lexer.removeErrorListeners(); // エラーはFastLexerが既に表示している
+    auto antlrTokens = lexer.getAllTokens();
+    // FastLexerの最後はEOFなので除く
+    size_t fastCount = lexTokens.empty() ? 0 : lexTokens.size() - 1;
+    size_t count = std::min(fastCount, antlrTokens.size());
+    for(size_t i = 0; i < count; i++){
+        const LexToken& fast = lexTokens[i];
+        const auto& antlrToken = antlrTokens[i];
+        std::string fastText(src.substr(fast.offset, fast.length));
+        if(static_cast<size_t>(fast.type) != antlrToken->getType() || fastText != antlrToken->getText() ||
+           fast.line != antlrToken->getLine() || fast.column != antlrToken->getCharPositionInLine()){
+            os << "Lexer mismatch at token " << i << ": fast " << lexer.getVocabulary().getSymbolicName(fast.type)
+               << " '" << fastText << "' " << fast.line << ":" << fast.column
+               << ", antlr " << lexer.getVocabulary().getSymbolicName(antlrToken->getType())
+               << " '" << antlrToken->getText() << "' " << antlrToken->getLine() << ":" << antlrToken->getCharPositionInLine() << std::endl;
+            return false;
+        }
+    }
+    if(fastCount != antlrTokens.size()){
+        os << "Lexer mismatch: fast produced " << fastCount << " tokens, antlr produced " << antlrTokens.size() << std::endl;
+        return false;
+    }
+    os << "Lexer check passed: " << fastCount << " tokens match." << std::endl;
+    return true;
+}
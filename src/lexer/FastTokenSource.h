@@ -0,0 +1,30 @@
+#pragma once
+#include "antlr4-runtime.h"
+#include "lexer/FastLexer.h"
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// FastLexerのトークン列をANTLRのパーサーに渡すためのTokenSource
+// LumaLexerの代わりにCommonTokenStreamに渡して使う
+class FastTokenSource : public antlr4::TokenSource{
+private:
+    std::string_view source;
+    const std::vector<LexToken>& tokens;
+    std::string sourceName;
+    size_t next = 0;
+public:
+    FastTokenSource(std::string_view src, const std::vector<LexToken>& lexTokens, const std::string& name)
+        : source(src), tokens(lexTokens), sourceName(name) {}
+    std::unique_ptr<antlr4::Token> nextToken() override;
+    size_t getLine() const override;
+    size_t getCharPositionInLine() override;
+    antlr4::CharStream* getInputStream() override {return nullptr;}
+    std::string getSourceName() override {return sourceName;}
+    antlr4::TokenFactory<antlr4::CommonToken>* getTokenFactory() override;
+
+    // ANTLRのLumaLexerでも字句解析して、種別・文字列・位置が1トークンずつ一致するか確かめる
+    // (tests/test_lexer.cppのテストで使う。-dbg-lex-checkで手元のファイルを確かめることもできる)
+    static bool crossCheck(std::string_view src, const std::vector<LexToken>& lexTokens, std::ostream& os);
+};
@@ -0,0 +1,90 @@
+#include "CodegenBench.h"
+#include "LLVMGen.h"
+#include "driver/CompilerInstance.h"
+#include "mir/MIRCFGAnalysis.h"
+#include "mirgen/MIRGen.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+bool CodegenBench::run(CompilerInstance& compiler, ProgramNode* program, unsigned iterations, std::ostream& os){
+    double mirTotalMs = 0.0;
+    double mirMinMs = 0.0;
+    double llvmTotalMs = 0.0;
+    double llvmMinMs = 0.0;
+    double analysisTotalMs = 0.0;
+    size_t functions = 0;
+    size_t values = 0;
+    size_t blocks = 0;
+    size_t largestValues = 0;
+    size_t largestBlocks = 0;
+    size_t mirTypes = 0;
+    size_t loops = 0;
+    unsigned maxLoopDepth = 0;
+    for(unsigned i = 0; i < iterations; i++){
+        auto start = std::chrono::steady_clock::now();
+        MIRGen mirGen(compiler);
+        auto mirModule = mirGen.generate(program);
+        double mirMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if(!mirModule || compiler.getDiagnostics().hasError()){
+            os << "Codegen benchmark aborted: MIR generation failed." << std::endl;
+            return false;
+        }
+        mirTotalMs += mirMs;
+        mirMinMs = i == 0 ? mirMs : std::min(mirMinMs, mirMs);
+
+        // 最適化が使うCFGの解析をひととおり作る
+        start = std::chrono::steady_clock::now();
+        for(const auto& function : mirModule->functions){
+            MIRFunctionAnalysis analysis(*function);
+            analysis.getPostDominatorTree();
+            analysis.getDominanceFrontier();
+            const MIRLoopForest& forest = analysis.getLoops();
+            if(i == 0){
+                loops += forest.getLoopCount();
+                for(const auto& block : function->basicBlocks) maxLoopDepth = std::max(maxLoopDepth, forest.getLoopDepth(block.get()));
+            }
+        }
+        analysisTotalMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        llvm::LLVMContext context;
+        start = std::chrono::steady_clock::now();
+        LLVMGen llvmGen(compiler, context);
+        bool verified = llvmGen.generate(mirModule.get()) != nullptr;
+        double llvmMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if(!verified){
+            os << "Codegen benchmark aborted: LLVM IR verification failed." << std::endl;
+            return false;
+        }
+        llvmTotalMs += llvmMs;
+        llvmMinMs = i == 0 ? llvmMs : std::min(llvmMinMs, llvmMs);
+
+        if(i == 0){
+            functions = mirModule->functions.size();
+            mirTypes = mirModule->types->getTypeCount();
+            for(const auto& function : mirModule->functions){
+                values += function->numValues;
+                blocks += function->basicBlocks.size();
+                largestValues = std::max<size_t>(largestValues, function->numValues);
+                largestBlocks = std::max(largestBlocks, function->basicBlocks.size());
+            }
+        }
+    }
+
+    os << "--- Codegen Benchmark ---" << std::endl;
+    os << std::fixed << std::setprecision(3);
+    os << "  MIR                 " << functions << " functions, " << values << " values, " << blocks << " blocks x " << iterations << std::endl;
+    os << "  largest function    " << largestValues << " values, " << largestBlocks << " blocks" << std::endl;
+    if(iterations > 0){
+        os << "  average mir gen     " << mirTotalMs / iterations << " ms" << std::endl;
+        os << "  fastest mir gen     " << mirMinMs << " ms" << std::endl;
+        os << "  average analysis    " << analysisTotalMs / iterations << " ms" << std::endl;
+        os << "  average llvm gen    " << llvmTotalMs / iterations << " ms" << std::endl;
+        os << "  fastest llvm gen    " << llvmMinMs << " ms" << std::endl;
+        os << "  llvm gen throughput " << (llvmTotalMs > 0.0 ? static_cast<double>(values) * iterations / (llvmTotalMs / 1000.0) / 1e6 : 0.0) << " M values/s" << std::endl;
+    }
+    os << "  unique MIR types    " << mirTypes << std::endl;
+    os << "  loops               " << loops << " (max depth " << maxLoopDepth << ")" << std::endl;
+    os << "-------------------------" << std::endl;
+    return true;
+}
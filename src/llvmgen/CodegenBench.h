@@ -0,0 +1,16 @@
+#pragma once
+#include <ostream>
+
+class ProgramNode;
+class CompilerInstance;
+
+// MIR生成とLLVM IR生成の処理速度を測る (-bench-codegen=<N>)
+// セマンティック解析が終わったASTからMIRGen::generateとLLVMGen::generateをN回繰り返し、1回あたりの時間を表示する
+// LLVMGenはオペランドごとにMIRの値からLLVMの値を引くので、大きな関数ほど値の引き方のコストが効く
+// (tests/luma_sources/bench/large.luma は1つの関数に数千のブロックと値がある)
+// 毎回新しいLLVMContextを使うので、LLVMの型や定数の表が育っていく影響は入らない
+class CodegenBench{
+public:
+    // MIR生成かLLVM IRの検証に失敗した場合はfalse
+    static bool run(CompilerInstance& compiler, ProgramNode* program, unsigned iterations, std::ostream& os);
+};
@@ -6,22 +6,45 @@
 #include "mir/MIRTerminator.h"
 #include "mir/MIRType.h"
 #include "mir/MIRValue.h"
-#include "semantic/SemanticAnalysis.h"
+#include "runtime/RuntimeFunctions.h"
 #include "types/TypeTranslate.h"
 #include <llvm-18/llvm/ADT/StringRef.h>
 #include <llvm-18/llvm/IR/BasicBlock.h>
 #include <llvm-18/llvm/IR/Constants.h>
 #include <llvm-18/llvm/IR/DerivedTypes.h>
+#include <llvm/BinaryFormat/Dwarf.h>
+#include <llvm/IR/DebugInfoMetadata.h>
+#include <llvm/IR/InstrTypes.h>
+#include <llvm/IR/Instruction.h>
 #include <llvm/IR/Verifier.h>
+#include <llvm/Support/Casting.h>
+#include <llvm/Support/Path.h>
 #include <llvm/Support/raw_ostream.h>
 
-LLVMGen::LLVMGen(SemanticAnalysis& sema) : context(std::make_unique<llvm::LLVMContext>()), module(std::make_unique<llvm::Module>("LumaModule", *context)),
-                    builder(std::make_unique<llvm::IRBuilder<>>(*context)), semanticAnalysis(sema){}
+LLVMGen::LLVMGen(CompilerInstance& compiler, llvm::LLVMContext& ctx) : LLVMGen(compiler, compiler.getDiagnostics(), ctx) {}
+
+LLVMGen::LLVMGen(CompilerInstance& compiler, ErrorHandler& diag, llvm::LLVMContext& ctx) : context(ctx), module(std::make_unique<llvm::Module>("LumaModule", context)),
+                    builder(std::make_unique<llvm::IRBuilder<>>(context)), diagnostics(diag), names(compiler.getNameTable()), sources(compiler.getSourceManager()){
+    if(compiler.getDebugInfo()){
+        diBuilder = std::make_unique<llvm::DIBuilder>(*module);
+        llvm::StringRef path = sources.getFileName().empty() ? "luma" : llvm::StringRef(sources.getFileName());
+        diFile = diBuilder->createFile(llvm::sys::path::filename(path), llvm::sys::path::parent_path(path));
+        // Luma用のDWARFの言語コードはないので、行と列だけ使うデバッガ・プロファイラが読めるようにCとしておく
+        diBuilder->createCompileUnit(llvm::dwarf::DW_LANG_C, diFile, "Luma", false, "", 0);
+        module->addModuleFlag(llvm::Module::Warning, "Debug Info Version", llvm::DEBUG_METADATA_VERSION);
+        module->addModuleFlag(llvm::Module::Warning, "Dwarf Version", 4);
+    }
+}
 
 llvm::Module* LLVMGen::generate(MIRModule *mirModule){
+    // 後ろで定義された関数も呼べるように、先にすべての関数を宣言してから本体を作る
+    for(auto& func : mirModule->functions){
+        declareFunction(func.get());
+    }
     for(auto& func : mirModule->functions){
         visit(func.get());
     }
+    if(diBuilder) diBuilder->finalize();
     std::string error;
     llvm::raw_string_ostream errorStream(error);
     if(llvm::verifyModule(*module, &errorStream)){
@@ -35,17 +58,20 @@ llvm::Module* LLVMGen::getModule(){
 }
 
 std::unique_ptr<llvm::Module> LLVMGen::releaseModule(){
+    // ビルダーはコンテキストを参照しているので、モジュールと一緒に手放す
+    builder.reset();
+    diBuilder.reset();
     return std::move(module);
 }
 
-void LLVMGen::visit(MIRFunction *node){
+llvm::Function* LLVMGen::declareFunction(MIRFunction *node){
     // 関数の型を生成
     std::vector<llvm::Type*> args;
     for(auto& param : node->arguments){
-        args.push_back(TypeTranslate::toLlvmType(param->type.get(), *context));
+        args.push_back(toLlvmType(param->type));
     }
 
-    llvm::Type* retType = TypeTranslate::toLlvmType(node->returnType.get(), *context);
+    llvm::Type* retType = toLlvmType(node->returnType);
 
     llvm::FunctionType* funcType = llvm::FunctionType::get(
         retType,
@@ -56,25 +82,71 @@ void LLVMGen::visit(MIRFunction *node){
     llvm::Function* llvmFunc = llvm::Function::Create(
         funcType,
         llvm::Function::ExternalLinkage,
-        node->name,
+        names.str(node->name),
         module.get()
     );
+    auto mirArgs = node->arguments.begin();
+    for(auto& llvmArg : llvmFunc->args()){
+        if(mirArgs == node->arguments.end()) break;
+        llvmArg.setName(names.str((*mirArgs++)->argName));
+    }
+    return llvmFunc;
+}
+
+llvm::Function* LLVMGen::declareRuntimeFunction(MIRCallInstruction *node){
+    std::vector<llvm::Type*> args;
+    for(auto& arg : node->arguments){
+        args.push_back(toLlvmType(arg->type));
+    }
+    llvm::Type* retType = node->result ? toLlvmType(node->result->type) : builder->getVoidTy();
+    llvm::Function* llvmFunc = llvm::Function::Create(
+        llvm::FunctionType::get(retType, args, false),
+        llvm::Function::ExternalLinkage,
+        names.str(node->calleeName),
+        module.get()
+    );
+    // Cのboolはゼロ拡張で渡す
+    for(auto& llvmArg : llvmFunc->args()){
+        if(llvmArg.getType()->isIntegerTy(1)) llvmArg.addAttr(llvm::Attribute::ZExt);
+    }
+    return llvmFunc;
+}
+
+void LLVMGen::visit(MIRFunction *node){
+    llvm::Function* llvmFunc = module->getFunction(names.str(node->name));
+    if(!llvmFunc || !llvmFunc->empty()){
+        diagnostics.errorReg("LLVMGen: Function " + names.str(node->name) + " was not declared or is defined twice.", 0);
+        return;
+    }
+
+    values.assign(node->numValues, nullptr);
+    blocks.assign(node->basicBlocks.size(), nullptr);
 
     // 引数のマッピングを追加
     auto mirArgs = node->arguments.begin();
     auto llvmArgs = llvmFunc->arg_begin();
     while (mirArgs != node->arguments.end() && llvmArgs != llvmFunc->arg_end()) {
-        valueMap[mirArgs->get()] = &(*llvmArgs);
-        llvmArgs->setName((*mirArgs)->name);
+        setValue(mirArgs->get(), &(*llvmArgs));
         mirArgs++;
         llvmArgs++;
     }
 
     currentFunction = llvmFunc;
+    currentFunctionLoc = node->loc;
+    currentSubprogram = nullptr;
+    builder->SetCurrentDebugLocation(llvm::DebugLoc());
+    if(diBuilder){
+        unsigned line = sources.getLineColumn(node->loc).line;
+        // 型の情報は付けない (行と列の対応だけ)
+        auto subroutineType = diBuilder->createSubroutineType(diBuilder->getOrCreateTypeArray({}));
+        currentSubprogram = diBuilder->createFunction(diFile, names.str(node->name), llvm::StringRef(), diFile, line, subroutineType, line,
+                                                      llvm::DINode::FlagPrototyped, llvm::DISubprogram::SPFlagDefinition);
+        llvmFunc->setSubprogram(currentSubprogram);
+    }
 
     for(auto& block : node->basicBlocks){
-        llvm::BasicBlock* bb = llvm::BasicBlock::Create(*context, block->name, currentFunction);
-        blockMap[block.get()] = bb;
+        llvm::BasicBlock* bb = llvm::BasicBlock::Create(context, block->name, currentFunction);
+        blocks[block->id] = bb;
     }
 
     for(auto& block : node->basicBlocks){
@@ -83,118 +155,149 @@ void LLVMGen::visit(MIRFunction *node){
 }
 
 void LLVMGen::visit(MIRBasicBlock *node){
-    auto bb = blockMap[node];
+    auto bb = blocks[node->id];
     builder->SetInsertPoint(bb);
     for(auto &instr : node->instructions){
-        visit(instr.get());
+        visit(&instr);
     }
     if(node->terminator){
         visit(node->terminator.get());
     }
 }
 
+void LLVMGen::setDebugLocation(SourceLocation loc){
+    if(!currentSubprogram) return;
+    LineColumn position = sources.getLineColumn(loc.isValid() ? loc : currentFunctionLoc);
+    // DILocationの列は1始まり
+    builder->SetCurrentDebugLocation(llvm::DILocation::get(context, position.line, position.column + 1, currentSubprogram));
+}
+
 void LLVMGen::visit(MIRInstruction *node){
-    if(auto allocaInst = dynamic_cast<MIRAllocaInstruction*>(node)) return visit(allocaInst);
-    if(auto storeInst = dynamic_cast<MIRStoreInstruction*>(node)) return visit(storeInst);
-    if(auto loadInst = dynamic_cast<MIRLoadInstruction*>(node)) return visit(loadInst);
-    if(auto binaryInst = dynamic_cast<MIRBinaryInstruction*>(node)) return visit(binaryInst);
-    if(auto unaryInst = dynamic_cast<MIRUnaryInstruction*>(node)) return visit(unaryInst);
-    if(auto castInst = dynamic_cast<MIRCastInstruction*>(node)) {visit(castInst); return;}
-    if(auto callInst = dynamic_cast<MIRCallInstruction*>(node)) return visit(callInst);
-    if(auto gepInst = dynamic_cast<MIRGepInstruction*>(node)) { visit(gepInst); return; } // 修正
-    errorHandler.errorReg("Unhandled MIRInstruction type: " + std::string(typeid(*node).name()), 0);
+    setDebugLocation(node->loc);
+    dispatch(node);
+}
+
+void LLVMGen::unhandledInstruction(MIRInstruction *node){
+    diagnostics.errorReg("Unhandled MIRInstruction type: " + std::to_string(static_cast<int>(node->getNodeType())), 0);
 }
 
 void LLVMGen::visit(MIRAllocaInstruction *node){
-    llvm::Type* allocType = TypeTranslate::toLlvmType(node->allocatedType.get(), *context);
+    llvm::Type* allocType = toLlvmType(node->allocatedType);
     llvm::Value* allocaVal;
     if(node->size > 0){
         allocaVal = builder->CreateAlloca(
             allocType,
-            llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), node->size),
-            node->varName
+            llvm::ConstantInt::get(llvm::Type::getInt32Ty(context), node->size),
+            names.str(node->varName)
         );
     }else{
         allocaVal = builder->CreateAlloca(
             allocType,
             nullptr,
-            node->varName
+            names.str(node->varName)
         );
     }
-    MIRValue* mirResultValue = node->result.get();
-    valueMap[mirResultValue] = allocaVal;
+    setValue(node->result.get(), allocaVal);
 }
 
 void LLVMGen::visit(MIRStoreInstruction *node){
     llvm::Value* value = visit(node->value.get());
     llvm::Value* ptr = visit(node->pointer.get());
     if(!value || !ptr){
-        errorHandler.errorReg("store ptr or value nullptr", -1);
+        diagnostics.errorReg("store ptr or value nullptr", -1);
         return;
     }
     builder->CreateStore(value, ptr);
 }
 
 void LLVMGen::visit(MIRLoadInstruction *node){
-    llvm::Type* type = TypeTranslate::toLlvmType(node->result->type.get(), *context);
+    llvm::Type* type = toLlvmType(node->result->type);
     llvm::Value* ptr = visit(node->pointer.get());
     llvm::Value* loadedValue = builder->CreateLoad(type, ptr, "loadtmp");
-    valueMap[node->result.get()] = loadedValue;
+    setValue(node->result.get(), loadedValue);
 }
 
-void LLVMGen::visit(MIRBinaryInstruction *node){
-    llvm::Value* left = visit(node->leftOperand.get());
-    llvm::Value* right = visit(node->rightOperand.get());
-    llvm::Value* resultValue = nullptr;
-    if(node->leftOperand->type.get()->isInteger()){
-        if(node->opcode == "add") resultValue = builder->CreateAdd(left, right, "addtmp");
-        if(node->opcode == "sub") resultValue = builder->CreateSub(left, right, "subtmp");
-        if(node->opcode == "mul") resultValue = builder->CreateMul(left, right, "multmp");
-        if(node->opcode == "div") resultValue = builder->CreateSDiv(left,right, "divtmp");
-        if(node->opcode == "icmp eq") resultValue = builder->CreateICmpEQ(left, right, "eqtmp");
-        if(node->opcode == "icmp ne") resultValue = builder->CreateICmpNE(left, right, "netmp");
-        if(node->opcode == "icmp lt") resultValue = builder->CreateICmpSLT(left, right, "lttmp");
-        if(node->opcode == "icmp gt") resultValue = builder->CreateICmpSGT(left, right, "gttmp");
-        if(node->opcode == "icmp le") resultValue = builder->CreateICmpSLE(left, right, "letmp");
-        if(node->opcode == "icmp ge") resultValue = builder->CreateICmpSGE(left, right, "getmp");
-    }else if(node->leftOperand->type.get()->isFloat()){
-        if(node->opcode == "add") resultValue = builder->CreateFAdd(left, right, "faddtmp");
-        if(node->opcode == "sub") resultValue = builder->CreateFSub(left, right, "fsubtmp");
-        if(node->opcode == "mul") resultValue = builder->CreateFMul(left, right, "fmultmp");
-        if(node->opcode == "div") resultValue = builder->CreateFDiv(left,right, "fdivtmp");
-        if(node->opcode == "fcmp eq") resultValue = builder->CreateFCmpOEQ(left, right, "feqtmp");
-        if(node->opcode == "fcmp ne") resultValue = builder->CreateFCmpONE(left, right, "fnetmp");
-        if(node->opcode == "fcmp lt") resultValue = builder->CreateFCmpOLT(left, right, "flttmp");
-        if(node->opcode == "fcmp gt") resultValue = builder->CreateFCmpOGT(left, right, "fgttmp");
-        if(node->opcode == "fcmp le") resultValue = builder->CreateFCmpOLE(left, right, "fletmp");
-        if(node->opcode == "fcmp ge") resultValue = builder->CreateFCmpOGE(left, right, "fgetmp");
+namespace{
+// MIROpcodeごとに作るLLVMの命令 (MIROpcodeTableと同じ順番に並べる)
+struct OpcodeLowering{
+    enum class Kind : uint8_t {BinOp, ICmp, FCmp, Neg, FNeg, Not};
+    Kind kind;
+    unsigned op; // BinOpならllvm::Instruction::BinaryOps、ICmp・FCmpならllvm::CmpInst::Predicate
+    const char* name; // LLVM IRでの値の名前
+};
+using LoweringKind = OpcodeLowering::Kind;
+constexpr OpcodeLowering loweringTable[] = {
+    {LoweringKind::BinOp, llvm::Instruction::Add,   "addtmp"},
+    {LoweringKind::BinOp, llvm::Instruction::FAdd,  "faddtmp"},
+    {LoweringKind::BinOp, llvm::Instruction::Sub,   "subtmp"},
+    {LoweringKind::BinOp, llvm::Instruction::FSub,  "fsubtmp"},
+    {LoweringKind::BinOp, llvm::Instruction::Mul,   "multmp"},
+    {LoweringKind::BinOp, llvm::Instruction::FMul,  "fmultmp"},
+    {LoweringKind::BinOp, llvm::Instruction::SDiv,  "divtmp"},
+    {LoweringKind::BinOp, llvm::Instruction::FDiv,  "fdivtmp"},
+    {LoweringKind::ICmp,  llvm::CmpInst::ICMP_EQ,   "eqtmp"},
+    {LoweringKind::FCmp,  llvm::CmpInst::FCMP_OEQ,  "feqtmp"},
+    {LoweringKind::ICmp,  llvm::CmpInst::ICMP_NE,   "netmp"},
+    {LoweringKind::FCmp,  llvm::CmpInst::FCMP_ONE,  "fnetmp"},
+    {LoweringKind::ICmp,  llvm::CmpInst::ICMP_SLT,  "lttmp"},
+    {LoweringKind::FCmp,  llvm::CmpInst::FCMP_OLT,  "flttmp"},
+    {LoweringKind::ICmp,  llvm::CmpInst::ICMP_SGT,  "gttmp"},
+    {LoweringKind::FCmp,  llvm::CmpInst::FCMP_OGT,  "fgttmp"},
+    {LoweringKind::ICmp,  llvm::CmpInst::ICMP_SLE,  "letmp"},
+    {LoweringKind::FCmp,  llvm::CmpInst::FCMP_OLE,  "fletmp"},
+    {LoweringKind::ICmp,  llvm::CmpInst::ICMP_SGE,  "getmp"},
+    {LoweringKind::FCmp,  llvm::CmpInst::FCMP_OGE,  "fgetmp"},
+    {LoweringKind::Neg,   0,                        "negtmp"},
+    {LoweringKind::FNeg,  0,                        "fnegtmp"},
+    {LoweringKind::Not,   0,                        "nottmp"},
+};
+static_assert(sizeof(loweringTable) / sizeof(loweringTable[0]) == MIROpcodeCount, "loweringTable must list every MIROpcode in order");
+}
+
+llvm::Value* LLVMGen::lowerOpcode(MIROpcode opcode, llvm::ArrayRef<llvm::Value*> operands){
+    const MIROpcodeInfo& info = getOpcodeInfo(opcode);
+    if(operands.size() != info.operands){
+        diagnostics.errorReg(std::string("Wrong number of operands for MIR opcode ") + info.name, 0);
+        return nullptr;
+    }
+    for(llvm::Value* operand : operands){
+        if(!operand){
+            diagnostics.errorReg(std::string("Operand of MIR opcode ") + info.name + " was not generated.", 0);
+            return nullptr;
+        }
+        // 整数版・浮動小数点数版を取り違えるとLLVMの命令が作れないので、ここで止める
+        if(operand->getType()->isFloatingPointTy() != info.isFloat){
+            diagnostics.errorReg(std::string("Operand type does not match MIR opcode ") + info.name, 0);
+            return nullptr;
+        }
+    }
+    const OpcodeLowering& lowering = loweringTable[static_cast<size_t>(opcode)];
+    switch(lowering.kind){
+        case LoweringKind::BinOp: return builder->CreateBinOp(static_cast<llvm::Instruction::BinaryOps>(lowering.op), operands[0], operands[1], lowering.name);
+        case LoweringKind::ICmp: return builder->CreateICmp(static_cast<llvm::CmpInst::Predicate>(lowering.op), operands[0], operands[1], lowering.name);
+        case LoweringKind::FCmp: return builder->CreateFCmp(static_cast<llvm::CmpInst::Predicate>(lowering.op), operands[0], operands[1], lowering.name);
+        case LoweringKind::Neg: return builder->CreateNeg(operands[0], lowering.name);
+        case LoweringKind::FNeg: return builder->CreateFNeg(operands[0], lowering.name);
+        case LoweringKind::Not: return builder->CreateNot(operands[0], lowering.name);
     }
+    return nullptr;
+}
+
+void LLVMGen::visit(MIRBinaryInstruction *node){
+    llvm::Value* resultValue = lowerOpcode(node->opcode, {visit(node->leftOperand.get()), visit(node->rightOperand.get())});
     if(resultValue){
-        valueMap[node->result.get()] = resultValue;
+        setValue(node->result.get(), resultValue);
     }
 }
 
 void LLVMGen::visit(MIRUnaryInstruction *node){
-    llvm::Value* operand = visit(node->operand.get());
-    llvm::Value* resultValue = nullptr;
-    if(node->opcode == "neg"){
-        if(node->operand->type.get()->isInteger()) resultValue = builder->CreateNeg(operand, "negtmp");
-        else if(node->operand->type.get()->isFloat()) resultValue = builder->CreateFNeg(operand, "fnegtmp");
-    }
-    if(node->opcode == "not"){
-        if(node->operand->type.get()->isInteger()) resultValue = builder->CreateNot(operand, "nottmp");
-        else if(node->operand->type.get()->isFloat()){
-            // TODO: セマンティック解析でエラーを出す
-            return;
-        }
-    }
-    if(resultValue) valueMap[node->result.get()] = resultValue;
+    llvm::Value* resultValue = lowerOpcode(node->opcode, {visit(node->operand.get())});
+    if(resultValue) setValue(node->result.get(), resultValue);
 }
 
 void LLVMGen::visit(MIRTerminatorInstruction *node){
-    if(auto retInst = dynamic_cast<MIRReturnInstruction*>(node)) return visit(retInst);
-    if(auto branchInst = dynamic_cast<MIRBranchInstruction*>(node)) return visit(branchInst);
-    if(auto condBranchInst = dynamic_cast<MIRConditionBranchInstruction*>(node)) return visit(condBranchInst);
+    setDebugLocation(node->loc);
+    dispatch(node);
 }
 
 void LLVMGen::visit(MIRReturnInstruction *node){
@@ -203,7 +306,7 @@ void LLVMGen::visit(MIRReturnInstruction *node){
         if(retVal){
             builder->CreateRet(retVal);
         }else{
-            errorHandler.errorReg("Failed to generate return value in LLVMGen.", 0);
+            diagnostics.errorReg("Failed to generate return value in LLVMGen.", 0);
             builder->CreateRetVoid();
         }
     }else{
@@ -212,14 +315,14 @@ void LLVMGen::visit(MIRReturnInstruction *node){
 }
 
 void LLVMGen::visit(MIRBranchInstruction *node){
-    auto targetBlock = blockMap[node->targetBlock.get()];
+    auto targetBlock = blocks[node->targetBlock->id];
     if(!targetBlock) return;
     builder->CreateBr(targetBlock);
 }
 
 void LLVMGen::visit(MIRConditionBranchInstruction *node){
-    auto trueBlock = blockMap[node->trueBlock.get()];
-    auto falseBlock = blockMap[node->falseBlock.get()];
+    auto trueBlock = blocks[node->trueBlock->id];
+    auto falseBlock = blocks[node->falseBlock->id];
     llvm::Value* cond = visit(node->condition.get());
     builder->CreateCondBr(cond, trueBlock, falseBlock);
 }
@@ -229,19 +332,19 @@ llvm::Value* LLVMGen::visit(MIRGepInstruction *node){
     llvm::Value* index = visit(node->index.get());
 
     if (!basePtr || !index) {
-        errorHandler.errorReg("GEP base pointer or index is null.", 0);
+        diagnostics.errorReg("GEP base pointer or index is null.", 0);
         return nullptr;
     }
 
-    llvm::Type* ptrOrArrayType = TypeTranslate::toLlvmType(node->ptrOrArrayType.get(), *context);
+    llvm::Type* ptrOrArrayType = toLlvmType(node->ptrOrArrayType);
 
     if (!ptrOrArrayType) {
-        errorHandler.errorReg("GEP ptrOrArrayType is null or invalid.", 0);
+        diagnostics.errorReg("GEP ptrOrArrayType is null or invalid.", 0);
         return nullptr;
     }
     
     std::vector<llvm::Value*> indices;
-    indices.push_back(llvm::ConstantInt::get(llvm::Type::getInt64Ty(*context), 0)); // 配列自体へのオフセット
+    indices.push_back(llvm::ConstantInt::get(llvm::Type::getInt64Ty(context), 0)); // 配列自体へのオフセット
     indices.push_back(index); // 配列内の要素へのオフセット
 
     llvm::Value* gep = builder->CreateGEP(
@@ -251,75 +354,86 @@ llvm::Value* LLVMGen::visit(MIRGepInstruction *node){
         "geptmp"
     );
 
-    valueMap[node->result.get()] = gep;
+    setValue(node->result.get(), gep);
     return gep;
 }
 
+llvm::Type* LLVMGen::toLlvmType(const MIRType* type){
+    if(!type) return TypeTranslate::toLlvmType(type, context);
+    if(type->index >= llvmTypes.size()) llvmTypes.resize(type->index + 1, nullptr);
+    llvm::Type*& slot = llvmTypes[type->index];
+    if(!slot) slot = TypeTranslate::toLlvmType(type, context);
+    return slot;
+}
+
+void LLVMGen::setValue(const MIRValue* node, llvm::Value* value){
+    if(node->id < values.size()) values[node->id] = value;
+}
+
 llvm::Value* LLVMGen::visit(MIRValue *node){
-    if(valueMap.count(node)) return valueMap[node];
+    if(node->id < values.size() && values[node->id]) return values[node->id];
 
-    if(auto literal = dynamic_cast<MIRLiteralValue*>(node)) return visit(literal);
-    if(auto cast = dynamic_cast<MIRCastInstruction*>(node)) return visit(cast);
+    if(auto literal = llvm::dyn_cast<MIRLiteralValue>(node)) return visit(literal);
 
-    errorHandler.errorReg("Could not find or generate LLVM value for MIRValue.", 0);
+    diagnostics.errorReg("Could not find or generate LLVM value for MIRValue.", 0);
     return nullptr;
 }
 
 llvm::Value* LLVMGen::visit(MIRLiteralValue *node){
-    // llvm::Type* type = TypeTranslate::toLlvmType(node->type.get(), *context);
+    // llvm::Type* type = TypeTranslate::toLlvmType(node->type.get(), context);
 
     // std::string type_str;
     // llvm::raw_string_ostream rso(type_str);
     // type->print(rso);
-    // errorHandler.errorReg("Visiting MIRLiteralValue. Type is: " + rso.str(), 2);
+    // diagnostics.errorReg("Visiting MIRLiteralValue. Type is: " + rso.str(), 2);
     // if(type->isIntegerTy()){
     //     if(auto* intType = llvm::dyn_cast<llvm::IntegerType>(type)){
     //         return llvm::ConstantInt::get(intType, llvm::StringRef(node->stringValue), 10);
     //     }
-    //     errorHandler.errorReg("Failed to cast to IntegerType in LLVMGen.", 0);
+    //     diagnostics.errorReg("Failed to cast to IntegerType in LLVMGen.", 0);
     //     return nullptr;
     // }
     // if(type->isFloatingPointTy()) return llvm::ConstantFP::get(type, llvm::StringRef(node->stringValue));
     // // TODO: boolなど
     // return nullptr;
-    llvm::Type*  type = TypeTranslate::toLlvmType(node->type.get(), *context);
+    llvm::Type*  type = toLlvmType(node->type);
     if(!type){
-        errorHandler.errorReg("Failed to translate literal type", 0);
+        diagnostics.errorReg("Failed to translate literal type", 0);
         return nullptr;
     }
     if(type->isIntegerTy()){
         auto* intType = llvm::cast<llvm::IntegerType>(type);
         unsigned bits = intType->getBitWidth();
         llvm::APInt api(bits, llvm::StringRef(node->stringValue), 10);
-        return llvm::ConstantInt::get(*context, api);
+        return llvm::ConstantInt::get(context, api);
     }
     if(type->isFloatingPointTy()){
         double d = 0.0;
         try{
             d = std::stod(node->stringValue);
         }catch(...){
-            errorHandler.errorReg("Invalid floating literal: " + node->stringValue, 0);
+            diagnostics.errorReg("Invalid floating literal: " + node->stringValue, 0);
             return nullptr;
         }
         llvm::APFloat apf(d);
-        return llvm::ConstantFP::get(*context, apf);
+        return llvm::ConstantFP::get(context, apf);
     }
-    if(node->stringValue == "true") return llvm::ConstantInt::getTrue(*context);
-    if(node->stringValue == "false") return llvm::ConstantInt::getFalse(*context);
-    errorHandler.errorReg("Unsupported literal type for: " + node->stringValue, 0);
+    if(node->stringValue == "true") return llvm::ConstantInt::getTrue(context);
+    if(node->stringValue == "false") return llvm::ConstantInt::getFalse(context);
+    diagnostics.errorReg("Unsupported literal type for: " + node->stringValue, 0);
     return nullptr;
 }
 
 llvm::Value* LLVMGen::visit(MIRCastInstruction *node){
     llvm::Value* operand = visit(node->operand.get());
     if(!operand){
-        errorHandler.errorReg("Cast operand not generated", 0);
+        diagnostics.errorReg("Cast operand not generated", 0);
         return nullptr;
     }
 
-    llvm::Type* targetType = TypeTranslate::toLlvmType(node->targetType.get(), *context);
+    llvm::Type* targetType = toLlvmType(node->targetType);
     if(!targetType){
-        errorHandler.errorReg("Failed to translate cast target type", 0);
+        diagnostics.errorReg("Failed to translate cast target type", 0);
         return nullptr;
     }
 
@@ -339,22 +453,24 @@ llvm::Value* LLVMGen::visit(MIRCastInstruction *node){
     }
 
     if(!castVal){
-        errorHandler.errorReg("Unsupported cast from " + std::string(operandType->getTypeID() == llvm::Type::IntegerTyID ? "int" : "other")
+        diagnostics.errorReg("Unsupported cast from " + std::string(operandType->getTypeID() == llvm::Type::IntegerTyID ? "int" : "other")
             + " to target", 0);
         return nullptr;
     }
     if(node->result && node->result.get()){
-        valueMap[node->result.get()] = castVal;
+        setValue(node->result.get(), castVal);
     }
 
     return castVal;
 }
 
 void LLVMGen::visit(MIRCallInstruction *node) {
-    llvm::Function* calleeFunc = module->getFunction(node->calleeName);
+    llvm::Function* calleeFunc = module->getFunction(names.str(node->calleeName));
+    if (!calleeFunc && isRuntimeFunction(names.str(node->calleeName))) {
+        calleeFunc = declareRuntimeFunction(node);
+    }
     if (!calleeFunc) {
-        // TODO: printf/scanfのような外部関数をここで宣言する
-        errorHandler.errorReg("LLVMGen: Function " + node->calleeName + " not found in module.", 0);
+        diagnostics.errorReg("LLVMGen: Function " + names.str(node->calleeName) + " not found in module.", 0);
         return;
     }
 
@@ -363,9 +479,10 @@ void LLVMGen::visit(MIRCallInstruction *node) {
         llvmArgs.push_back(visit(arg.get()));
     }
 
-    llvm::Value* callResult = builder->CreateCall(calleeFunc, llvmArgs, "calltmp");
+    llvm::CallInst* callResult = builder->CreateCall(calleeFunc, llvmArgs, calleeFunc->getReturnType()->isVoidTy() ? "" : "calltmp");
+    callResult->setAttributes(calleeFunc->getAttributes());
 
     if (node->result) {
-        valueMap[node->result.get()] = callResult;
+        setValue(node->result.get(), callResult);
     }
 }
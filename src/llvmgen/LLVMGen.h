@@ -6,27 +6,56 @@
 #include "mir/MIRValue.h"
 #include "mir/MIRType.h"
 #include "mir/MIRTerminator.h"
-#include "semantic/SemanticAnalysis.h"
+#include "mir/MIRVisitor.h"
+#include "driver/CompilerInstance.h"
 #include <llvm/IR/BasicBlock.h>
+#include <llvm/IR/DIBuilder.h>
 #include <llvm/IR/Function.h>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/LLVMContext.h>
 
-class LLVMGen{
+class LLVMGen : public MIRVisitor<LLVMGen>{
+    friend class MIRVisitor<LLVMGen>;
 private:
-    std::unique_ptr<llvm::LLVMContext> context;
+    llvm::LLVMContext& context; // モジュールを作るコンテキスト (持ち主は呼び出し側)
     std::unique_ptr<llvm::Module> module;
     std::unique_ptr<llvm::IRBuilder<>> builder;
-    SemanticAnalysis& semanticAnalysis;
+    ErrorHandler& diagnostics;
+    const StringInterner& names; // MIRの関数名・変数名の文字列
     llvm::Function* currentFunction;
+    // デバッグ情報 (-gのときだけ作る。MIRの命令の位置をDILocationにする)
+    const SourceManager& sources;
+    std::unique_ptr<llvm::DIBuilder> diBuilder;
+    llvm::DIFile* diFile = nullptr;
+    llvm::DISubprogram* currentSubprogram = nullptr;
+    SourceLocation currentFunctionLoc; // 位置のない命令は関数の位置にする
+    // これから作るLLVMの命令の位置をlocにする (デバッグ情報がなければ何もしない)
+    void setDebugLocation(SourceLocation loc);
 public:
-    LLVMGen(SemanticAnalysis& sema);
+    // contextはLLVMGenより長く生かしておくこと (メインのモジュールはCompilerInstanceのものを使う)
+    LLVMGen(CompilerInstance& compiler, llvm::LLVMContext& ctx);
+    // エラーをcompilerのErrorHandlerではなくdiagに登録する (tier-upのように失敗しても表示しないとき)
+    LLVMGen(CompilerInstance& compiler, ErrorHandler& diag, llvm::LLVMContext& ctx);
     llvm::Module* generate(MIRModule *module);
     llvm::Module* getModule();
+    // モジュールの所有権を渡す (これ以降LLVMGenはcontextを参照しないので、contextをThreadSafeModuleに渡してよい)
     std::unique_ptr<llvm::Module> releaseModule();
-    std::map<MIRValue*, llvm::Value*> valueMap;
-    std::map<MIRBasicBlock*, llvm::BasicBlock*> blockMap;
 private:
+    // 今の関数のMIRの値・基本ブロックに対応するLLVMの値 (MIRValue::id・MIRBasicBlock::idが添字。関数ごとに作り直す)
+    std::vector<llvm::Value*> values;
+    std::vector<llvm::BasicBlock*> blocks;
+    void setValue(const MIRValue* node, llvm::Value* value);
+    // MIRの型に対応するLLVMの型 (MIRType::indexが添字。1つのMIRTypeContextの型だけを変換する)
+    std::vector<llvm::Type*> llvmTypes;
+    llvm::Type* toLlvmType(const MIRType* type);
+    // 単項・二項命令のLLVMの命令を作る (オペランドの数・型がオペコードと合わなければエラーにしてnullptr)
+    llvm::Value* lowerOpcode(MIROpcode opcode, llvm::ArrayRef<llvm::Value*> operands);
+
+    // 関数の宣言だけを作る (本体はvisit(MIRFunction*)で作る)
+    llvm::Function* declareFunction(MIRFunction *node);
+    // print/inputが呼ぶランタイム関数の宣言を呼び出し命令の引数・戻り値の型から作る
+    llvm::Function* declareRuntimeFunction(MIRCallInstruction *node);
+
     // 各MIRノードのvisitメソッド
     void visit(MIRFunction *node);
     void visit(MIRBasicBlock *node);
@@ -45,4 +74,6 @@ private:
     llvm::Value* visit(MIRValue *node);
     llvm::Value* visit(MIRLiteralValue *node);
     llvm::Value* visit(MIRCastInstruction *node);
+    // 知らない種類の命令 (MIRVisitorから呼ばれる)
+    void unhandledInstruction(MIRInstruction *node);
 };
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include "LLVMOptimizer.h"
+#include <llvm/Analysis/CGSCCPassManager.h>
+#include <llvm/Analysis/LoopAnalysisManager.h>
+#include <llvm/IR/PassManager.h>
+#include <llvm/Passes/OptimizationLevel.h>
+#include <llvm/Passes/PassBuilder.h>
+
+static llvm::OptimizationLevel toLlvmOptLevel(OptLevel level){
+    switch(level){
+        case OptLevel::O0: return llvm::OptimizationLevel::O0;
+        case OptLevel::O1: return llvm::OptimizationLevel::O1;
+        case OptLevel::O2: return llvm::OptimizationLevel::O2;
+        case OptLevel::O3: return llvm::OptimizationLevel::O3;
+    }
+    return llvm::OptimizationLevel::O0;
+}
+
+// 関数単位のパイプラインと解析マネージャ (メンバの順番はPassBuilderの例と同じで、破棄の順番に意味がある)
+struct LLVMOptimizer::FunctionPipeline{
+    llvm::LoopAnalysisManager lam;
+    llvm::FunctionAnalysisManager fam;
+    llvm::CGSCCAnalysisManager cgam;
+    llvm::ModuleAnalysisManager mam;
+    llvm::PassBuilder passBuilder;
+    llvm::ModulePassManager mpm;
+
+    FunctionPipeline(OptLevel level, llvm::TargetMachine* targetMachine) : passBuilder(targetMachine){
+        passBuilder.registerModuleAnalyses(mam);
+        passBuilder.registerCGSCCAnalyses(cgam);
+        passBuilder.registerFunctionAnalyses(fam);
+        passBuilder.registerLoopAnalyses(lam);
+        passBuilder.crossRegisterProxies(lam, fam, cgam, mam);
+        llvm::FunctionPassManager fpm = passBuilder.buildFunctionSimplificationPipeline(toLlvmOptLevel(level), llvm::ThinOrFullLTOPhase::None);
+        mpm.addPass(llvm::createModuleToFunctionPassAdaptor(std::move(fpm)));
+    }
+};
+
+LLVMOptimizer::LLVMOptimizer(OptLevel optLevel, llvm::TargetMachine* tm) : level(optLevel), targetMachine(tm) {}
+
+LLVMOptimizer::~LLVMOptimizer() = default;
+
+void LLVMOptimizer::optimizeModule(llvm::Module& module){
+    llvm::LoopAnalysisManager lam;
+    llvm::FunctionAnalysisManager fam;
+    llvm::CGSCCAnalysisManager cgam;
+    llvm::ModuleAnalysisManager mam;
+    llvm::PassBuilder passBuilder(targetMachine);
+    passBuilder.registerModuleAnalyses(mam);
+    passBuilder.registerCGSCCAnalyses(cgam);
+    passBuilder.registerFunctionAnalyses(fam);
+    passBuilder.registerLoopAnalyses(lam);
+    passBuilder.crossRegisterProxies(lam, fam, cgam, mam);
+
+    llvm::ModulePassManager mpm;
+    if(level == OptLevel::O0){
+        mpm = passBuilder.buildO0DefaultPipeline(llvm::OptimizationLevel::O0);
+    }else{
+        mpm = passBuilder.buildPerModuleDefaultPipeline(toLlvmOptLevel(level));
+    }
+    mpm.run(module, mam);
+}
+
+void LLVMOptimizer::optimizeFunctions(llvm::Module& module){
+    // O0のときは何もしない (buildFunctionSimplificationPipelineはO0を受け付けない)
+    if(level == OptLevel::O0) return;
+    // パイプラインの構築は重いので最初の一回だけ行う
+    if(!functionPipeline) functionPipeline = std::make_unique<FunctionPipeline>(level, targetMachine);
+    functionPipeline->mpm.run(module, functionPipeline->mam);
+    // 解析結果はこのモジュールの関数を指しているので、次のモジュールに持ち越さないように捨てる
+    functionPipeline->lam.clear();
+    functionPipeline->fam.clear();
+    functionPipeline->cgam.clear();
+    functionPipeline->mam.clear();
+}
+
+bool LLVMOptimizer::parseOptLevel(const std::string& arg, OptLevel& level){
+    if(arg == "-O0") level = OptLevel::O0;
+    else if(arg == "-O1") level = OptLevel::O1;
+    else if(arg == "-O2") level = OptLevel::O2;
+    else if(arg == "-O3") level = OptLevel::O3;
+    else return false;
+    return true;
+}
+
+llvm::CodeGenOptLevel LLVMOptimizer::toCodeGenOptLevel(OptLevel level){
+    switch(level){
+        case OptLevel::O0: return llvm::CodeGenOptLevel::None;
+        case OptLevel::O1: return llvm::CodeGenOptLevel::Less;
+        case OptLevel::O2: return llvm::CodeGenOptLevel::Default;
+        case OptLevel::O3: return llvm::CodeGenOptLevel::Aggressive;
+    }
+    return llvm::CodeGenOptLevel::Default;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <llvm/IR/Module.h>
+#include <llvm/Support/CodeGen.h>
+#include <llvm/Target/TargetMachine.h>
+#include <memory>
+#include <string>
+
+// 最適化レベル (-O0 ~ -O3)
+enum class OptLevel{
+    O0,
+    O1,
+    O2,
+    O3
+};
+
+// LLVMの新パスマネージャ(PassBuilder)のデフォルトパイプラインを実行するクラス
+class LLVMOptimizer{
+private:
+    OptLevel level;
+    llvm::TargetMachine* targetMachine; // nullptrのときはターゲット非依存の情報だけで最適化する
+    // optimizeFunctionsで使うパイプライン (最初の呼び出しで作って使い回す)
+    struct FunctionPipeline;
+    std::unique_ptr<FunctionPipeline> functionPipeline;
+public:
+    explicit LLVMOptimizer(OptLevel optLevel, llvm::TargetMachine* tm = nullptr);
+    ~LLVMOptimizer();
+    // モジュール全体のデフォルトパイプライン(AOT用)
+    // インライン展開などモジュールをまたぐ最適化も行う
+    void optimizeModule(llvm::Module& module);
+    // 関数単位のパイプライン(JIT用)
+    // モジュール内の定義済み関数それぞれに関数簡約化パイプラインをかける
+    // パイプラインを使い回すので、同じLLVMOptimizerを複数のスレッドから同時に呼んではいけない
+    void optimizeFunctions(llvm::Module& module);
+    OptLevel getLevel() const {return level;}
+    // "-O0" ~ "-O3" を解析する。最適化オプションでなければfalse
+    static bool parseOptLevel(const std::string& arg, OptLevel& level);
+    // バックエンド(命令選択・レジスタ割り当て)の最適化レベル
+    static llvm::CodeGenOptLevel toCodeGenOptLevel(OptLevel level);
+};
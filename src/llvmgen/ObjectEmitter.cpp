@@ -0,0 +1,132 @@
+#include "ObjectEmitter.h"
+#include <iostream>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/MC/TargetRegistry.h>
+#include <llvm/Support/CodeGen.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Program.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/TargetParser/Host.h>
+#include <llvm/TargetParser/SubtargetFeature.h>
+#include <optional>
+
+bool ObjectEmitter::init(){
+    std::string triple = llvm::sys::getDefaultTargetTriple();
+    std::string error;
+    const llvm::Target* target = llvm::TargetRegistry::lookupTarget(triple, error);
+    if(!target){
+        std::cerr << "Failed to lookup target '" << triple << "': " << error << "\n";
+        return false;
+    }
+    // デプロイ先のマシンでコンパイルする前提なので、ホストのCPUと拡張命令を使う
+    llvm::SubtargetFeatures features;
+    llvm::StringMap<bool> hostFeatures;
+    if(llvm::sys::getHostCPUFeatures(hostFeatures)){
+        for(const auto& feature : hostFeatures){
+            features.AddFeature(feature.first(), feature.second);
+        }
+    }
+    llvm::TargetOptions options;
+    targetMachine.reset(target->createTargetMachine(
+        triple, llvm::sys::getHostCPUName(), features.getString(), options,
+        llvm::Reloc::PIC_, std::nullopt, LLVMOptimizer::toCodeGenOptLevel(optLevel)
+    ));
+    if(!targetMachine){
+        std::cerr << "Failed to create TargetMachine for '" << triple << "'.\n";
+        return false;
+    }
+    return true;
+}
+
+bool ObjectEmitter::emit(llvm::Module& module, EmitKind kind, const std::string& outputPath){
+    if(!targetMachine && !init()) return false;
+    module.setTargetTriple(targetMachine->getTargetTriple().str());
+    module.setDataLayout(targetMachine->createDataLayout());
+    // AOTではモジュール全体のパイプラインをかける
+    LLVMOptimizer optimizer(optLevel, targetMachine.get());
+    optimizer.optimizeModule(module);
+
+    switch(kind){
+        case EmitKind::Object:
+            return writeFile(module, outputPath, false);
+        case EmitKind::Assembly:
+            return writeFile(module, outputPath, true);
+        case EmitKind::Executable: {
+            // 一時ファイルにオブジェクトを書き出してからリンクする
+            llvm::SmallString<128> objectPath;
+            if(auto ec = llvm::sys::fs::createTemporaryFile("luma", "o", objectPath)){
+                std::cerr << "Could not create temporary file: " << ec.message() << "\n";
+                return false;
+            }
+            bool ok = writeFile(module, objectPath.str().str(), false) && link(objectPath.str().str(), outputPath);
+            llvm::sys::fs::remove(objectPath);
+            return ok;
+        }
+        case EmitKind::None:
+            break;
+    }
+    return false;
+}
+
+bool ObjectEmitter::writeFile(llvm::Module& module, const std::string& path, bool assembly){
+    std::error_code ec;
+    llvm::raw_fd_ostream dest(path, ec, llvm::sys::fs::OF_None);
+    if(ec){
+        std::cerr << "Could not open file: " << path << " (" << ec.message() << ")\n";
+        return false;
+    }
+    llvm::legacy::PassManager passManager;
+    auto fileType = assembly ? llvm::CodeGenFileType::AssemblyFile : llvm::CodeGenFileType::ObjectFile;
+    if(targetMachine->addPassesToEmitFile(passManager, dest, nullptr, fileType)){
+        std::cerr << "TargetMachine can't emit a file of this type.\n";
+        return false;
+    }
+    passManager.run(module);
+    dest.flush();
+    return true;
+}
+
+bool ObjectEmitter::link(const std::string& objectPath, const std::string& outputPath){
+    // Lumaのmainがそのままエントリポイントになるので、Cのランタイム(crt, libc)と
+    // print/inputを実装したLumaのランタイム(ビルド時に作ったライブラリ)をリンクする
+    if(!llvm::sys::fs::exists(LUMA_RUNTIME_LIBRARY)){
+        std::cerr << "Could not find the Luma runtime library: " << LUMA_RUNTIME_LIBRARY << "\n";
+        return false;
+    }
+    auto linker = llvm::sys::findProgramByName("cc");
+    if(!linker){
+        std::cerr << "Could not find a system linker driver (cc): " << linker.getError().message() << "\n";
+        return false;
+    }
+    std::vector<llvm::StringRef> args = {*linker, objectPath, LUMA_RUNTIME_LIBRARY, "-o", outputPath};
+    std::string errorMsg;
+    int result = llvm::sys::ExecuteAndWait(*linker, args, std::nullopt, {}, 0, 0, &errorMsg);
+    if(result != 0){
+        std::cerr << "Link failed: " << (errorMsg.empty() ? "cc returned " + std::to_string(result) : errorMsg) << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool ObjectEmitter::parseEmitKind(const std::string& value, EmitKind& kind){
+    if(value == "obj") kind = EmitKind::Object;
+    else if(value == "asm") kind = EmitKind::Assembly;
+    else if(value == "exe") kind = EmitKind::Executable;
+    else return false;
+    return true;
+}
+
+std::string ObjectEmitter::defaultOutputPath(const std::string& sourceFile, EmitKind kind){
+    llvm::SmallString<128> path(llvm::sys::path::filename(sourceFile));
+    switch(kind){
+        case EmitKind::Object: llvm::sys::path::replace_extension(path, "o"); break;
+        case EmitKind::Assembly: llvm::sys::path::replace_extension(path, "s"); break;
+        case EmitKind::Executable: llvm::sys::path::replace_extension(path, ""); break;
+        case EmitKind::None: break;
+    }
+    // 拡張子のないソースから実行ファイルを作るときにソースを上書きしないようにする
+    if(path == llvm::sys::path::filename(sourceFile)) return "a.out";
+    return path.str().str();
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "llvmgen/LLVMOptimizer.h"
+#include <llvm/IR/Module.h>
+#include <llvm/Target/TargetMachine.h>
+#include <memory>
+#include <string>
+
+// AOTコンパイルの出力形式 (-emit=obj|asm|exe)
+enum class EmitKind{
+    None,       // 出力しない (JITで実行)
+    Object,     // オブジェクトファイル (.o)
+    Assembly,   // アセンブリ (.s)
+    Executable  // 実行ファイル
+};
+
+// TargetMachineを使ってモジュールをネイティブコードとして書き出すクラス
+class ObjectEmitter{
+private:
+    OptLevel optLevel;
+    std::unique_ptr<llvm::TargetMachine> targetMachine;
+    bool writeFile(llvm::Module& module, const std::string& path, bool assembly);
+    bool link(const std::string& objectPath, const std::string& outputPath);
+public:
+    explicit ObjectEmitter(OptLevel level) : optLevel(level) {}
+    // ホスト向けのTargetMachineを作る。失敗したらfalse
+    bool init();
+    // モジュールを最適化してkindの形式でoutputPathに書き出す
+    bool emit(llvm::Module& module, EmitKind kind, const std::string& outputPath);
+    // "obj", "asm", "exe" を解析する
+    static bool parseEmitKind(const std::string& value, EmitKind& kind);
+    // ソースファイル名から出力ファイル名を決める (例: foo.luma -> foo.o)
+    static std::string defaultOutputPath(const std::string& sourceFile, EmitKind kind);
+};
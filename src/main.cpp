@@ -1,7 +1,7 @@
 #include <iostream>
-#include <fstream>
 #include <memory>
 #include <any>
+#include <string_view>
 
 // ANTLR
 #include "antlr4-runtime.h"
@@ -13,20 +13,38 @@
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/IR/Function.h"
-#include "llvm/ExecutionEngine/Orc/LLJIT.h"
 #include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 
 // Local
 #include "common/ErrorDef.h"
 #include "common/ErrorHandler.h"
 #include "parser/AstBuilder.h"
+#include "ast/AstContext.h"
 #include "ast/Statement.h"
+#include "ast/AstSerializer.h"
 #include "semantic/SemanticAnalysis.h"
 #include "common/Global.h"
+#include "driver/AstCache.h"
+#include "driver/CompilerInstance.h"
+#include "common/PhaseTimer.h"
 #include "llvmgen/LLVMGen.h"
+#include "llvmgen/LLVMOptimizer.h"
+#include "llvmgen/ObjectEmitter.h"
+#include "jit/JITObjectCache.h"
+#include "jit/LumaJIT.h"
+#include "jit/TierUpCompiler.h"
+#include "interp/MIRInterpreter.h"
+#include "lexer/FastLexer.h"
+#include "lexer/FastTokenSource.h"
+#include "parser/RDParser.h"
+#include "parser/ParserBench.h"
+#include "parser/ParserDriver.h"
+#include "semantic/SemaBench.h"
+#include "llvmgen/CodegenBench.h"
 
 // MIRGen
 #include "mirgen/MIRGen.h" // MIRGen のヘッダをインクルード
@@ -38,6 +56,33 @@ int main(int argc, char* argv[]){
     Language lang = Language::EN;
     bool debug_ast_print = false; // ASTダンプフラグ (ユーザーの変数名に合わせる)
     bool dbg_mir_print = false; // MIRダンプフラグ (新規追加)
+    bool dbg_llvm_print = false; // LLVM IRダンプフラグ
+    bool time_report = false; // フェーズごとの実行時間を表示する
+    OptLevel optLevel = OptLevel::O0; // 最適化レベル
+    EmitKind emitKind = EmitKind::None; // AOTコンパイルの出力形式 (Noneの場合はJITで実行)
+    std::string outputFile;
+    bool jit_cache = false; // JITのオブジェクトキャッシュを使う
+    bool jit_cache_stats = false; // キャッシュの統計を表示する
+    std::string jitCacheDir; // 空ならデフォルトのディレクトリ
+    uint64_t jitCacheSizeMB = 256; // キャッシュの上限サイズ
+    bool jit_lazy = false; // 関数を最初に呼ばれたときにコンパイルする
+    unsigned jitThreads = 0; // 並列コンパイルのスレッド数 (0なら並列化しない)
+    bool tiered = false; // MIRインタプリタで実行し、熱い関数だけJITコンパイルする
+    uint64_t tierThreshold = 1000; // tier-upする呼び出し回数+後方分岐回数 (0ならインタプリタのみ)
+    bool fast_lexer = false; // ANTLRのLumaLexerの代わりにFastLexerを使う
+    bool dbg_lex_check = false; // FastLexerとLumaLexerの結果を比べる
+    bool rd_parser = false; // ANTLRのパーサーの代わりにRDParserでASTを作る
+    bool dbg_parse_check = false; // RDParserとANTLRのASTを比べる
+    bool profile_parser = false; // ANTLRのパーサーの決定ごとの先読みのコストを表示する
+    unsigned benchParserIterations = 0; // パーサーのベンチマークの繰り返し回数 (0なら実行しない)
+    unsigned benchSemaIterations = 0; // セマンティック解析のベンチマークの繰り返し回数 (0なら実行しない)
+    unsigned benchCodegenIterations = 0; // MIR生成・LLVM IR生成のベンチマークの繰り返し回数 (0なら実行しない)
+    unsigned semaThreads = 0; // 関数本体を並列に解析するスレッド数 (0なら並列化しない)
+    size_t errorLimit = ErrorHandler::DefaultLimit; // 記録するエラー・警告の数の上限 (0なら無制限)
+    bool debug_info = false; // LLVM IRにデバッグ情報(行と列)を付ける
+    bool ast_cache = false; // セマンティック解析まで終わったASTをキャッシュする
+    std::string astCacheDir; // 空ならデフォルトのディレクトリ
+    unsigned benchAstLoadIterations = 0; // ASTの読み込みのベンチマークの繰り返し回数 (0なら実行しない)
 
     for(int i = 1; i < argc; i++){
         std::string arg = argv[i];
@@ -45,6 +90,115 @@ int main(int argc, char* argv[]){
         else if(arg == "-en") lang = Language::EN;
         else if(arg == "-dbg-ast-print") debug_ast_print = true; // フラグをセット
         else if(arg == "-dbg-mir-print") dbg_mir_print = true; // フラグをセット (新規追加)
+        else if(arg == "-dbg-llvm-print") dbg_llvm_print = true;
+        else if(arg == "-time") time_report = true;
+        else if(arg == "-g") debug_info = true;
+        else if(LLVMOptimizer::parseOptLevel(arg, optLevel)) continue;
+        else if(arg.rfind("-emit=", 0) == 0 || arg.rfind("--emit=", 0) == 0){
+            if(!ObjectEmitter::parseEmitKind(arg.substr(arg.find('=') + 1), emitKind)){
+                std::cerr << "Unknown emit kind: " << arg << " (obj|asm|exe)\n";
+                return 1;
+            }
+        }
+        else if(arg == "-o"){
+            if(i + 1 >= argc){
+                std::cerr << "Missing file name after -o\n";
+                return 1;
+            }
+            outputFile = argv[++i];
+        }
+        else if(arg == "-jit-lazy") jit_lazy = true;
+        else if(arg.rfind("-jit-threads=", 0) == 0){
+            try{
+                jitThreads = std::stoul(arg.substr(arg.find('=') + 1));
+            }catch(const std::exception&){
+                std::cerr << "Invalid thread count: " << arg << "\n";
+                return 1;
+            }
+        }
+        else if(arg == "-fast-lexer") fast_lexer = true;
+        else if(arg == "-dbg-lex-check") fast_lexer = dbg_lex_check = true;
+        else if(arg == "-rd-parser") fast_lexer = rd_parser = true;
+        else if(arg == "-dbg-parse-check") fast_lexer = rd_parser = dbg_parse_check = true;
+        else if(arg == "-profile-parser" || arg == "--profile-parser") profile_parser = true;
+        else if(arg.rfind("-bench-parser=", 0) == 0){
+            try{
+                benchParserIterations = std::stoul(arg.substr(arg.find('=') + 1));
+            }catch(const std::exception&){
+                std::cerr << "Invalid iteration count: " << arg << "\n";
+                return 1;
+            }
+        }
+        else if(arg.rfind("-sema-threads=", 0) == 0){
+            try{
+                semaThreads = std::stoul(arg.substr(arg.find('=') + 1));
+            }catch(const std::exception&){
+                std::cerr << "Invalid thread count: " << arg << "\n";
+                return 1;
+            }
+        }
+        else if(arg.rfind("-error-limit=", 0) == 0){
+            try{
+                errorLimit = std::stoull(arg.substr(arg.find('=') + 1));
+            }catch(const std::exception&){
+                std::cerr << "Invalid error limit: " << arg << "\n";
+                return 1;
+            }
+        }
+        else if(arg.rfind("-bench-ast-load=", 0) == 0){
+            try{
+                benchAstLoadIterations = std::stoul(arg.substr(arg.find('=') + 1));
+            }catch(const std::exception&){
+                std::cerr << "Invalid iteration count: " << arg << "\n";
+                return 1;
+            }
+        }
+        else if(arg == "-ast-cache") ast_cache = true;
+        else if(arg.rfind("-ast-cache-dir=", 0) == 0){
+            ast_cache = true;
+            astCacheDir = arg.substr(arg.find('=') + 1);
+        }
+        else if(arg.rfind("-bench-sema=", 0) == 0){
+            try{
+                benchSemaIterations = std::stoul(arg.substr(arg.find('=') + 1));
+            }catch(const std::exception&){
+                std::cerr << "Invalid iteration count: " << arg << "\n";
+                return 1;
+            }
+        }
+        else if(arg.rfind("-bench-codegen=", 0) == 0){
+            try{
+                benchCodegenIterations = std::stoul(arg.substr(arg.find('=') + 1));
+            }catch(const std::exception&){
+                std::cerr << "Invalid iteration count: " << arg << "\n";
+                return 1;
+            }
+        }
+        else if(arg == "-tiered") tiered = true;
+        else if(arg.rfind("-tier-threshold=", 0) == 0){
+            tiered = true;
+            try{
+                tierThreshold = std::stoull(arg.substr(arg.find('=') + 1));
+            }catch(const std::exception&){
+                std::cerr << "Invalid tier threshold: " << arg << "\n";
+                return 1;
+            }
+        }
+        else if(arg == "-jit-cache") jit_cache = true;
+        else if(arg == "-jit-cache-stats") jit_cache = jit_cache_stats = true;
+        else if(arg.rfind("-jit-cache-dir=", 0) == 0){
+            jit_cache = true;
+            jitCacheDir = arg.substr(arg.find('=') + 1);
+        }
+        else if(arg.rfind("-jit-cache-size=", 0) == 0){
+            jit_cache = true;
+            try{
+                jitCacheSizeMB = std::stoull(arg.substr(arg.find('=') + 1));
+            }catch(const std::exception&){
+                std::cerr << "Invalid cache size: " << arg << " (MB)\n";
+                return 1;
+            }
+        }
         else if(arg == "-debug-ast-print") std::cerr << "Correct: -dbg-ast-print" << "\n";
         else if(arg == "-debug-mir-print") std::cerr << "Correct: -dbg-mir-print" << "\n";
         else if(sourceFile.empty()) sourceFile = arg;
@@ -55,71 +209,241 @@ int main(int argc, char* argv[]){
     }
 
     if(sourceFile.empty()){
-        std::cerr << "Usage: ./Luma [-ja|-en] [-dbg-ast-print] [-dbg-mir-print] <source_file>\n"; // Usageメッセージ更新
+        std::cerr << "Usage: ./Luma [-ja|-en] [-dbg-ast-print] [-dbg-mir-print] [-dbg-llvm-print] [-fast-lexer] [-dbg-lex-check] [-rd-parser] [-dbg-parse-check] [-bench-parser=<N>] [-bench-sema=<N>] [-bench-codegen=<N>] [-bench-ast-load=<N>] [-ast-cache] [-ast-cache-dir=<dir>] [-sema-threads=<N>] [-error-limit=<N>] [-profile-parser] [-O0|-O1|-O2|-O3] [-g] [-time] [-emit=obj|asm|exe] [-o <output>] [-jit-lazy] [-jit-threads=<N>] [-tiered] [-tier-threshold=<N>] [-jit-cache] [-jit-cache-dir=<dir>] [-jit-cache-size=<MB>] [-jit-cache-stats] <source_file>\n"; // Usageメッセージ更新
         return 1;
     }
 
-    errorHandler.setLang(lang);
-    std::ifstream file(sourceFile);
-    if(!file){
+    // lazyモードでは関数ごとに別々にコンパイルされ、モジュール全体のオブジェクトができないのでキャッシュは使えない
+    if(jit_lazy && jit_cache){
+        std::cerr << "-jit-cache is ignored with -jit-lazy.\n";
+        jit_cache = jit_cache_stats = false;
+    }
+    // 並列コンパイルでもモジュールが分割されるので同様
+    if(jitThreads > 0 && jit_cache){
+        std::cerr << "-jit-cache is ignored with -jit-threads.\n";
+        jit_cache = jit_cache_stats = false;
+    }
+
+    // プロファイルはANTLRのパーサーのもの
+    if(profile_parser && rd_parser){
+        std::cerr << "-profile-parser is ignored with -rd-parser.\n";
+        profile_parser = false;
+    }
+
+    // tieredモードではモジュール全体のオブジェクトを作らないのでキャッシュは使わない
+    if(tiered && emitKind == EmitKind::None && jit_cache){
+        std::cerr << "-jit-cache is ignored with -tiered.\n";
+        jit_cache = jit_cache_stats = false;
+    }
+
+    PhaseTimer timer(time_report);
+    // ソースはmmapで読み込み、コピーせずに字句解析器に渡す (小さいファイルは普通に読み込まれる)
+    // キャッシュキーの計算にも使うので、ソースは先に全部読み込む
+    auto sourceBuffer = llvm::MemoryBuffer::getFile(sourceFile, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+    if(!sourceBuffer){
         std::cerr << "Could not open file: " << sourceFile << "\n";
         return 1;
     }
-    
-    ANTLRInputStream inputStream(file);
-    Luma::LumaLexer lexer(&inputStream);
-    CommonTokenStream tokens(&lexer);
-    Luma::LumaParser parser(&tokens);
-    
-    tree::ParseTree* tree = parser.program();
-    
-    AstBuilder astBuilder;
-    std::shared_ptr<ProgramNode> programNode;
-
-    try {
-        auto anyNode = tree->accept(&astBuilder);
-        if (anyNode.has_value()) {
-            programNode = std::any_cast<std::shared_ptr<ProgramNode>>(anyNode);
-        }
-    } catch (const std::bad_any_cast& e) {
-        std::cerr << "AST construction failed: " << e.what() << std::endl;
-        return 1;
+    std::string_view source((*sourceBuffer)->getBufferStart(), (*sourceBuffer)->getBufferSize());
+    timer.mark("read");
+
+    // JITのオブジェクトキャッシュ (AOTのときは使わない)
+    std::unique_ptr<JITObjectCache> objectCache;
+    std::string cacheKey;
+    if(jit_cache && emitKind == EmitKind::None){
+        objectCache = std::make_unique<JITObjectCache>(jitCacheDir, jitCacheSizeMB * 1024 * 1024);
+        cacheKey = JITObjectCache::computeKey(source, optLevel, debug_info, argv[0]);
+        if(auto cached = objectCache->lookup(cacheKey)){
+            // キャッシュに当たったらフロントエンドもLLVMGenも飛ばしてそのまま実行する
+            timer.mark("cache lookup");
+            llvm::InitializeNativeTarget();
+            llvm::InitializeNativeTargetAsmPrinter();
+            auto jit = LumaJIT::create({optLevel, nullptr});
+            if(!jit){
+                std::cerr << "Failed to create JIT: " << toString(jit.takeError()) << "\n";
+                return 1;
+            }
+            if(auto err = (*jit)->addObject(std::move(cached))){
+                std::cerr << "Failed to add cached object: " << toString(std::move(err)) << "\n";
+                return 1;
+            }
+            auto mainFunc = (*jit)->lookupMain();
+            if(!mainFunc){
+                std::cerr << "Could not find main function: " << toString(mainFunc.takeError()) << "\n";
+                return 1;
+            }
+            timer.mark("jit load");
+            (*mainFunc)();
+            timer.mark("execute");
+            if(jit_cache_stats) objectCache->printStats(std::cerr);
+            timer.print(std::cerr);
+            return 0;
+        }
+        timer.mark("cache lookup");
+    }
+
+    // パーサーのベンチマークだけを行う
+    if(benchParserIterations > 0){
+        auto path = rd_parser ? ParserBench::Path::RD : (fast_lexer ? ParserBench::Path::AntlrFastLexer : ParserBench::Path::Antlr);
+        return ParserBench::run(source, path, benchParserIterations, std::cerr) ? 0 : 1;
     }
-    
+    // ソースから解析する場合とASTのキャッシュから読み込む場合を比べるだけを行う
+    if(benchAstLoadIterations > 0){
+        auto path = rd_parser ? ParserBench::Path::RD : (fast_lexer ? ParserBench::Path::AntlrFastLexer : ParserBench::Path::Antlr);
+        return ParserBench::runAstLoad(source, path, benchAstLoadIterations, std::cerr) ? 0 : 1;
+    }
+
+    // コンパイル1回分の状態 (エラー・文字列表・型・AST・シンボル表・LLVMのコンテキスト)
+    // ASTのノードはすべてここに確保されるので、コンパイルが終わるまで生かしておく
+    CompilerInstance compiler(lang);
+    ErrorHandler& diagnostics = compiler.getDiagnostics();
+    diagnostics.setLimit(errorLimit);
+    // エラーの位置・デバッグ情報の行と列はソースから計算する (ソースはmmapした領域のまま)
+    compiler.getSourceManager().setSource(sourceFile, source);
+    compiler.setDebugInfo(debug_info);
+    ProgramNode* programNode = nullptr;
+
+    // セマンティック解析まで終わったASTのキャッシュ (当たったら字句解析・構文解析・セマンティック解析を飛ばす)
+    std::unique_ptr<AstCache> astCache;
+    std::string astCacheKey;
+    bool astFromCache = false;
+    if(ast_cache){
+        astCache = std::make_unique<AstCache>(astCacheDir);
+        astCacheKey = AstCache::computeKey(source, argv[0]);
+        if(auto cached = astCache->lookup(astCacheKey)){
+            programNode = AstSerializer::deserialize(std::string_view(cached->getBufferStart(), cached->getBufferSize()), compiler);
+            astFromCache = programNode != nullptr;
+        }
+        timer.mark(astFromCache ? "ast cache load" : "ast cache lookup");
+    }
+
+    if(!astFromCache){
+        // 字句解析器の選択 (ANTLRのLumaLexerはパーサーに読まれながら字句解析する)
+        std::vector<LexToken> fastTokens;
+        std::unique_ptr<ANTLRInputStream> inputStream;
+        std::unique_ptr<TokenSource> tokenSource;
+        if(fast_lexer){
+            FastLexer fastLexer(source);
+            fastTokens = fastLexer.tokenize();
+            timer.mark("lex");
+            if(dbg_lex_check && !FastTokenSource::crossCheck(source, fastTokens, std::cerr)) return 1;
+            if(!rd_parser) tokenSource = std::make_unique<FastTokenSource>(source, fastTokens, sourceFile);
+        }else{
+            inputStream = std::make_unique<ANTLRInputStream>(source);
+            tokenSource = std::make_unique<Luma::LumaLexer>(inputStream.get());
+        }
+
+        if(rd_parser){
+            // パースツリーを作らずに、トークン列から直接ASTを作る
+            RDParser rdParser(source, fastTokens, compiler);
+            programNode = rdParser.parseProgram();
+            timer.mark("parse");
+            if(rdParser.getErrorCount() > 0){
+                diagnostics.printAllErrors();
+                return 1;
+            }
+            if(dbg_parse_check && !ParserBench::crossCheck(source, *programNode, compiler, std::cerr)) return 1;
+        }else{
+            CommonTokenStream tokens(tokenSource.get());
+            Luma::LumaParser parser(&tokens);
+        
+            tree::ParseTree* tree = nullptr;
+            if(profile_parser){
+                tree = ParserDriver::parseProgramWithProfile(parser, std::cerr);
+                timer.mark("parse (profile)");
+            }else{
+                bool usedFallback = false;
+                tree = ParserDriver::parseProgram(parser, tokens, usedFallback);
+                timer.mark(usedFallback ? "parse (SLL+LL)" : "parse (SLL)");
+            }
+        
+            AstBuilder astBuilder(compiler);
+
+            try {
+                auto anyNode = tree->accept(&astBuilder);
+                if (anyNode.has_value()) {
+                    programNode = std::any_cast<ProgramNode*>(anyNode);
+                }
+            } catch (const std::bad_any_cast& e) {
+                std::cerr << "AST construction failed: " << e.what() << std::endl;
+                return 1;
+            }
+            timer.mark("ast build");
+        }
+        // ASTは位置をSourceLocationで持っているので、トークン列はもう使わない
+        // (パースツリーはparserと一緒に上のブロックで解放されている。トークン列もここで解放する)
+    }
+
     if (programNode) {
         // ASTのダンプ (フラグが立っている場合のみ)
         if(debug_ast_print){
             std::cout << "--- AST Dump (Before Semantic Analysis) ---" << std::endl;
-            programNode->dump();
+            programNode->dump(compiler.getNameTable());
             std::cout << "-------------------------------------------\n" << std::endl;
         }
 
-        // セマンティック解析
-        SemanticAnalysis semanticAnalysis;
-        semanticAnalysis.analyze(programNode);
-        if (semanticAnalysis.hasErrors()) {
-            errorHandler.printAllErrors();
-            return 1;
+        // セマンティック解析 (キャッシュから読み込んだASTは型とシンボルが付いているので飛ばす)
+        SemanticAnalysis& semanticAnalysis = compiler.getSemanticAnalysis();
+        if(!astFromCache){
+            semanticAnalysis.setThreads(semaThreads);
+            semanticAnalysis.analyze(programNode);
+            timer.mark("semantic analysis");
+            if (semanticAnalysis.hasErrors()) {
+                diagnostics.printAllErrors();
+                return 1;
+            }
+            // 警告も出ない場合だけ保存する (キャッシュから読んだときは警告を表示できないため)
+            if(astCache && diagnostics.size() == 0 && diagnostics.getSuppressedCount() == 0){
+                astCache->store(astCacheKey, AstSerializer::serialize(*programNode, compiler.getNameTable()));
+                timer.mark("ast cache store");
+            }
+        }
+        // セマンティック解析のベンチマークだけを行う
+        if(benchSemaIterations > 0){
+            return SemaBench::run(compiler, programNode, benchSemaIterations, semaThreads, std::cerr) ? 0 : 1;
+        }
+        // MIR生成・LLVM IR生成のベンチマークだけを行う
+        if(benchCodegenIterations > 0){
+            return CodegenBench::run(compiler, programNode, benchCodegenIterations, std::cerr) ? 0 : 1;
         }
 
         // ASTのダンプ(セマンティック解析後)
         if(debug_ast_print){
             std::cout << "--- AST Dump (After Semantic Analysis) ---" << std::endl;
-            programNode->dump();
+            programNode->dump(compiler.getNameTable());
             std::cout << "------------------------------------------\n" << std::endl;
         }
 
         // MIR生成 (新規追加)
-        MIRGen mirGen(semanticAnalysis); // MIRGen のインスタンス化
+        MIRGen mirGen(compiler); // MIRGen のインスタンス化
         std::unique_ptr<MIRModule> mirModule = mirGen.generate(programNode); // MIRを生成
+        timer.mark("mir gen");
 
         // MIRのダンプ (フラグが立っている場合のみ) (新規追加)
         if (dbg_mir_print && mirModule) {
             std::cout << "--- MIR Dump ---" << std::endl;
-            mirModule->dump(std::cout);
+            mirModule->dump(std::cout, compiler.getNameTable());
             std::cout << "----------------" << std::endl;
         }
 
+        // tieredモード: LLVMを使わずにMIRをそのまま実行し始め、熱い関数だけバックグラウンドでJITコンパイルする
+        if(tiered && emitKind == EmitKind::None && mirModule){
+            TierUpCompiler tierUp(*mirModule, compiler, optLevel);
+            MIRInterpreter interpreter(*mirModule, compiler.getNameTable(), &tierUp, tierThreshold);
+            int64_t exitValue = 0;
+            bool ok = interpreter.runMain(exitValue);
+            timer.mark("interpret");
+            if(!ok){
+                std::cerr << "Runtime error: " << interpreter.getError() << "\n";
+                diagnostics.printAllErrors();
+                return 1;
+            }
+            if(time_report) interpreter.printStats(std::cerr);
+            timer.print(std::cerr);
+            diagnostics.printAllErrors();
+            return 0;
+        }
+
         // コード生成 (CodeGen)
         // CodeGenはまだASTから直接LLVM IRを生成しているので、
         // ここではMIRは使わずにASTを渡す。
@@ -129,43 +453,71 @@ int main(int argc, char* argv[]){
         
         // auto context = std::make_unique<llvm::LLVMContext>();
         // std::unique_ptr<llvm::Module> module = codeGen.releaseModule();
-        LLVMGen llvmGen(semanticAnalysis);
+        LLVMGen llvmGen(compiler, compiler.getLLVMContext());
         llvmGen.generate(mirModule.get());
-        auto context = std::make_unique<llvm::LLVMContext>();
         std::unique_ptr<llvm::Module> module = llvmGen.releaseModule();
+        timer.mark("llvm gen");
 
-        llvm::errs() << "--- LLVM IR Dump (Before Verification) ---\n";
-        module->print(llvm::errs(), nullptr);
-        llvm::errs() << "------------------------------------------\n";
-        errorHandler.printAllErrors();
+        // LLVM IRのダンプ (フラグが立っている場合のみ。-timeの計測に含まれないように毎回は出さない)
+        if(dbg_llvm_print){
+            llvm::errs() << "--- LLVM IR Dump (Before Verification) ---\n";
+            module->print(llvm::errs(), nullptr);
+            llvm::errs() << "------------------------------------------\n";
+        }
+        diagnostics.printAllErrors();
 
         if (llvm::verifyModule(*module, &llvm::errs())) {
             std::cerr << "LLVM Module Verification Failed!\n";
             return 1;
         }
+        timer.mark("verify");
 
         llvm::InitializeNativeTarget();
         llvm::InitializeNativeTargetAsmPrinter();
 
-        auto jit = llvm::orc::LLJITBuilder().create();
+        // AOTコンパイル (-emit=) の場合はファイルに書き出して終了する
+        if(emitKind != EmitKind::None){
+            if(outputFile.empty()) outputFile = ObjectEmitter::defaultOutputPath(sourceFile, emitKind);
+            ObjectEmitter emitter(optLevel);
+            if(!emitter.emit(*module, emitKind, outputFile)) return 1;
+            timer.mark("emit");
+            timer.print(std::cerr);
+            return 0;
+        }
+
+        // キャッシュに保存するときはモジュールIDをキーにする
+        if(objectCache) module->setModuleIdentifier(cacheKey);
+
+        auto jit = LumaJIT::create({optLevel, objectCache.get(), jit_lazy, jitThreads});
         if(!jit){
-            std::cerr << "Failed to create LLJIT instance: " << toString(jit.takeError()) << "\n";
+            std::cerr << "Failed to create JIT: " << toString(jit.takeError()) << "\n";
             return 1;
         }
 
-        auto threadSafeModule = llvm::orc::ThreadSafeModule(std::move(module), std::move(context));
-        
-        auto err = (*jit)->addIRModule(std::move(threadSafeModule));
-        if(err){
-            std::cerr << "Failed to add IR module: " << toString(std::move(err)) << "\n";
-            return 1;
+        if(jitThreads > 0 && !jit_lazy){
+            // スレッドごとに仕事が偏らないように、スレッド数より細かく分割する
+            auto err = (*jit)->addSplitModule(std::move(module), jitThreads * 4);
+            if(!err) err = (*jit)->compileAll();
+            if(err){
+                std::cerr << "Failed to compile IR module: " << toString(std::move(err)) << "\n";
+                return 1;
+            }
+        }else{
+            auto threadSafeModule = llvm::orc::ThreadSafeModule(std::move(module), compiler.releaseLLVMContext());
+            
+            auto err = (*jit)->addModule(std::move(threadSafeModule));
+            if(err){
+                std::cerr << "Failed to add IR module: " << toString(std::move(err)) << "\n";
+                return 1;
+            }
         }
 
-        auto mainFuncSym = (*jit)->lookup("main");
+        auto mainFuncSym = (*jit)->lookupMain();
         if(!mainFuncSym){
             std::cerr << "Could not find main function: " << toString(mainFuncSym.takeError()) << "\n";
             return 1;
         }
+        timer.mark("jit compile");
         
         // IRをファイルに出力
         std::error_code EC;
@@ -180,13 +532,16 @@ int main(int argc, char* argv[]){
         // (*jit)->getExecutionSession().getIRModule(mainFuncSym->getJITDylib()).getModule()->print(dest, nullptr);
 
 
-        auto* mainFunc = mainFuncSym->toPtr<int()>();
+        auto* mainFunc = *mainFuncSym;
         if(!mainFunc) { return 1; }
         mainFunc();
+        timer.mark("execute");
+        if(jit_cache_stats) objectCache->printStats(std::cerr);
+        timer.print(std::cerr);
         
-        errorHandler.errorReg("Semantic Analysis Finished!", 2);
-        errorHandler.errorReg("Compile Finished!", 2);
-        errorHandler.printAllErrors();
+        diagnostics.errorReg("Semantic Analysis Finished!", 2);
+        diagnostics.errorReg("Compile Finished!", 2);
+        diagnostics.printAllErrors();
 
     } else {
         std::cout << "Failed to construct AST (visitor returned empty).\n";
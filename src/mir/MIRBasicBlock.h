@@ -2,25 +2,48 @@
 #include "mir/MIRNode.h"
 #include "mir/MIRInstruction.h"
 #include "mir/MIRTerminator.h" // 完全な定義をインクルード
+#include <llvm/ADT/simple_ilist.h>
+
+class MIRFunction;
 
 // 基本ブロック
 class MIRBasicBlock : public MIRNode{
 public:
-    std::string name; // 基本ブロック名
-    std::vector<std::shared_ptr<MIRInstruction>> instructions; // 命令リスト
+    const char* name; // 基本ブロックの種類 ("entry", "if.then"など。文字列リテラルを指す)
+    uint32_t id = 0; // 関数の中での通し番号 (MIRFunction::addBasicBlockで振る。basicBlocks[id]がこのブロック)
+    MIRFunction* parent = nullptr; // このブロックを持つ関数 (MIRFunction::addBasicBlockで設定する)
+    using InstructionList = llvm::simple_ilist<MIRInstruction>;
+    // 命令リスト (命令を持たずにつなぐだけ。命令のメモリはMIRFunctionのアリーナにある)
+    // どこへの挿入・削除もO(1)なので、最適化で命令を書き換えるときもそのまま使える
+    InstructionList instructions;
     std::shared_ptr<MIRTerminatorInstruction> terminator; // 終端命令
-    explicit MIRBasicBlock(const std::string& blockName = "") : MIRNode(NodeType::BasicBlock), name(blockName) {}
-    void addInstruction(std::shared_ptr<MIRInstruction> inst) {instructions.push_back(inst);}
+    explicit MIRBasicBlock(const char* blockName = "bb") : MIRNode(NodeType::BasicBlock), name(blockName) {}
+    static bool classof(const MIRNode* node) {return node->getNodeType() == NodeType::BasicBlock;}
+    void addInstruction(MIRInstruction* inst) {insert(instructions.end(), inst);}
+    // posの前に入れる
+    InstructionList::iterator insert(InstructionList::iterator pos, MIRInstruction* inst){
+        inst->parent = this;
+        return instructions.insert(pos, *inst);
+    }
+    // リストから外して次の命令を返す (命令はMIRFunctionが破棄されるまで残るので、別の場所に入れ直してもよい)
+    InstructionList::iterator remove(MIRInstruction* inst){
+        inst->parent = nullptr;
+        return instructions.erase(inst->getIterator());
+    }
+    // 分岐先が変わるので関数のCFGの解析は無効になる
     void setTerminator(std::shared_ptr<MIRTerminatorInstruction> term);
+    // ダンプ用のラベル (例: if.then.3)
+    void printLabel(std::ostream& os) const {os << name << "." << id;}
 
-    void dump(std::ostream& os, int indent = 0) const override {
+    void dump(std::ostream& os, const StringInterner& names, int indent = 0) const override {
         printMirIndent(indent);
-        os << name << ":" << std::endl;
+        printLabel(os);
+        os << ":" << std::endl;
         for (const auto& inst : instructions) {
-            inst->dump(os, indent + 1);
+            inst.dump(os, names, indent + 1);
         }
         if (terminator) {
-            terminator->dump(os, indent + 1);
+            terminator->dump(os, names, indent + 1);
         }
     }
 };
\ No newline at end of file
@@ -0,0 +1,269 @@
+#include "MIRCFGAnalysis.h"
+#include "mir/MIRTerminator.h"
+#include <llvm/Support/Casting.h>
+#include <algorithm>
+#include <utility>
+
+namespace {
+constexpr uint32_t NoIndex = MIRCFG::NoIndex;
+
+// 根から辿れるノードの逆後順序
+std::vector<uint32_t> reversePostOrder(uint32_t root, const std::vector<std::vector<uint32_t>>& successors){
+    std::vector<uint32_t> order;
+    std::vector<bool> visited(successors.size(), false);
+    std::vector<std::pair<uint32_t, size_t>> stack{{root, 0}}; // (ノード, 次に見る後続の位置)
+    visited[root] = true;
+    while(!stack.empty()){
+        auto& [node, next] = stack.back();
+        if(next < successors[node].size()){
+            uint32_t succ = successors[node][next++];
+            if(!visited[succ]){
+                visited[succ] = true;
+                stack.push_back({succ, 0});
+            }
+            continue;
+        }
+        order.push_back(node);
+        stack.pop_back();
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+// Cooper, Harvey, Kennedy "A Simple, Fast Dominance Algorithm"
+// 根から辿れないノードはNoIndex、根は自分自身
+std::vector<uint32_t> computeIdoms(uint32_t root, const std::vector<std::vector<uint32_t>>& successors, const std::vector<std::vector<uint32_t>>& predecessors){
+    std::vector<uint32_t> order = reversePostOrder(root, successors);
+    std::vector<uint32_t> position(successors.size(), NoIndex);
+    for(uint32_t i = 0; i < order.size(); i++) position[order[i]] = i;
+    std::vector<uint32_t> idom(successors.size(), NoIndex);
+    idom[root] = root;
+    auto intersect = [&](uint32_t a, uint32_t b){
+        while(a != b){
+            while(position[a] > position[b]) a = idom[a];
+            while(position[b] > position[a]) b = idom[b];
+        }
+        return a;
+    };
+    bool changed = true;
+    while(changed){
+        changed = false;
+        for(size_t i = 1; i < order.size(); i++){
+            uint32_t node = order[i];
+            uint32_t newIdom = NoIndex;
+            for(uint32_t pred : predecessors[node]){
+                if(idom[pred] == NoIndex) continue;
+                newIdom = newIdom == NoIndex ? pred : intersect(pred, newIdom);
+            }
+            if(newIdom != idom[node]){
+                idom[node] = newIdom;
+                changed = true;
+            }
+        }
+    }
+    return idom;
+}
+}
+
+MIRCFG::MIRCFG(const MIRFunction& function){
+    size_t count = function.basicBlocks.size();
+    successors.resize(count);
+    predecessors.resize(count);
+    rpoIndex.assign(count, NoIndex);
+    for(const auto& block : function.basicBlocks){
+        auto& succs = successors[block->id];
+        MIRTerminatorInstruction* term = block->terminator.get();
+        if(auto branch = llvm::dyn_cast_if_present<MIRBranchInstruction>(term)){
+            succs.push_back(branch->targetBlock.get());
+        }else if(auto condBranch = llvm::dyn_cast_if_present<MIRConditionBranchInstruction>(term)){
+            succs.push_back(condBranch->trueBlock.get());
+            if(condBranch->falseBlock != condBranch->trueBlock) succs.push_back(condBranch->falseBlock.get());
+        }else{
+            exits.push_back(block.get());
+        }
+        for(MIRBasicBlock* succ : succs) predecessors[succ->id].push_back(block.get());
+    }
+    if(count == 0) return;
+    std::vector<std::vector<uint32_t>> succIds(count);
+    for(size_t i = 0; i < count; i++){
+        for(MIRBasicBlock* succ : successors[i]) succIds[i].push_back(succ->id);
+    }
+    for(uint32_t id : reversePostOrder(0, succIds)){
+        rpoIndex[id] = static_cast<uint32_t>(rpo.size());
+        rpo.push_back(function.basicBlocks[id].get());
+    }
+}
+
+MIRDominatorTree::MIRDominatorTree(const MIRFunction& function, const MIRCFG& cfg, bool postDominators) : post(postDominators){
+    size_t count = function.basicBlocks.size();
+    for(const auto& block : function.basicBlocks) blocks.push_back(block.get());
+    // 後支配木は辺を逆にして、仮想の出口(id == count)を根にする
+    size_t nodes = post ? count + 1 : count;
+    root = post ? static_cast<uint32_t>(count) : 0;
+    children.resize(nodes);
+    enter.assign(nodes, 0);
+    leave.assign(nodes, 0);
+    if(count == 0){
+        idom.assign(nodes, NoIndex);
+        if(post) idom[root] = root;
+        return;
+    }
+    std::vector<std::vector<uint32_t>> forward(nodes), backward(nodes);
+    for(MIRBasicBlock* block : blocks){
+        auto& out = post ? backward : forward;
+        auto& in = post ? forward : backward;
+        for(MIRBasicBlock* succ : cfg.getSuccessors(block)){
+            out[block->id].push_back(succ->id);
+            in[succ->id].push_back(block->id);
+        }
+    }
+    if(post){
+        for(MIRBasicBlock* exit : cfg.getExitBlocks()){
+            forward[root].push_back(exit->id);
+            backward[exit->id].push_back(root);
+        }
+    }
+    idom = computeIdoms(root, forward, backward);
+
+    for(uint32_t id = 0; id < nodes; id++){
+        if(id == root || idom[id] == NoIndex) continue;
+        children[idom[id]].push_back(blocks[id]);
+    }
+    if(post) roots = children[root];
+    else roots.push_back(blocks[root]);
+    // 木の行きと帰りの番号を振る
+    uint32_t clock = 0;
+    std::vector<std::pair<uint32_t, size_t>> stack{{root, 0}};
+    enter[root] = clock++;
+    while(!stack.empty()){
+        auto& [node, next] = stack.back();
+        if(next < children[node].size()){
+            uint32_t child = children[node][next++]->id;
+            enter[child] = clock++;
+            stack.push_back({child, 0});
+            continue;
+        }
+        leave[node] = clock++;
+        stack.pop_back();
+    }
+}
+
+MIRBasicBlock* MIRDominatorTree::getImmediateDominator(const MIRBasicBlock* block) const {
+    uint32_t parent = idom[block->id];
+    if(parent == NoIndex || parent == block->id || (post && parent == root)) return nullptr;
+    return blocks[parent];
+}
+
+bool MIRDominatorTree::dominates(const MIRBasicBlock* a, const MIRBasicBlock* b) const {
+    if(!contains(a) || !contains(b)) return false;
+    return enter[a->id] <= enter[b->id] && leave[b->id] <= leave[a->id];
+}
+
+MIRDominanceFrontier::MIRDominanceFrontier(const MIRFunction& function, const MIRCFG& cfg, const MIRDominatorTree& dominators){
+    frontiers.resize(function.basicBlocks.size());
+    for(MIRBasicBlock* block : cfg.getReversePostOrder()){
+        const auto& preds = cfg.getPredecessors(block);
+        if(preds.size() < 2) continue;
+        MIRBasicBlock* idom = dominators.getImmediateDominator(block);
+        for(MIRBasicBlock* pred : preds){
+            if(!dominators.contains(pred)) continue;
+            // predからblockの直接の支配ブロックの手前までは、blockを支配せずにblockの先行ブロックを支配する
+            for(MIRBasicBlock* runner = pred; runner && runner != idom; runner = dominators.getImmediateDominator(runner)){
+                auto& frontier = frontiers[runner->id];
+                if(!frontier.empty() && frontier.back() == block) break; // 別の先行ブロックから登録済み (この先も登録済み)
+                frontier.push_back(block);
+            }
+        }
+    }
+}
+
+MIRLoopForest::MIRLoopForest(const MIRFunction& function, const MIRCFG& cfg, const MIRDominatorTree& dominators){
+    size_t count = function.basicBlocks.size();
+    innermost.assign(count, nullptr);
+    // ヘッダを逆後順序で見るので、外側のループが先にできる
+    for(MIRBasicBlock* header : cfg.getReversePostOrder()){
+        std::vector<MIRBasicBlock*> latches;
+        for(MIRBasicBlock* pred : cfg.getPredecessors(header)){
+            if(dominators.dominates(header, pred)) latches.push_back(pred);
+        }
+        if(latches.empty()) continue;
+        auto loop = std::make_unique<MIRLoop>();
+        loop->header = header;
+        loop->latches = latches;
+        loop->members.assign(count, false);
+        loop->members[header->id] = true;
+        // ラッチから先行ブロックを遡ってヘッダまでのブロックを集める
+        std::vector<MIRBasicBlock*> worklist;
+        for(MIRBasicBlock* latch : latches){
+            if(loop->members[latch->id]) continue;
+            loop->members[latch->id] = true;
+            worklist.push_back(latch);
+        }
+        while(!worklist.empty()){
+            MIRBasicBlock* block = worklist.back();
+            worklist.pop_back();
+            for(MIRBasicBlock* pred : cfg.getPredecessors(block)){
+                if(loop->members[pred->id] || !cfg.isReachable(pred)) continue;
+                loop->members[pred->id] = true;
+                worklist.push_back(pred);
+            }
+        }
+        for(MIRBasicBlock* block : cfg.getReversePostOrder()){
+            if(loop->members[block->id]) loop->blocks.push_back(block);
+        }
+        // 先に作った外側のループのうち、ヘッダを含む一番内側のものが親
+        loop->parent = innermost[header->id];
+        if(loop->parent){
+            loop->depth = loop->parent->depth + 1;
+            loop->parent->subLoops.push_back(loop.get());
+        }else{
+            topLevelLoops.push_back(loop.get());
+        }
+        for(MIRBasicBlock* block : loop->blocks) innermost[block->id] = loop.get();
+        loops.push_back(std::move(loop));
+    }
+}
+
+void MIRFunctionAnalysis::revalidate(){
+    if(cfgVersion == function.cfgVersion) return;
+    invalidate();
+    cfgVersion = function.cfgVersion;
+}
+
+void MIRFunctionAnalysis::invalidate(){
+    cfg.reset();
+    dominators.reset();
+    postDominators.reset();
+    frontier.reset();
+    loops.reset();
+}
+
+const MIRCFG& MIRFunctionAnalysis::getCFG(){
+    revalidate();
+    if(!cfg) cfg = std::make_unique<MIRCFG>(function);
+    return *cfg;
+}
+
+const MIRDominatorTree& MIRFunctionAnalysis::getDominatorTree(){
+    const MIRCFG& graph = getCFG();
+    if(!dominators) dominators = std::make_unique<MIRDominatorTree>(function, graph, false);
+    return *dominators;
+}
+
+const MIRDominatorTree& MIRFunctionAnalysis::getPostDominatorTree(){
+    const MIRCFG& graph = getCFG();
+    if(!postDominators) postDominators = std::make_unique<MIRDominatorTree>(function, graph, true);
+    return *postDominators;
+}
+
+const MIRDominanceFrontier& MIRFunctionAnalysis::getDominanceFrontier(){
+    const MIRDominatorTree& tree = getDominatorTree();
+    if(!frontier) frontier = std::make_unique<MIRDominanceFrontier>(function, *cfg, tree);
+    return *frontier;
+}
+
+const MIRLoopForest& MIRFunctionAnalysis::getLoops(){
+    const MIRDominatorTree& tree = getDominatorTree();
+    if(!loops) loops = std::make_unique<MIRLoopForest>(function, *cfg, tree);
+    return *loops;
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include "mir/MIRBasicBlock.h"
+#include "mir/MIRFunction.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// MIRFunctionの制御フローの解析 (最適化のための土台)
+// 基本ブロックは関数の中の通し番号(MIRBasicBlock::id)を添字にした配列で引く
+// 結果はMIRFunctionAnalysisがまとめて持ち、CFGが変わったら(MIRFunction::cfgVersion)作り直す
+
+// 先行・後続ブロックと逆後順序
+class MIRCFG{
+private:
+    std::vector<std::vector<MIRBasicBlock*>> successors;
+    std::vector<std::vector<MIRBasicBlock*>> predecessors;
+    std::vector<MIRBasicBlock*> rpo; // エントリーから辿れるブロックだけ
+    std::vector<uint32_t> rpoIndex; // rpoの中の位置 (辿れなければNoIndex)
+    std::vector<MIRBasicBlock*> exits; // 終端命令がreturnのブロック (終端命令がないブロックも含む)
+public:
+    static constexpr uint32_t NoIndex = UINT32_MAX;
+    explicit MIRCFG(const MIRFunction& function);
+    size_t getBlockCount() const {return successors.size();}
+    // 分岐先が同じブロックの条件分岐は辺1本として数える
+    const std::vector<MIRBasicBlock*>& getSuccessors(const MIRBasicBlock* block) const {return successors[block->id];}
+    const std::vector<MIRBasicBlock*>& getPredecessors(const MIRBasicBlock* block) const {return predecessors[block->id];}
+    const std::vector<MIRBasicBlock*>& getReversePostOrder() const {return rpo;}
+    uint32_t getRpoIndex(const MIRBasicBlock* block) const {return rpoIndex[block->id];}
+    bool isReachable(const MIRBasicBlock* block) const {return rpoIndex[block->id] != NoIndex;}
+    const std::vector<MIRBasicBlock*>& getExitBlocks() const {return exits;}
+};
+
+// 支配木・後支配木 (Cooper, Harvey, Kennedyの反復法)
+// 後支配木は出口ブロックすべての後ろに仮想の出口があるものとして作る。出口に辿り着けないブロック(無限ループ)は木に入らない
+class MIRDominatorTree{
+private:
+    bool post;
+    std::vector<MIRBasicBlock*> blocks; // idからブロック
+    std::vector<uint32_t> idom; // 直接の支配ブロックのid (根はroot、木に入らないブロックはNoIndex)
+    std::vector<std::vector<MIRBasicBlock*>> children;
+    std::vector<MIRBasicBlock*> roots; // 根の子 (支配木はエントリーだけ、後支配木は仮想の出口の直下のブロック)
+    std::vector<uint32_t> enter, leave; // 木を深さ優先で辿ったときの番号 (dominatesを定数時間にする)
+    uint32_t root; // 支配木はエントリーのid、後支配木は仮想の出口 (ブロック数)
+public:
+    MIRDominatorTree(const MIRFunction& function, const MIRCFG& cfg, bool postDominators);
+    bool isPostDominatorTree() const {return post;}
+    bool contains(const MIRBasicBlock* block) const {return idom[block->id] != MIRCFG::NoIndex;}
+    // 直接の(後)支配ブロック。エントリー、仮想の出口の直下のブロック、木に入らないブロックはnullptr
+    MIRBasicBlock* getImmediateDominator(const MIRBasicBlock* block) const;
+    const std::vector<MIRBasicBlock*>& getChildren(const MIRBasicBlock* block) const {return children[block->id];}
+    const std::vector<MIRBasicBlock*>& getRoots() const {return roots;}
+    // aがbを(後)支配するか (a == bも含む)
+    bool dominates(const MIRBasicBlock* a, const MIRBasicBlock* b) const;
+    bool properlyDominates(const MIRBasicBlock* a, const MIRBasicBlock* b) const {return a != b && dominates(a, b);}
+};
+
+// 支配辺境 (SSA化でφを置く場所を決めるのに使う)
+class MIRDominanceFrontier{
+private:
+    std::vector<std::vector<MIRBasicBlock*>> frontiers;
+public:
+    MIRDominanceFrontier(const MIRFunction& function, const MIRCFG& cfg, const MIRDominatorTree& dominators);
+    const std::vector<MIRBasicBlock*>& getFrontier(const MIRBasicBlock* block) const {return frontiers[block->id];}
+};
+
+// 自然ループ (MIRGenのfor.condがヘッダになる)
+struct MIRLoop{
+    MIRBasicBlock* header;
+    std::vector<MIRBasicBlock*> blocks; // ヘッダを先頭にしたループ内のブロック (内側のループのブロックも含む)
+    std::vector<MIRBasicBlock*> latches; // ヘッダに戻る辺の元
+    MIRLoop* parent = nullptr;
+    std::vector<MIRLoop*> subLoops;
+    unsigned depth = 1; // 一番外側のループが1
+    std::vector<bool> members; // ブロックのidで引く
+    bool contains(const MIRBasicBlock* block) const {return block->id < members.size() && members[block->id];}
+};
+
+// 関数の中のループの入れ子
+// MIRGenは構造化された制御フローしか作らないので、既約でない閉路はループとして扱わない
+class MIRLoopForest{
+private:
+    std::vector<std::unique_ptr<MIRLoop>> loops; // 外側のループが先
+    std::vector<MIRLoop*> topLevelLoops;
+    std::vector<MIRLoop*> innermost; // ブロックのidから、それを含む一番内側のループ
+public:
+    MIRLoopForest(const MIRFunction& function, const MIRCFG& cfg, const MIRDominatorTree& dominators);
+    const std::vector<MIRLoop*>& getTopLevelLoops() const {return topLevelLoops;}
+    size_t getLoopCount() const {return loops.size();}
+    MIRLoop* getLoopFor(const MIRBasicBlock* block) const {return innermost[block->id];}
+    unsigned getLoopDepth(const MIRBasicBlock* block) const {return innermost[block->id] ? innermost[block->id]->depth : 0;}
+    bool isLoopHeader(const MIRBasicBlock* block) const {return innermost[block->id] && innermost[block->id]->header == block;}
+};
+
+// 関数ごとの解析結果のキャッシュ
+// 欲しい解析だけを初めて使うときに作り、MIRFunction::cfgVersionが変わっていたらすべて捨てる
+// 返した参照は、CFGが変わった後にまた解析を取ってくるまで使える
+class MIRFunctionAnalysis{
+private:
+    const MIRFunction& function;
+    uint64_t cfgVersion;
+    std::unique_ptr<MIRCFG> cfg;
+    std::unique_ptr<MIRDominatorTree> dominators;
+    std::unique_ptr<MIRDominatorTree> postDominators;
+    std::unique_ptr<MIRDominanceFrontier> frontier;
+    std::unique_ptr<MIRLoopForest> loops;
+    void revalidate();
+public:
+    explicit MIRFunctionAnalysis(const MIRFunction& func) : function(func), cfgVersion(func.cfgVersion) {}
+    const MIRCFG& getCFG();
+    const MIRDominatorTree& getDominatorTree();
+    const MIRDominatorTree& getPostDominatorTree();
+    const MIRDominanceFrontier& getDominanceFrontier();
+    const MIRLoopForest& getLoops();
+    // 今ある結果をすべて捨てる (MIRFunction::invalidateCFGを呼べばこれも自動で行われる)
+    void invalidate();
+};
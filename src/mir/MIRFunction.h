@@ -4,33 +4,64 @@
 #include "mir/MIRType.h"
 #include "mir/MIRValue.h"
 #include "mir/MIRBasicBlock.h" // MIRBasicBlock を使うのでインクルード
+#include "common/StringInterner.h"
+#include <llvm/Support/Allocator.h>
 #include <map>
 #include <string>
+#include <utility>
 
 // 関数
 class MIRFunction : public MIRNode{
+private:
+    // 命令のアリーナ (AstContextと同じく、関数を破棄したときにまとめて解放する)
+    llvm::BumpPtrAllocator instructionAllocator;
+    std::vector<MIRInstruction*> allocatedInstructions; // デストラクタを呼ぶため
 public:
-    std::string name; // 関数名
-    std::shared_ptr<MIRType> returnType; // 戻り値の型
+    NameId name; // 関数名
+    MIRType* returnType; // 戻り値の型
     std::vector<std::shared_ptr<MIRArgumentValue>> arguments; // 引数リスト
     std::vector<std::shared_ptr<MIRBasicBlock>> basicBlocks; // 基本ブロックのリスト
-    std::map<std::string, std::shared_ptr<MIRType>> localVariables; // ローカル変数の型情報など (未使用)
-    explicit MIRFunction(const std::string& funcName, std::shared_ptr<MIRType> retType)
+    std::map<std::string, MIRType*> localVariables; // ローカル変数の型情報など (未使用)
+    uint32_t numValues = 0; // これまでに振った値の番号の数 (MIRValue::idは0からnumValues-1)
+    uint64_t cfgVersion = 0; // ブロックや分岐先が変わるたびに増える (MIRFunctionAnalysisはこれで結果を捨てる)
+    explicit MIRFunction(NameId funcName, MIRType* retType)
         : MIRNode(NodeType::Function), name(funcName), returnType(retType) {}
+    MIRFunction(const MIRFunction&) = delete;
+    MIRFunction& operator=(const MIRFunction&) = delete;
+    ~MIRFunction() override {
+        // 基本ブロックは分岐先として関数より長く生きることがあるので、先にリストを空にしておく
+        for(auto& block : basicBlocks) block->instructions.clear();
+        for(auto it = allocatedInstructions.rbegin(); it != allocatedInstructions.rend(); ++it) (*it)->~MIRInstruction();
+    }
+    static bool classof(const MIRNode* node) {return node->getNodeType() == NodeType::Function;}
+    // この関数の命令を作る (基本ブロックにはaddInstruction・insertでつなぐ)
+    template<typename T, typename... Args>
+    T* createInstruction(Args&&... args){
+        T* inst = new (instructionAllocator.Allocate<T>()) T(std::forward<Args>(args)...);
+        allocatedInstructions.push_back(inst);
+        return inst;
+    }
     void addArgument(std::shared_ptr<MIRArgumentValue> arg){
         arguments.push_back(arg);
     }
     void addBasicBlock(std::shared_ptr<MIRBasicBlock> block){
+        block->id = static_cast<uint32_t>(basicBlocks.size());
+        block->parent = this;
         basicBlocks.push_back(block);
+        invalidateCFG();
     }
+    // setTerminatorを通さずに終端命令の分岐先を書き換えたときは自分で呼ぶ
+    void invalidateCFG(){cfgVersion++;}
+    // 引数・命令の結果に振る新しい番号
+    uint32_t newValueId(){return numValues++;}
 
-    void dump(std::ostream& os, int indent = 0) const override {
+    void dump(std::ostream& os, const StringInterner& names, int indent = 0) const override {
         printMirIndent(indent);
         os << "define ";
-        returnType->dump(os);
-        os << " @" << name << "(";
+        returnType->dump(os, names);
+        os << " @" << names.str(name) << "(";
         for (size_t i = 0; i < arguments.size(); ++i) {
-            arguments[i]->dump(os);
+            arguments[i]->dump(os, names);
             if (i < arguments.size() - 1) {
                 os << ", ";
             }
@@ -38,7 +69,7 @@ public:
         os << ") {" << std::endl;
 
         for (const auto& block : basicBlocks) {
-            block->dump(os, indent + 1);
+            block->dump(os, names, indent + 1);
         }
 
         printMirIndent(indent);
@@ -1,33 +1,43 @@
 #pragma once
 #include "mir/MIRNode.h"
 #include "mir/MIRValue.h"
+#include "mir/MIROpcode.h"
+#include "common/StringInterner.h"
+#include <llvm/ADT/ilist_node.h>
 #include <vector>
 #include <map>
 
+class MIRBasicBlock;
+
 // 命令の基底クラス
-class MIRInstruction : public MIRNode{
+// 命令はMIRFunction::createInstructionでアリーナに作り、基本ブロックの双方向リストにつなぐ
+class MIRInstruction : public MIRNode, public llvm::ilist_node<MIRInstruction>{
 public:
     std::shared_ptr<MIRRegisterValue> result; // 命令の結果が格納される一時変数
-    explicit MIRInstruction(NodeType type, std::shared_ptr<MIRType> resultType = nullptr, const std::string& resultName = "")
-        : MIRNode(type), result(resultType ? std::make_shared<MIRRegisterValue>(resultType, resultName) : nullptr) {}
+    MIRBasicBlock* parent = nullptr; // つながっている基本ブロック (MIRBasicBlockのinsert・removeで更新する)
+    // resultIdはMIRFunction::newValueIdで取った番号
+    explicit MIRInstruction(NodeType type, MIRType* resultType = nullptr, uint32_t resultId = MIRValue::NoId)
+        : MIRNode(type), result(resultType ? std::make_shared<MIRRegisterValue>(resultType, resultId) : nullptr) {}
     
+    static bool classof(const MIRNode* node) {return node->getNodeType() >= NodeType::FirstInstruction && node->getNodeType() <= NodeType::LastInstruction;}
     // 各派生クラスで実装される
-    void dump(std::ostream& os, int indent = 0) const override = 0;
+    void dump(std::ostream& os, const StringInterner& names, int indent = 0) const override = 0;
 };
 
 // 単項命令
 class MIRUnaryInstruction : public MIRInstruction{
 public:
-    std::string opcode; // "neg", "not"
+    MIROpcode opcode; // Neg, FNeg, Not
     std::shared_ptr<MIRValue> operand; // オペランド
-    explicit MIRUnaryInstruction(const std::string& op, std::shared_ptr<MIRValue> val, std::shared_ptr<MIRType> resultType, const std::string& resultName = "")
-        : MIRInstruction(NodeType::UnaryInstruction, resultType, resultName), opcode(op), operand(val) {}
+    explicit MIRUnaryInstruction(MIROpcode op, std::shared_ptr<MIRValue> val, MIRType* resultType, uint32_t resultId = MIRValue::NoId)
+        : MIRInstruction(NodeType::UnaryInstruction, resultType, resultId), opcode(op), operand(val) {}
+    static bool classof(const MIRNode* node) {return node->getNodeType() == NodeType::UnaryInstruction;}
 
-    void dump(std::ostream& os, int indent = 0) const override {
+    void dump(std::ostream& os, const StringInterner& names, int indent = 0) const override {
         printMirIndent(indent);
-        if (result) { result->dump(os); os << " = "; }
-        os << opcode << " ";
-        operand->dump(os);
+        if (result) { result->dump(os, names); os << " = "; }
+        os << getOpcodeInfo(opcode).name << " ";
+        operand->dump(os, names);
         os << std::endl;
     }
 };
@@ -35,19 +45,20 @@ public:
 // 二項命令
 class MIRBinaryInstruction : public MIRInstruction{
 public:
-    std::string opcode; // "add", "sub", "icmp eq" など
+    MIROpcode opcode; // Add, FAdd, ICmpEq など
     std::shared_ptr<MIRValue> leftOperand; // 左オペランド
     std::shared_ptr<MIRValue> rightOperand; // 右オペランド
-    explicit MIRBinaryInstruction(const std::string& op, std::shared_ptr<MIRValue> left, std::shared_ptr<MIRValue> right, std::shared_ptr<MIRType> resultType, const std::string& resultName = "")
-        : MIRInstruction(NodeType::BinaryInstruction, resultType, resultName), opcode(op), leftOperand(left), rightOperand(right) {}
+    explicit MIRBinaryInstruction(MIROpcode op, std::shared_ptr<MIRValue> left, std::shared_ptr<MIRValue> right, MIRType* resultType, uint32_t resultId = MIRValue::NoId)
+        : MIRInstruction(NodeType::BinaryInstruction, resultType, resultId), opcode(op), leftOperand(left), rightOperand(right) {}
+    static bool classof(const MIRNode* node) {return node->getNodeType() == NodeType::BinaryInstruction;}
 
-    void dump(std::ostream& os, int indent = 0) const override {
+    void dump(std::ostream& os, const StringInterner& names, int indent = 0) const override {
         printMirIndent(indent);
-        if (result) { result->dump(os); os << " = "; }
-        os << opcode << " ";
-        leftOperand->dump(os);
+        if (result) { result->dump(os, names); os << " = "; }
+        os << getOpcodeInfo(opcode).name << " ";
+        leftOperand->dump(os, names);
         os << ", ";
-        rightOperand->dump(os);
+        rightOperand->dump(os, names);
         os << std::endl;
     }
 };
@@ -55,19 +66,20 @@ public:
 // メモリ割り当て命令 (alloca)
 class MIRAllocaInstruction : public MIRInstruction{
 public: 
-    std::shared_ptr<MIRType> allocatedType; // 割り当てるメモリの型
-    std::string varName; // 変数名 (デバッグ用)
+    MIRType* allocatedType; // 割り当てるメモリの型
+    NameId varName; // 変数名 (デバッグ用)
     size_t size;
-    explicit MIRAllocaInstruction(std::shared_ptr<MIRType> typeToAlloc, const std::string& name, std::shared_ptr<MIRType> resultPtrType, const std::string& resultName = "", size_t siz = 0)
-        : MIRInstruction(NodeType::AllocaInstruction, resultPtrType, resultName), allocatedType(typeToAlloc), varName(name), size(siz) {}
+    explicit MIRAllocaInstruction(MIRType* typeToAlloc, NameId name, MIRType* resultPtrType, uint32_t resultId = MIRValue::NoId, size_t siz = 0)
+        : MIRInstruction(NodeType::AllocaInstruction, resultPtrType, resultId), allocatedType(typeToAlloc), varName(name), size(siz) {}
+    static bool classof(const MIRNode* node) {return node->getNodeType() == NodeType::AllocaInstruction;}
 
-    void dump(std::ostream& os, int indent = 0) const override {
+    void dump(std::ostream& os, const StringInterner& names, int indent = 0) const override {
         printMirIndent(indent);
-        result->dump(os);
+        result->dump(os, names);
         os << " = alloca ";
-        allocatedType->dump(os);
+        allocatedType->dump(os, names);
         if (!varName.empty()) {
-            os << " ; " << varName;
+            os << " ; " << names.str(varName);
         }
         os << std::endl;
     }
@@ -77,24 +89,17 @@ public:
 class MIRLoadInstruction : public MIRInstruction{
 public:
     std::shared_ptr<MIRValue> pointer; // ロード元のアドレス
-    explicit MIRLoadInstruction(std::shared_ptr<MIRValue> ptr, std::shared_ptr<MIRType> resultType, const std::string& resultName = "")
-        : MIRInstruction(NodeType::LoadInstruction, resultType, resultName), pointer(ptr) {}
+    explicit MIRLoadInstruction(std::shared_ptr<MIRValue> ptr, MIRType* resultType, uint32_t resultId = MIRValue::NoId)
+        : MIRInstruction(NodeType::LoadInstruction, resultType, resultId), pointer(ptr) {}
+    static bool classof(const MIRNode* node) {return node->getNodeType() == NodeType::LoadInstruction;}
 
-    void dump(std::ostream& os, int indent = 0) const override {
+    void dump(std::ostream& os, const StringInterner& names, int indent = 0) const override {
         printMirIndent(indent);
-        result->dump(os);
+        result->dump(os, names);
         os << " = load ";
-        
-        // pointer->type->name は "int*" のようになっているはずなので、'*'を取り除く
-        std::string pointeeType = pointer->type->name;
-        size_t starPos = pointeeType.rfind('*');
-        if (starPos != std::string::npos) {
-            pointeeType.erase(starPos);
-        }
-        os << pointeeType;
-
+        result->type->dump(os, names); // 読み込む型
         os << ", ";
-        pointer->dump(os); // ロード元ポインタ
+        pointer->dump(os, names); // ロード元ポインタ
         os << std::endl;
     }
 };
@@ -106,13 +111,14 @@ public:
     std::shared_ptr<MIRValue> pointer; // ストア先のアドレス
     explicit MIRStoreInstruction(std::shared_ptr<MIRValue> val, std::shared_ptr<MIRValue> ptr)
         : MIRInstruction(NodeType::StoreInstruction), value(val), pointer(ptr) {}
+    static bool classof(const MIRNode* node) {return node->getNodeType() == NodeType::StoreInstruction;}
 
-    void dump(std::ostream& os, int indent = 0) const override {
+    void dump(std::ostream& os, const StringInterner& names, int indent = 0) const override {
         printMirIndent(indent);
         os << "store ";
-        value->dump(os);
+        value->dump(os, names);
         os << ", ";
-        pointer->dump(os);
+        pointer->dump(os, names);
         os << std::endl;
     }
 };
@@ -120,17 +126,18 @@ public:
 // 関数呼び出し命令
 class MIRCallInstruction : public MIRInstruction{
 public:
-    std::string calleeName; // 呼び出す関数名
+    NameId calleeName; // 呼び出す関数名
     std::vector<std::shared_ptr<MIRValue>> arguments; // 引数リスト
-    explicit MIRCallInstruction(const std::string& name, const std::vector<std::shared_ptr<MIRValue>>& args, std::shared_ptr<MIRType> resultType, const std::string& resultName = "")
-        : MIRInstruction(NodeType::CallInstruction, resultType, resultName), calleeName(name), arguments(args) {}
+    explicit MIRCallInstruction(NameId name, const std::vector<std::shared_ptr<MIRValue>>& args, MIRType* resultType, uint32_t resultId = MIRValue::NoId)
+        : MIRInstruction(NodeType::CallInstruction, resultType, resultId), calleeName(name), arguments(args) {}
+    static bool classof(const MIRNode* node) {return node->getNodeType() == NodeType::CallInstruction;}
 
-    void dump(std::ostream& os, int indent = 0) const override {
+    void dump(std::ostream& os, const StringInterner& names, int indent = 0) const override {
         printMirIndent(indent);
-        if (result) { result->dump(os); os << " = "; }
-        os << "call @" << calleeName << "(";
+        if (result) { result->dump(os, names); os << " = "; }
+        os << "call @" << names.str(calleeName) << "(";
         for (size_t i = 0; i < arguments.size(); ++i) {
-            arguments[i]->dump(os);
+            arguments[i]->dump(os, names);
             if (i < arguments.size() - 1) {
                 os << ", ";
             }
@@ -155,13 +162,14 @@ class MIRCastInstruction : public MIRInstruction{
 public:
     CastOpcode opcode;
     std::shared_ptr<MIRValue> operand; // キャスト対象のオペランド
-    std::shared_ptr<MIRType> targetType; // キャスト先の型
-    explicit MIRCastInstruction(CastOpcode op, std::shared_ptr<MIRValue> val, std::shared_ptr<MIRType> target, const std::string& resultName = "")
-        : MIRInstruction(NodeType::CastInstruction, target, resultName), opcode(op), operand(val), targetType(target) {}
+    MIRType* targetType; // キャスト先の型
+    explicit MIRCastInstruction(CastOpcode op, std::shared_ptr<MIRValue> val, MIRType* target, uint32_t resultId = MIRValue::NoId)
+        : MIRInstruction(NodeType::CastInstruction, target, resultId), opcode(op), operand(val), targetType(target) {}
+    static bool classof(const MIRNode* node) {return node->getNodeType() == NodeType::CastInstruction;}
 
-    void dump(std::ostream& os, int indent = 0) const override {
+    void dump(std::ostream& os, const StringInterner& names, int indent = 0) const override {
         printMirIndent(indent);
-        result->dump(os);
+        result->dump(os, names);
         os << " = ";
         switch(opcode) {
             case CastOpcode::SIToFP: os << "sitofp"; break;
@@ -173,9 +181,9 @@ public:
             case CastOpcode::PtrCast: os << "ptrcast"; break;
         }
         os << " ";
-        operand->dump(os);
+        operand->dump(os, names);
         os << " to ";
-        targetType->dump(os);
+        targetType->dump(os, names);
         os << std::endl;
     }
 };
@@ -185,29 +193,30 @@ class MIRGepInstruction : public MIRInstruction{
 public:
     std::shared_ptr<MIRValue> basePtr;
     std::shared_ptr<MIRValue> index;
-    std::shared_ptr<MIRType> elementType; // これが要素の型 (int)
-    std::shared_ptr<MIRType> ptrOrArrayType; // basePtrが指す型 ([5 x i64])
+    MIRType* elementType; // これが要素の型 (int)
+    MIRType* ptrOrArrayType; // basePtrが指す型 ([5 x i64])
     
     explicit MIRGepInstruction(
         std::shared_ptr<MIRValue> base,
         std::shared_ptr<MIRValue> idx,
-        std::shared_ptr<MIRType> elemType,
-        std::shared_ptr<MIRType> ptrOrArrayTy, // 新しい引数
-        const std::string& resultName
-    ) : MIRInstruction(NodeType::GepInstruction, elemType, resultName),
+        MIRType* elemType,
+        MIRType* ptrOrArrayTy, // 新しい引数
+        uint32_t resultId
+    ) : MIRInstruction(NodeType::GepInstruction, elemType, resultId),
         basePtr(base), 
         index(idx), 
         elementType(elemType),
         ptrOrArrayType(ptrOrArrayTy) {} // 新しいメンバの初期化
+    static bool classof(const MIRNode* node) {return node->getNodeType() == NodeType::GepInstruction;}
     
-    void dump(std::ostream& os, int indent = 0) const override {
+    void dump(std::ostream& os, const StringInterner& names, int indent = 0) const override {
         printMirIndent(indent);
-        if (result) { result->dump(os); os << " = "; }
+        if (result) { result->dump(os, names); os << " = "; }
         os << "getelementptr " << elementType->name 
             << ", ptr ";
-        basePtr->dump(os);
+        basePtr->dump(os, names);
         os << ", ";
-        index->dump(os);
+        index->dump(os, names);
         os << std::endl;
     }
 };
\ No newline at end of file
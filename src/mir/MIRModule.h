@@ -2,23 +2,27 @@
 
 #include "mir/MIRFunction.h"
 #include "mir/MIRNode.h"
+#include "mir/MIRTypeContext.h"
 
 // 最上位のモジュール
 class MIRModule : public MIRNode{
 public:
     std::string name; // モジュール名
     std::vector<std::shared_ptr<MIRFunction>> functions; // 関数リスト
-    explicit MIRModule(const std::string& moduleName = "LumaMIRModule")
-        : MIRNode(NodeType::Module), name(moduleName) {}
+    // 関数の中の型はすべてここにある (関数だけを取り出したモジュールは元のモジュールと共有する)
+    std::shared_ptr<MIRTypeContext> types;
+    explicit MIRModule(const std::string& moduleName = "LumaMIRModule", std::shared_ptr<MIRTypeContext> typeContext = nullptr)
+        : MIRNode(NodeType::Module), name(moduleName), types(typeContext ? std::move(typeContext) : std::make_shared<MIRTypeContext>()) {}
+    static bool classof(const MIRNode* node) {return node->getNodeType() == NodeType::Module;}
     void addFunction(std::shared_ptr<MIRFunction> func){
         functions.push_back(func);
     }
 
-    void dump(std::ostream& os, int indent = 0) const override {
+    void dump(std::ostream& os, const StringInterner& names, int indent = 0) const override {
         os << "; ModuleID = '" << name << "'" << std::endl;
         os << std::endl;
         for (const auto& func : functions) {
-            func->dump(os, indent);
+            func->dump(os, names, indent);
             os << std::endl;
         }
     }
@@ -3,6 +3,8 @@
 #include <vector>
 #include <memory>
 #include <iostream>
+#include "common/SourceManager.h"
+#include "common/StringInterner.h"
 
 // インデントヘルパー
 inline void printMirIndent(int indent) {
@@ -12,39 +14,44 @@ inline void printMirIndent(int indent) {
 }
 
 // 全てのMIRノードの基底クラス
+// nodeTypeは具体的なクラスごとに1つ (llvm::isa/cast/dyn_castは各クラスのclassofでこれを見る)
 class MIRNode{
 public:
     enum class NodeType{
         Module,
         Function,
         BasicBlock,
-        Instruction,
-        TerminatorInstruction,
-        Value,
         Type,
-        LiteralType,
+        // 値 (MIRValue)
+        LiteralValue,
         RegisterValue,
         ArgumentValue,
+        // 命令 (MIRInstruction)
         UnaryInstruction,
         BinaryInstruction,
-        MemoryInstruction,
+        AllocaInstruction,
+        LoadInstruction,
+        StoreInstruction,
         CallInstruction,
         CastInstruction,
+        GepInstruction,
+        // 終端命令 (MIRTerminatorInstruction)
         ReturnInstruction,
         BranchInstruction,
         ConditionalBranchInstruction,
-        AllocaInstruction,
-        LoadInstruction,
-        StoreInstruction,
-        AddInstruction,
-        SubInstruction,
-        MulInstruction,
-        DivInstruction,
-        CmpInstruction,
-        GepInstruction,
+        FirstValue = LiteralValue,
+        LastValue = ArgumentValue,
+        FirstInstruction = UnaryInstruction,
+        LastInstruction = GepInstruction,
+        FirstTerminator = ReturnInstruction,
+        LastTerminator = ConditionalBranchInstruction,
     };
-    NodeType nodeType;
+    const NodeType nodeType;
+    // 元になったASTのノードの位置 (命令・終端命令・関数で使う。LLVMGenでDebugLocにする)
+    // nodeTypeの後ろの隙間に入るのでノードは大きくならない
+    SourceLocation loc;
     explicit MIRNode(NodeType type) : nodeType(type) {}
+    NodeType getNodeType() const {return nodeType;}
     virtual ~MIRNode() = default;
-    virtual void dump(std::ostream& os, int indent = 0) const = 0;
+    virtual void dump(std::ostream& os, const StringInterner& names, int indent = 0) const = 0;
 };
\ No newline at end of file
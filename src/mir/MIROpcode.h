@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// 単項・二項命令のオペコード (キャストはCastOpcode)
+// 整数と浮動小数点数で別のオペコードにする。比較の結果はbool
+enum class MIROpcode : uint8_t{
+    // 二項演算
+    Add, FAdd,
+    Sub, FSub,
+    Mul, FMul,
+    SDiv, FDiv,
+    // 比較
+    ICmpEq, FCmpEq,
+    ICmpNe, FCmpNe,
+    ICmpLt, FCmpLt,
+    ICmpGt, FCmpGt,
+    ICmpLe, FCmpLe,
+    ICmpGe, FCmpGe,
+    // 単項演算
+    Neg, FNeg,
+    Not,
+};
+
+// オペコードごとの性質 (MIRGenのオペコードの選択・ダンプ・LLVMGen・インタプリタ、今後のMIRの最適化で使う)
+struct MIROpcodeInfo{
+    const char* name;     // ダンプでの名前 ("add", "icmp lt"など)
+    uint8_t operands;     // オペランドの数 (1か2)
+    bool isFloat;         // 浮動小数点数を扱う
+    bool isCompare;       // 比較 (結果はbool)
+    bool commutative;     // オペランドを入れ替えても結果が同じ
+    bool sideEffectFree;  // 例外・未定義動作を起こさない (消したり動かしたりしてよい)
+    MIROpcode intVariant;   // 整数版のオペコード
+    MIROpcode floatVariant; // 浮動小数点数版のオペコード (Notは自分自身)
+};
+
+// MIROpcodeの順番に並べる
+inline constexpr MIROpcodeInfo MIROpcodeTable[] = {
+    {"add",     2, false, false, true,  true,  MIROpcode::Add,    MIROpcode::FAdd},
+    {"fadd",    2, true,  false, true,  true,  MIROpcode::Add,    MIROpcode::FAdd},
+    {"sub",     2, false, false, false, true,  MIROpcode::Sub,    MIROpcode::FSub},
+    {"fsub",    2, true,  false, false, true,  MIROpcode::Sub,    MIROpcode::FSub},
+    {"mul",     2, false, false, true,  true,  MIROpcode::Mul,    MIROpcode::FMul},
+    {"fmul",    2, true,  false, true,  true,  MIROpcode::Mul,    MIROpcode::FMul},
+    {"sdiv",    2, false, false, false, false, MIROpcode::SDiv,   MIROpcode::FDiv}, // 0除算・オーバーフローがある
+    {"fdiv",    2, true,  false, false, true,  MIROpcode::SDiv,   MIROpcode::FDiv},
+    {"icmp eq", 2, false, true,  true,  true,  MIROpcode::ICmpEq, MIROpcode::FCmpEq},
+    {"fcmp eq", 2, true,  true,  true,  true,  MIROpcode::ICmpEq, MIROpcode::FCmpEq},
+    {"icmp ne", 2, false, true,  true,  true,  MIROpcode::ICmpNe, MIROpcode::FCmpNe},
+    {"fcmp ne", 2, true,  true,  true,  true,  MIROpcode::ICmpNe, MIROpcode::FCmpNe},
+    {"icmp lt", 2, false, true,  false, true,  MIROpcode::ICmpLt, MIROpcode::FCmpLt},
+    {"fcmp lt", 2, true,  true,  false, true,  MIROpcode::ICmpLt, MIROpcode::FCmpLt},
+    {"icmp gt", 2, false, true,  false, true,  MIROpcode::ICmpGt, MIROpcode::FCmpGt},
+    {"fcmp gt", 2, true,  true,  false, true,  MIROpcode::ICmpGt, MIROpcode::FCmpGt},
+    {"icmp le", 2, false, true,  false, true,  MIROpcode::ICmpLe, MIROpcode::FCmpLe},
+    {"fcmp le", 2, true,  true,  false, true,  MIROpcode::ICmpLe, MIROpcode::FCmpLe},
+    {"icmp ge", 2, false, true,  false, true,  MIROpcode::ICmpGe, MIROpcode::FCmpGe},
+    {"fcmp ge", 2, true,  true,  false, true,  MIROpcode::ICmpGe, MIROpcode::FCmpGe},
+    {"neg",     1, false, false, false, true,  MIROpcode::Neg,    MIROpcode::FNeg},
+    {"fneg",    1, true,  false, false, true,  MIROpcode::Neg,    MIROpcode::FNeg},
+    {"not",     1, false, false, false, true,  MIROpcode::Not,    MIROpcode::Not},
+};
+inline constexpr size_t MIROpcodeCount = sizeof(MIROpcodeTable) / sizeof(MIROpcodeTable[0]);
+static_assert(MIROpcodeCount == static_cast<size_t>(MIROpcode::Not) + 1, "MIROpcodeTable must list every MIROpcode in order");
+
+inline const MIROpcodeInfo& getOpcodeInfo(MIROpcode op){
+    return MIROpcodeTable[static_cast<size_t>(op)];
+}
+
+// 整数版・浮動小数点数版のどちらかを選ぶ
+inline MIROpcode selectOpcode(MIROpcode op, bool isFloat){
+    return isFloat ? getOpcodeInfo(op).floatVariant : getOpcodeInfo(op).intVariant;
+}
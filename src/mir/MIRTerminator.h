@@ -8,8 +8,9 @@ class MIRBasicBlock; // Forward declaration
 class MIRTerminatorInstruction : public MIRNode{
 public:
     explicit MIRTerminatorInstruction(NodeType type) : MIRNode(type) {}
+    static bool classof(const MIRNode* node) {return node->getNodeType() >= NodeType::FirstTerminator && node->getNodeType() <= NodeType::LastTerminator;}
     // 各派生クラスで実装される
-    void dump(std::ostream& os, int indent = 0) const override = 0;
+    void dump(std::ostream& os, const StringInterner& names, int indent = 0) const override = 0;
 };
 
 // リターン命令
@@ -18,8 +19,9 @@ public:
     std::shared_ptr<MIRValue> returnValue; // 戻り値 (voidの場合はnullptr)
     explicit MIRReturnInstruction(std::shared_ptr<MIRValue> retVal = nullptr)
         : MIRTerminatorInstruction(NodeType::ReturnInstruction), returnValue(retVal) {}
+    static bool classof(const MIRNode* node) {return node->getNodeType() == NodeType::ReturnInstruction;}
 
-    void dump(std::ostream& os, int indent = 0) const override;
+    void dump(std::ostream& os, const StringInterner& names, int indent = 0) const override;
 };
 
 // 無条件分岐命令
@@ -27,7 +29,8 @@ class MIRBranchInstruction : public MIRTerminatorInstruction{
 public:
     std::shared_ptr<MIRBasicBlock> targetBlock; // 分岐先の基本ブロック
     explicit MIRBranchInstruction(std::shared_ptr<MIRBasicBlock> target);
-    void dump(std::ostream& os, int indent = 0) const override; // 宣言のみ
+    static bool classof(const MIRNode* node) {return node->getNodeType() == NodeType::BranchInstruction;}
+    void dump(std::ostream& os, const StringInterner& names, int indent = 0) const override; // 宣言のみ
 };
 
 // 条件分岐命令
@@ -37,5 +40,6 @@ public:
     std::shared_ptr<MIRBasicBlock> trueBlock; // 条件が真の場合の分岐先
     std::shared_ptr<MIRBasicBlock> falseBlock; // 条件が偽の場合の分岐先
     explicit MIRConditionBranchInstruction(std::shared_ptr<MIRValue> cond, std::shared_ptr<MIRBasicBlock> trueB, std::shared_ptr<MIRBasicBlock> falseB);
-    void dump(std::ostream& os, int indent = 0) const override; // 宣言のみ
+    static bool classof(const MIRNode* node) {return node->getNodeType() == NodeType::ConditionalBranchInstruction;}
+    void dump(std::ostream& os, const StringInterner& names, int indent = 0) const override; // 宣言のみ
 };
\ No newline at end of file
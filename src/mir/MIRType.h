@@ -1,8 +1,14 @@
 #pragma once
 #include "mir/MIRNode.h"
+#include <cstdint>
+
+class MIRTypeContext;
 
 // MIRの型情報を表すクラス
+// 型はMIRTypeContextで一つずつだけ作るので、同じ型は同じポインタになる (比較はポインタで行う)
+// 配列・ポインタは要素の型・指す先の型へのポインタを持つので、型名を解析しなくても形が分かる
 class MIRType : public MIRNode{
+    friend class MIRTypeContext;
 public:
     enum class TypeID{
         Void,       // 戻り値なし
@@ -15,28 +21,18 @@ public:
         Array,      // 配列型
         Unknown     // 不明な型
     };
-    TypeID id; // 型の識別子
-    std::string name; // 型名("int", "float", "i32", "f32"など)
-    // 指す先の型
-    std::shared_ptr<MIRType> pointeeType;
+    const TypeID id; // 型の識別子
+    const std::string name; // 表示用の型名("int", "f32", "int[5]*"など。ダンプでしか使わない)
+    const uint32_t bitWidth = 0; // 整数・浮動小数点数のビット数
+    // 指す先の型 (ポインタ型)
+    MIRType* const pointeeType = nullptr;
     // 配列用: 要素の型とサイズ
-    std::shared_ptr<MIRType> elementType;
-    size_t arraySize = 0;
-    // 構造体用: メンバ情報
-    std::vector<std::shared_ptr<MIRType>> memberTypes;
-    std::vector<std::string> memberNames;
-    // 変数用
-    explicit MIRType(TypeID typeId, const std::string& typeName = "") : MIRNode(NodeType::Type), id(typeId), name(typeName){}
-    // ポインタ型用
-    MIRType(std::shared_ptr<MIRType> pointee)
-        : MIRNode(NodeType::Type), id(TypeID::Ptr), pointeeType(pointee){
-        name = pointee->name + "*";
-    }
-    // 配列型用
-    MIRType(std::shared_ptr<MIRType> elemType, size_t size)
-        : MIRNode(NodeType::Type), id(TypeID::Array), elementType(elemType), arraySize(size){
-        name = elemType->name + "[" + std::to_string(size) + "]";
-    }
+    MIRType* const elementType = nullptr;
+    const size_t arraySize = 0;
+    // MIRTypeContextの中での通し番号 (LLVMGenが変換したllvm::Typeを引く添字にする)
+    const uint32_t index;
+
+    static bool classof(const MIRNode* node) {return node->getNodeType() == NodeType::Type;}
     bool isInteger() const {return id == TypeID::Int;}
     bool isFloat() const {return id == TypeID::Float;}
     bool isPointer() const {return id == TypeID::Ptr;}
@@ -47,7 +43,12 @@ public:
     bool isArray() const {return id == TypeID::Array;}
     bool isUnknown() const {return id == TypeID::Unknown;}
 
-    void dump(std::ostream& os, int indent = 0) const override {
+    void dump(std::ostream& os, const StringInterner& names, int indent = 0) const override {
         os << name;
     }
-};
\ No newline at end of file
+private:
+    MIRType(uint32_t typeIndex, TypeID typeId, std::string typeName, uint32_t bits = 0,
+            MIRType* pointee = nullptr, MIRType* element = nullptr, size_t size = 0)
+        : MIRNode(NodeType::Type), id(typeId), name(std::move(typeName)), bitWidth(bits),
+          pointeeType(pointee), elementType(element), arraySize(size), index(typeIndex) {}
+};
@@ -0,0 +1,50 @@
+#include "MIRTypeContext.h"
+#include <string>
+
+MIRTypeContext::MIRTypeContext(){
+    voidType = create(MIRType::TypeID::Void, "void");
+    boolType = create(MIRType::TypeID::Bool, "bool", 1);
+    unknownType = create(MIRType::TypeID::Unknown, "unknown");
+    getIntType(64);
+    getIntType(32);
+    getFloatType(64);
+    getFloatType(32);
+}
+
+MIRType* MIRTypeContext::create(MIRType::TypeID id, std::string name, uint32_t bits, MIRType* pointee, MIRType* element, size_t size){
+    auto index = static_cast<uint32_t>(types.size());
+    types.push_back(std::unique_ptr<MIRType>(new MIRType(index, id, std::move(name), bits, pointee, element, size)));
+    return types.back().get();
+}
+
+MIRType* MIRTypeContext::getIntType(uint32_t bits){
+    auto& slot = intTypes[bits];
+    if(!slot){
+        std::string name = bits == 8 ? "char" : bits == 32 ? "i32" : bits == 64 ? "int" : "i" + std::to_string(bits);
+        slot = create(MIRType::TypeID::Int, std::move(name), bits);
+    }
+    return slot;
+}
+
+MIRType* MIRTypeContext::getFloatType(uint32_t bits){
+    auto& slot = floatTypes[bits];
+    if(!slot) slot = create(MIRType::TypeID::Float, bits == 32 ? "f32" : bits == 64 ? "float" : "f" + std::to_string(bits), bits);
+    return slot;
+}
+
+MIRType* MIRTypeContext::getPointerType(MIRType* pointee){
+    auto& slot = pointerTypes[pointee];
+    if(!slot) slot = create(MIRType::TypeID::Ptr, pointee->name + "*", 0, pointee);
+    return slot;
+}
+
+MIRType* MIRTypeContext::getArrayType(MIRType* element, size_t size){
+    auto& slot = arrayTypes[{element, size}];
+    if(!slot) slot = create(MIRType::TypeID::Array, element->name + "[" + std::to_string(size) + "]", 0, nullptr, element, size);
+    return slot;
+}
+
+MIRType* MIRTypeContext::lookupAstType(const TypeNode* type) const {
+    auto it = astTypes.find(type);
+    return it != astTypes.end() ? it->second : nullptr;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "mir/MIRType.h"
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class TypeNode;
+
+// MIRの型を一意に作って持っておく (MIRModuleが持ち、モジュールの命令・値は生ポインタで参照する)
+// TypeContext(ASTの型)と同じく、同じ型は必ず同じポインタになる
+// MIRGenだけが型を作る。LLVMGen・インタプリタは読むだけなので、tier-upのスレッドから参照してもよい
+class MIRTypeContext{
+private:
+    struct ArrayKeyHash{
+        size_t operator()(const std::pair<MIRType*, size_t>& key) const noexcept {
+            return std::hash<MIRType*>()(key.first) ^ (std::hash<size_t>()(key.second) * 31);
+        }
+    };
+    std::vector<std::unique_ptr<MIRType>> types; // MIRType::indexの順
+    std::unordered_map<uint32_t, MIRType*> intTypes; // キーはビット数
+    std::unordered_map<uint32_t, MIRType*> floatTypes;
+    std::unordered_map<MIRType*, MIRType*> pointerTypes; // キーは指す先の型
+    std::unordered_map<std::pair<MIRType*, size_t>, MIRType*, ArrayKeyHash> arrayTypes;
+    std::unordered_map<const TypeNode*, MIRType*> astTypes; // TypeTranslate::toMirTypeの結果 (ASTの型も一意なのでポインタで引ける)
+    MIRType* voidType;
+    MIRType* boolType;
+    MIRType* unknownType;
+    MIRType* create(MIRType::TypeID id, std::string name, uint32_t bits = 0, MIRType* pointee = nullptr, MIRType* element = nullptr, size_t size = 0);
+public:
+    MIRTypeContext();
+    MIRTypeContext(const MIRTypeContext&) = delete;
+    MIRTypeContext& operator=(const MIRTypeContext&) = delete;
+    MIRType* getVoidType() const {return voidType;}
+    MIRType* getBoolType() const {return boolType;}
+    MIRType* getUnknownType() const {return unknownType;}
+    // 8bitはchar、32bitはi32、64bitはint
+    MIRType* getIntType(uint32_t bits);
+    // 32bitはf32、64bitはfloat
+    MIRType* getFloatType(uint32_t bits);
+    MIRType* getPointerType(MIRType* pointee);
+    MIRType* getArrayType(MIRType* element, size_t size);
+    // ASTの型から変換済みのMIRの型 (まだならnullptr)
+    MIRType* lookupAstType(const TypeNode* type) const;
+    void cacheAstType(const TypeNode* type, MIRType* mirType) {astTypes[type] = mirType;}
+    size_t getTypeCount() const {return types.size();}
+};
@@ -1,20 +1,26 @@
 #pragma once
 #include "mir/MIRNode.h"
 #include "mir/MIRType.h"
+#include "common/StringInterner.h"
+#include <cstdint>
 #include <string>
 
 // MIRにおける値の基底クラス
 // レジスタ、リテラル、引数などが継承
 class MIRValue : public MIRNode{
 public:
-    std::shared_ptr<MIRType> type; // 値の型
-    std::string name; // 値の名前 (例: %0, %var)
-    explicit MIRValue(NodeType type, std::shared_ptr<MIRType> valueType, const std::string& valName = "") : MIRNode(type), type(valueType), name(valName) {}
+    static constexpr uint32_t NoId = UINT32_MAX;
+    MIRType* type; // 値の型
+    // 関数の中での通し番号 (レジスタと引数に0から振る。リテラルはNoId)
+    // 名前は持たず、ダンプするときに%0のように書く。LLVMGenなどは番号を添字にした配列で値を引く
+    uint32_t id;
+    explicit MIRValue(NodeType type, MIRType* valueType, uint32_t valueId = NoId) : MIRNode(type), type(valueType), id(valueId) {}
     ~MIRValue() override = default;
+    static bool classof(const MIRNode* node) {return node->getNodeType() >= NodeType::FirstValue && node->getNodeType() <= NodeType::LastValue;}
 
-    void dump(std::ostream& os, int indent = 0) const override {
-        type->dump(os);
-        os << " " << name;
+    void dump(std::ostream& os, const StringInterner& names, int indent = 0) const override {
+        type->dump(os, names);
+        os << " %" << id;
     }
 };
 
@@ -22,10 +28,11 @@ public:
 class MIRLiteralValue : public MIRValue{
 public:
     std::string stringValue; // 値の文字列表現 (例: "3.14", "15", "true")
-    explicit MIRLiteralValue(std::shared_ptr<MIRType> valueType, const std::string& val) : MIRValue(NodeType::LiteralType, valueType, ""), stringValue(val) {}
+    explicit MIRLiteralValue(MIRType* valueType, const std::string& val) : MIRValue(NodeType::LiteralValue, valueType), stringValue(val) {}
+    static bool classof(const MIRNode* node) {return node->getNodeType() == NodeType::LiteralValue;}
 
-    void dump(std::ostream& os, int indent = 0) const override {
-        type->dump(os);
+    void dump(std::ostream& os, const StringInterner& names, int indent = 0) const override {
+        type->dump(os, names);
         os << " " << stringValue;
     }
 };
@@ -33,12 +40,21 @@ public:
 // 命令の結果を格納する一時変数（レジスタ）
 class MIRRegisterValue : public MIRValue{
 public:
-    explicit MIRRegisterValue(std::shared_ptr<MIRType> valueType, const std::string& regName) : MIRValue(NodeType::RegisterValue, valueType, regName) {}
+    explicit MIRRegisterValue(MIRType* valueType, uint32_t regId) : MIRValue(NodeType::RegisterValue, valueType, regId) {}
+    static bool classof(const MIRNode* node) {return node->getNodeType() == NodeType::RegisterValue;}
 };
 
 // 関数の引数
 class MIRArgumentValue : public MIRValue{
 public:
     size_t argIndex; // 引数のインデックス
-    explicit MIRArgumentValue(std::shared_ptr<MIRType> argType, const std::string& argName, size_t index) : MIRValue(NodeType::ArgumentValue, argType, argName), argIndex(index) {}
+    NameId argName; // ソース上の引数名 (ダンプとLLVM IRの名前に使う)
+    explicit MIRArgumentValue(MIRType* argType, NameId name, size_t index, uint32_t argId)
+        : MIRValue(NodeType::ArgumentValue, argType, argId), argIndex(index), argName(name) {}
+    static bool classof(const MIRNode* node) {return node->getNodeType() == NodeType::ArgumentValue;}
+
+    void dump(std::ostream& os, const StringInterner& names, int indent = 0) const override {
+        type->dump(os, names);
+        os << " %" << names.str(argName);
+    }
 };
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+#include "mir/MIRInstruction.h"
+#include "mir/MIRTerminator.h"
+
+// 命令の種類(NodeType)でswitchして、Derivedの具体的な命令のvisitを呼ぶ (CRTP, ast/AstVisitor.hと同じ形)
+// Derivedは全ての命令・終端命令についてvisitを用意する (privateならこのクラスをfriendにする)
+// 知らない種類の命令が来たときはunhandledInstruction/unhandledTerminatorを呼ぶ (Derivedで同じ名前を定義すればエラーを出せる)
+template<typename Derived, typename InstResult = void, typename TermResult = void>
+class MIRVisitor{
+protected:
+    using NodeType = MIRNode::NodeType;
+    InstResult dispatch(MIRInstruction* node){
+        auto* self = static_cast<Derived*>(this);
+        switch(node->getNodeType()){
+            case NodeType::UnaryInstruction: return static_cast<InstResult>(self->visit(static_cast<MIRUnaryInstruction*>(node)));
+            case NodeType::BinaryInstruction: return static_cast<InstResult>(self->visit(static_cast<MIRBinaryInstruction*>(node)));
+            case NodeType::AllocaInstruction: return static_cast<InstResult>(self->visit(static_cast<MIRAllocaInstruction*>(node)));
+            case NodeType::LoadInstruction: return static_cast<InstResult>(self->visit(static_cast<MIRLoadInstruction*>(node)));
+            case NodeType::StoreInstruction: return static_cast<InstResult>(self->visit(static_cast<MIRStoreInstruction*>(node)));
+            case NodeType::CallInstruction: return static_cast<InstResult>(self->visit(static_cast<MIRCallInstruction*>(node)));
+            case NodeType::CastInstruction: return static_cast<InstResult>(self->visit(static_cast<MIRCastInstruction*>(node)));
+            case NodeType::GepInstruction: return static_cast<InstResult>(self->visit(static_cast<MIRGepInstruction*>(node)));
+            default: break;
+        }
+        return self->unhandledInstruction(node);
+    }
+    TermResult dispatch(MIRTerminatorInstruction* node){
+        auto* self = static_cast<Derived*>(this);
+        switch(node->getNodeType()){
+            case NodeType::ReturnInstruction: return static_cast<TermResult>(self->visit(static_cast<MIRReturnInstruction*>(node)));
+            case NodeType::BranchInstruction: return static_cast<TermResult>(self->visit(static_cast<MIRBranchInstruction*>(node)));
+            case NodeType::ConditionalBranchInstruction: return static_cast<TermResult>(self->visit(static_cast<MIRConditionBranchInstruction*>(node)));
+            default: break;
+        }
+        return self->unhandledTerminator(node);
+    }
+    InstResult unhandledInstruction(MIRInstruction*) {return InstResult();}
+    TermResult unhandledTerminator(MIRTerminatorInstruction*) {return TermResult();}
+};
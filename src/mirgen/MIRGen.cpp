@@ -2,25 +2,27 @@
 #include "ast/Definition.h"
 #include "ast/Expression.h"
 #include "ast/Statement.h"
-#include "common/Global.h"
 #include "mir/MIRFunction.h"
 #include "mir/MIRInstruction.h"
 #include "mir/MIRTerminator.h"
 #include "mir/MIRValue.h"
+#include "runtime/RuntimeFunctions.h"
 #include "types/TypeTranslate.h"
+#include <llvm/Support/Casting.h>
 #include <cassert>
 #include <memory>
 
-MIRGen::MIRGen(SemanticAnalysis& sema) // クラス名変更
-    : semanticAnalysis(sema), module(std::make_unique<MIRModule>("LumaMIRModule")) {}
+MIRGen::MIRGen(CompilerInstance& compiler)
+    : names(compiler.getNameTable()), diagnostics(compiler.getDiagnostics()), module(std::make_unique<MIRModule>("LumaMIRModule")), types(*module->types),
+      mainName(names.intern("main")), printName(names.intern("print")), inputName(names.intern("input")) {}
 
-std::unique_ptr<MIRModule> MIRGen::generate(std::shared_ptr<ProgramNode> root) { // クラス名変更
-    visit(root.get());
+std::unique_ptr<MIRModule> MIRGen::generate(ProgramNode* root) { // クラス名変更
+    visit(root);
     return std::move(module);
 }
 
-std::string MIRGen::newRegisterName() {
-    return "%" + std::to_string(tempCounter++);
+uint32_t MIRGen::newRegister() {
+    return currentFunction->newValueId();
 }
 
 
@@ -29,31 +31,40 @@ void MIRGen::setCurrentBlock(std::shared_ptr<MIRBasicBlock> block) { // クラ
     currentBlock = block;
 }
 
-std::shared_ptr<MIRBasicBlock> MIRGen::createBasicBlock(const std::string& name) { // クラス名変更
+std::shared_ptr<MIRBasicBlock> MIRGen::createBasicBlock(const char* name) { // クラス名変更
     auto block = std::make_shared<MIRBasicBlock>(name);
     currentFunction->addBasicBlock(block);
     return block;
 }
 
+void MIRGen::emit(MIRInstruction* inst) {
+    inst->loc = currentLoc;
+    currentBlock->addInstruction(inst);
+}
+
+void MIRGen::terminate(std::shared_ptr<MIRTerminatorInstruction> term) {
+    term->loc = currentLoc;
+    currentBlock->setTerminator(std::move(term));
+}
+
 
 void MIRGen::visit(ProgramNode* node) { // クラス名変更
     // すべての関数定義を処理
     for(const auto& stmt : node->statements){
-        if(auto funcDef = dynamic_cast<FunctionDefNode*>(stmt.get())){
+        if(auto funcDef = llvm::dyn_cast<FunctionDefNode>(stmt)){
             visit(funcDef);
         }
     }
     // main本体生成
     std::shared_ptr<MIRFunction> mainFunc = nullptr;
     for(const auto& func : module->functions){
-        if(func->name == "main"){
+        if(func->name == mainName){
             mainFunc = func;
             break;
         }
     }
     if(!mainFunc){
-        auto mainFuncType = std::make_shared<MIRType>(MIRType::TypeID::Int, "i64");
-        mainFunc = std::make_shared<MIRFunction>("main", mainFuncType);
+        mainFunc = std::make_shared<MIRFunction>(mainName, types.getIntType(64));
         module->functions.insert(module->functions.begin(), mainFunc);
     }
     currentFunction = mainFunc;
@@ -66,17 +77,17 @@ void MIRGen::visit(ProgramNode* node) { // クラス名変更
     setCurrentBlock(entryBlock);
     // main関数スコープ内のグローバルな実行コードを処理
     for(const auto& stmt : node->statements){
-        if(!dynamic_cast<FunctionDefNode*>(stmt.get())){
-            visit(stmt.get());
+        if(!llvm::isa<FunctionDefNode>(stmt)){
+            visit(stmt);
         }
     }
     // main関数の末尾にreturnを追加
     if(!currentBlock->terminator){
         auto mirReturnType = currentFunction->returnType;
         if(!mirReturnType || mirReturnType->isVoid()){
-            errorHandler.errorReg("main function must return an integer.", 0);
+            diagnostics.errorReg("main function must return an integer.", 0);
         }else{
-            currentBlock->setTerminator(std::make_shared<MIRReturnInstruction>(
+            terminate(std::make_shared<MIRReturnInstruction>(
                 std::make_shared<MIRLiteralValue>(mirReturnType, "0")
             ));
         }
@@ -85,21 +96,20 @@ void MIRGen::visit(ProgramNode* node) { // クラス名変更
 }
 
 void MIRGen::visit(StatementNode* node) { // クラス名変更
-    if (auto funcDef = dynamic_cast<FunctionDefNode*>(node)) return; // ProgramNodeで処理
-    else if (auto varNode = dynamic_cast<VarDeclNode*>(node)) visit(varNode);
-    else if (auto assignmentNode = dynamic_cast<AssignmentNode*>(node)) visit(assignmentNode);
-    else if (auto ifNode = dynamic_cast<IfNode*>(node)) visit(ifNode);
-    else if (auto forNode = dynamic_cast<ForNode*>(node)) visit(forNode);
-    else if (auto exprStmtNode = dynamic_cast<ExprStatementNode*>(node)) visit(exprStmtNode);
-    else if (auto returnNode = dynamic_cast<ReturnNode*>(node)) visit(returnNode);
-    else if (auto arrayNode = dynamic_cast<ArrayDeclNode*>(node)) visit(arrayNode);
-    else 
-        errorHandler.errorReg("Unknown Statement visited in MIRGen.", 0);
+    if (llvm::isa<FunctionDefNode>(node)) return; // ProgramNodeで処理
+    SourceLocation prevLoc = currentLoc;
+    if (node->getLocation().isValid()) currentLoc = node->getLocation();
+    dispatch(node);
+    currentLoc = prevLoc;
+}
+
+void MIRGen::unhandledStatement(StatementNode* node) {
+    diagnostics.errorReg("Unknown Statement visited in MIRGen.", 0);
 }
 
 void MIRGen::visit(BlockNode* node) {
     for (const auto& stmt : node->statements) {
-        visit(stmt.get());
+        visit(stmt);
     }
 }
 
@@ -107,18 +117,21 @@ void MIRGen::visit(FunctionDefNode* node) {
     // コンテキスト保存
     auto prevFunction = currentFunction;
     auto prevBlock = currentBlock;
+    auto prevLoc = currentLoc;
+    currentLoc = node->getLocation(); // 引数の処理と暗黙のreturnは関数の位置にする
     // MIRFunction作成
-    auto returnMirType = TypeTranslate::toMirType(node->returnType.get());
+    auto returnMirType = toMirType(node->returnType);
     auto func = std::make_shared<MIRFunction>(node->name, returnMirType);
+    func->loc = node->getLocation();
     module->addFunction(func);
     currentFunction = func;
     // エントリーブロック作成
     auto entryBlock = createBasicBlock("entry");
     setCurrentBlock(entryBlock);
     // 関数シンボル取得
-    auto funcSymbol = std::dynamic_pointer_cast<FuncSymbol>(node->symbol);
+    FuncSymbol* funcSymbol = node->symbol;
     if(!funcSymbol){
-        errorHandler.errorReg("Function symbol not found for " + node->name, 0);
+        diagnostics.errorReg("Function symbol not found for " + names.str(node->name), 0);
         return;
     }
     // 引数処理
@@ -127,133 +140,137 @@ void MIRGen::visit(FunctionDefNode* node) {
         const auto& argName = node->args[i];
         const auto& argTypeNode = node->argTypes[i];
         auto paramSymbol = funcSymbol->parameters[i];
-        auto argMirType = TypeTranslate::toMirType(argTypeNode.get());
-        auto mirArgument = std::make_shared<MIRArgumentValue>(argMirType, "%" + argName, i);
+        auto argMirType = toMirType(argTypeNode);
+        auto mirArgument = std::make_shared<MIRArgumentValue>(argMirType, argName, i, currentFunction->newValueId());
         currentFunction->addArgument(mirArgument);
-        auto ptrType = std::make_shared<MIRType>(MIRType::TypeID::Ptr, argMirType->name + "*");
-        auto allocaInst = std::make_shared<MIRAllocaInstruction>(
-            argMirType, argName, ptrType, newRegisterName()
+        auto ptrType = types.getPointerType(argMirType);
+        auto allocaInst = createInstruction<MIRAllocaInstruction>(
+            argMirType, argName, ptrType, newRegister()
         );
-        entryBlock->instructions.insert(entryBlock->instructions.begin(), allocaInst);
+        allocaInst->loc = currentLoc;
+        entryBlock->insert(entryBlock->instructions.begin(), allocaInst);
         symbolValueMap[paramSymbol] = allocaInst->result;
-        auto storeInst = std::make_shared<MIRStoreInstruction>(mirArgument, allocaInst->result);
-        currentBlock->addInstruction(storeInst);
+        auto storeInst = createInstruction<MIRStoreInstruction>(mirArgument, allocaInst->result);
+        emit(storeInst);
     }
     // 関数本体のコード作成
-    visit(node->body.get());
+    visit(node->body);
     // return処理
     if(!currentBlock->terminator){
         if(currentFunction->returnType->isVoid()){
-            currentBlock->setTerminator(std::make_shared<MIRReturnInstruction>());
+            terminate(std::make_shared<MIRReturnInstruction>());
         }else{
-            errorHandler.errorReg("Function '" + node->name + "' has non-void return type but no return statement.", 0);
+            diagnostics.errorReg("Function '" + names.str(node->name) + "' has non-void return type but no return statement.", 0);
             auto defaultValue = std::make_shared<MIRLiteralValue>(currentFunction->returnType, "0");
-            currentBlock->setTerminator(std::make_shared<MIRReturnInstruction>(defaultValue));
+            terminate(std::make_shared<MIRReturnInstruction>(defaultValue));
             return;
         }
     }
     // コンテキスト復元
     currentFunction = prevFunction;
     currentBlock = prevBlock;
+    currentLoc = prevLoc;
 }
 
 void MIRGen::visit(VarDeclNode* node) { 
-    auto varMirType = TypeTranslate::toMirType(node->type.get());
+    auto varMirType = toMirType(node->type);
     if (!varMirType || varMirType->id == MIRType::TypeID::Unknown) {
         return;
     }
 
     auto entryBlock = currentFunction->basicBlocks.front();
 
-    auto ptrType = std::make_shared<MIRType>(MIRType::TypeID::Ptr, varMirType->name + "*");
-    auto allocaInst = std::make_shared<MIRAllocaInstruction>(
-        varMirType, node->varName, ptrType, newRegisterName()
+    auto ptrType = types.getPointerType(varMirType);
+    auto allocaInst = createInstruction<MIRAllocaInstruction>(
+        varMirType, node->varName, ptrType, newRegister()
     );
 
-    entryBlock->instructions.insert(entryBlock->instructions.begin(), allocaInst);
+    allocaInst->loc = currentLoc;
+    entryBlock->insert(entryBlock->instructions.begin(), allocaInst);
 
     auto symbol = node->symbol;
     if (symbol) {
         symbolValueMap[symbol] = allocaInst->result;
     } else {
-        errorHandler.errorReg("Symbol not attached to VarDeclNode for: " + node->varName, 0);
+        diagnostics.errorReg("Symbol not attached to VarDeclNode for: " + names.str(node->varName), 0);
         return;
     }
 
     if (node->initializer) {
-        if (auto arrayLit = dynamic_cast<ArrayLiteralNode*>(node->initializer.get())) {
+        if (auto arrayLit = llvm::dyn_cast<ArrayLiteralNode>(node->initializer)) {
             // 配列リテラルによる初期化
             for (size_t i = 0; i < arrayLit->elem.size(); ++i) {
-                auto indexValue = std::make_shared<MIRLiteralValue>(std::make_shared<MIRType>(MIRType::TypeID::Int, "int"), std::to_string(i));
-                auto gepInst = std::make_shared<MIRGepInstruction>(
+                auto indexValue = std::make_shared<MIRLiteralValue>(types.getIntType(64), std::to_string(i));
+                auto gepInst = createInstruction<MIRGepInstruction>(
                     allocaInst->result,
                     indexValue,
-                    TypeTranslate::toMirType(arrayLit->elem[i]->type.get()),
+                    toMirType(arrayLit->elem[i]->type),
                     varMirType,
-                    newRegisterName()
+                    newRegister()
                 );
-                currentBlock->addInstruction(gepInst);
+                emit(gepInst);
                 
-                std::shared_ptr<MIRValue> elementValue = visit(arrayLit->elem[i].get());
-                auto storeInst = std::make_shared<MIRStoreInstruction>(elementValue, gepInst->result);
-                currentBlock->addInstruction(storeInst);
+                std::shared_ptr<MIRValue> elementValue = visit(arrayLit->elem[i]);
+                auto storeInst = createInstruction<MIRStoreInstruction>(elementValue, gepInst->result);
+                emit(storeInst);
             }
         } else {
             // 通常の式による初期化
-            std::shared_ptr<MIRValue> initValue = visit(node->initializer.get());
+            std::shared_ptr<MIRValue> initValue = visit(node->initializer);
             if (initValue) {
-                auto storeInst = std::make_shared<MIRStoreInstruction>(initValue, allocaInst->result);
-                currentBlock->addInstruction(storeInst);
+                auto storeInst = createInstruction<MIRStoreInstruction>(initValue, allocaInst->result);
+                emit(storeInst);
             }
         }
     }
 }
 
 void MIRGen::visit(ArrayDeclNode *node){
-    auto arrMirType = TypeTranslate::toMirType(node->type.get());
+    auto arrMirType = toMirType(node->type);
     if(!arrMirType || arrMirType->id == MIRType::TypeID::Unknown){
         return;
     }
     auto entryBlock = currentFunction->basicBlocks.front();
-    auto ptrType = std::make_shared<MIRType>(MIRType::TypeID::Ptr, arrMirType->name + "*");
-    auto allocaInst = std::make_shared<MIRAllocaInstruction>(
-        arrMirType, node->arrayName, ptrType, newRegisterName(), node->size
+    auto ptrType = types.getPointerType(arrMirType);
+    auto allocaInst = createInstruction<MIRAllocaInstruction>(
+        arrMirType, node->arrayName, ptrType, newRegister(), node->size
     );
 
-    entryBlock->instructions.insert(entryBlock->instructions.begin(), allocaInst);
+    allocaInst->loc = currentLoc;
+    entryBlock->insert(entryBlock->instructions.begin(), allocaInst);
     
     auto symbol = node->symbol;
     if(symbol){
         symbolValueMap[symbol] = allocaInst->result;
     }else{
-        errorHandler.errorReg("Symbol not attached to ArrayDeclNode for: " + node->arrayName, 0);
+        diagnostics.errorReg("Symbol not attached to ArrayDeclNode for: " + names.str(node->arrayName), 0);
         return;
     }
     // TODO: 初期化式(配列リテラルを作ってから)
 }
 
 void MIRGen::visit(AssignmentNode* node) {
-    std::shared_ptr<MIRValue> val = visit(node->value.get());
+    std::shared_ptr<MIRValue> val = visit(node->value);
     if (!val) {
-        errorHandler.errorReg("Assignment of empty expression to variable '" + node->varName + "'", 0);
+        diagnostics.errorReg("Assignment of empty expression to variable '" + names.str(node->varName) + "'", 0);
         return;
     }
 
     auto symbol = node->symbol;
     if (!symbol || !symbolValueMap.count(symbol)) {
-        errorHandler.errorReg("Assignment to undeclared variable '" + node->varName + "'", 0);
+        diagnostics.errorReg("Assignment to undeclared variable '" + names.str(node->varName) + "'", 0);
         return;
     }
     
     std::shared_ptr<MIRValue> varAddress = symbolValueMap[symbol];
-    auto storeInst = std::make_shared<MIRStoreInstruction>(val, varAddress);
-    currentBlock->addInstruction(storeInst);
+    auto storeInst = createInstruction<MIRStoreInstruction>(val, varAddress);
+    emit(storeInst);
 }
 
 void MIRGen::visit(IfNode* node) {
-    std::shared_ptr<MIRValue> conditionValue = visit(node->condition.get());
+    std::shared_ptr<MIRValue> conditionValue = visit(node->condition);
     if (!conditionValue) {
-        errorHandler.errorReg("The condition expression of if is an unknown expression.", 1);
+        diagnostics.errorReg("The condition expression of if is an unknown expression.", 1);
         return;
     }
 
@@ -264,20 +281,20 @@ void MIRGen::visit(IfNode* node) {
     node->elseBlock = elseBlock.get();
     node->mergeBlock = mergeBlock.get();
 
-    currentBlock->setTerminator(std::make_shared<MIRConditionBranchInstruction>(conditionValue, thenBlock, elseBlock));
+    terminate(std::make_shared<MIRConditionBranchInstruction>(conditionValue, thenBlock, elseBlock));
 
     setCurrentBlock(thenBlock);
-    visit(node->if_block.get());
+    visit(node->if_block);
     if (!currentBlock->terminator) {
-        currentBlock->setTerminator(std::make_shared<MIRBranchInstruction>(mergeBlock));
+        terminate(std::make_shared<MIRBranchInstruction>(mergeBlock));
     }
 
     setCurrentBlock(elseBlock);
     if (node->else_block) {
-        visit(node->else_block.get());
+        visit(node->else_block);
     }
     if (!currentBlock->terminator) {
-        currentBlock->setTerminator(std::make_shared<MIRBranchInstruction>(mergeBlock));
+        terminate(std::make_shared<MIRBranchInstruction>(mergeBlock));
     }
 
     setCurrentBlock(mergeBlock);
@@ -288,20 +305,20 @@ void MIRGen::visit(ForNode* node) {
     std::shared_ptr<MIRBasicBlock> loopBody = createBasicBlock("for.body");
     std::shared_ptr<MIRBasicBlock> loopEnd = createBasicBlock("for.end");
 
-    currentBlock->setTerminator(std::make_shared<MIRBranchInstruction>(loopHeader));
+    terminate(std::make_shared<MIRBranchInstruction>(loopHeader));
 
     setCurrentBlock(loopHeader);
-    std::shared_ptr<MIRValue> conditionValue = visit(node->condition.get());
+    std::shared_ptr<MIRValue> conditionValue = visit(node->condition);
     if (!conditionValue) {
-        errorHandler.errorReg("The condition expression of for is an unknown expression.", 1);
+        diagnostics.errorReg("The condition expression of for is an unknown expression.", 1);
         return;
     }
-    currentBlock->setTerminator(std::make_shared<MIRConditionBranchInstruction>(conditionValue, loopBody, loopEnd));
+    terminate(std::make_shared<MIRConditionBranchInstruction>(conditionValue, loopBody, loopEnd));
 
     setCurrentBlock(loopBody);
-    visit(node->block.get());
+    visit(node->block);
     if (!currentBlock->terminator) {
-        currentBlock->setTerminator(std::make_shared<MIRBranchInstruction>(loopHeader));
+        terminate(std::make_shared<MIRBranchInstruction>(loopHeader));
     }
 
     setCurrentBlock(loopEnd);
@@ -309,64 +326,64 @@ void MIRGen::visit(ForNode* node) {
 
 void MIRGen::visit(ReturnNode* node) {
     if (node->returnValue) {
-        std::shared_ptr<MIRValue> retVal = visit(node->returnValue.get());
-        currentBlock->setTerminator(std::make_shared<MIRReturnInstruction>(retVal));
+        std::shared_ptr<MIRValue> retVal = visit(node->returnValue);
+        terminate(std::make_shared<MIRReturnInstruction>(retVal));
     } else {
-        currentBlock->setTerminator(std::make_shared<MIRReturnInstruction>());
+        terminate(std::make_shared<MIRReturnInstruction>());
     }
 }
 
 void MIRGen::visit(ExprStatementNode* node) {
     if (node->expression) {
-        visit(node->expression.get());
+        visit(node->expression);
     }
 }
 
 std::shared_ptr<MIRValue> MIRGen::visit(ExprNode* node) {
-    if (auto cnode = dynamic_cast<NumberLiteralNode*>(node)) return visit(cnode);
-    if (auto cnode = dynamic_cast<DecimalLiteralNode*>(node)) return visit(cnode);
-    if (auto cnode = dynamic_cast<BinaryOpNode*>(node)) return visit(cnode);
-    if (auto cnode = dynamic_cast<VariableRefNode*>(node)) return visit(cnode);
-    if (auto cnode = dynamic_cast<FunctionCallNode*>(node)) return visit(cnode);
-    if (auto cnode = dynamic_cast<CastNode*>(node)) return visit(cnode);
-    if (auto cnode = dynamic_cast<ArrayRefNode*>(node)) return visit(cnode); // 追加
-    
-    errorHandler.errorReg("Unknown ExprNode visited in MIRGen.", 0);
+    SourceLocation prevLoc = currentLoc;
+    if (node->getLocation().isValid()) currentLoc = node->getLocation();
+    auto value = dispatch(node);
+    currentLoc = prevLoc;
+    return value;
+}
+
+std::shared_ptr<MIRValue> MIRGen::unhandledExpr(ExprNode* node) {
+    diagnostics.errorReg("Unknown ExprNode visited in MIRGen.", 0);
     return nullptr;
 }
 
 std::shared_ptr<MIRValue> MIRGen::visit(NumberLiteralNode* node) {
-    return std::make_shared<MIRLiteralValue>(TypeTranslate::toMirType(node->type.get()), std::to_string(node->value));
+    return std::make_shared<MIRLiteralValue>(toMirType(node->type), std::to_string(node->value));
 }
 
 std::shared_ptr<MIRValue> MIRGen::visit(DecimalLiteralNode* node) {
-    return std::make_shared<MIRLiteralValue>(TypeTranslate::toMirType(node->type.get()), std::to_string(node->value));
+    return std::make_shared<MIRLiteralValue>(toMirType(node->type), std::to_string(node->value));
 }
 
 std::shared_ptr<MIRValue> MIRGen::visit(ArrayLiteralNode *node){
-    auto arrayType = TypeTranslate::toMirType(node->type.get());
-    auto elementType = TypeTranslate::toMirType(node->elem[0]->type.get());
+    auto arrayType = toMirType(node->type);
+    auto elementType = toMirType(node->elem[0]->type);
     size_t arraySize = node->elem.size();
     // スタックに確保
-    auto arrayPtrType = std::make_shared<MIRType>(arrayType);
-    auto allocaInst = std::make_shared<MIRAllocaInstruction>(
-        arrayType, "arrayLit", arrayPtrType, newRegisterName(), arraySize
+    auto arrayPtrType = types.getPointerType(arrayType);
+    auto allocaInst = createInstruction<MIRAllocaInstruction>(
+        arrayType, names.intern("arrayLit"), arrayPtrType, newRegister(), arraySize
     );
-    currentBlock->addInstruction(allocaInst);
+    emit(allocaInst);
     std::shared_ptr<MIRValue> arrayPtr = allocaInst->result;
     for(size_t i = 0;i < node->elem.size();i++){
-        auto indexValue = std::make_shared<MIRLiteralValue>(std::make_shared<MIRType>(MIRType::TypeID::Int, "int"), std::to_string(i));
-        auto gepInst = std::make_shared<MIRGepInstruction>(
+        auto indexValue = std::make_shared<MIRLiteralValue>(types.getIntType(64), std::to_string(i));
+        auto gepInst = createInstruction<MIRGepInstruction>(
             arrayPtr,
             indexValue,
             elementType,
             arrayType,
-            newRegisterName()
+            newRegister()
         );
-        currentBlock->addInstruction(gepInst);
-        std::shared_ptr<MIRValue> elementValue = visit(node->elem[i].get());
-        auto storeInst = std::make_shared<MIRStoreInstruction>(elementValue, gepInst->result);
-        currentBlock->addInstruction(storeInst);
+        emit(gepInst);
+        std::shared_ptr<MIRValue> elementValue = visit(node->elem[i]);
+        auto storeInst = createInstruction<MIRStoreInstruction>(elementValue, gepInst->result);
+        emit(storeInst);
     }
     return arrayPtr;
 }
@@ -374,133 +391,122 @@ std::shared_ptr<MIRValue> MIRGen::visit(ArrayLiteralNode *node){
 std::shared_ptr<MIRValue> MIRGen::visit(VariableRefNode* node) {
     auto symbol = node->symbol;
     if (!symbol || !symbolValueMap.count(symbol)) {
-        errorHandler.errorReg("Undefined variable reference: " + node->name, 0);
+        diagnostics.errorReg("Undefined variable reference: " + names.str(node->name), 0);
         return nullptr;
     }
     std::shared_ptr<MIRValue> varAddress = symbolValueMap[symbol];
-    auto loadInst = std::make_shared<MIRLoadInstruction>(varAddress, TypeTranslate::toMirType(node->type.get()), newRegisterName());
-    currentBlock->addInstruction(loadInst);
+    auto loadInst = createInstruction<MIRLoadInstruction>(varAddress, toMirType(node->type), newRegister());
+    emit(loadInst);
     return loadInst->result;
 }
 
 std::shared_ptr<MIRValue> MIRGen::visit(ArrayRefNode *node){
     auto symbol = node->symbol;
     if (!symbol || !symbolValueMap.count(symbol)) {
-        errorHandler.errorReg("Undefined variable reference: " + node->name, 0);
+        diagnostics.errorReg("Undefined variable reference: " + names.str(node->name), 0);
         return nullptr;
     }
     std::shared_ptr<MIRValue> arrayAddress = symbolValueMap[symbol];
     std::shared_ptr<MIRValue> indexValue = nullptr;
-    if(auto* numLit = dynamic_cast<NumberLiteralNode*>(node->idx.get())){
+    if(auto* numLit = llvm::dyn_cast<NumberLiteralNode>(node->idx)){
         indexValue = visit(numLit);
     }else{
-        indexValue = visit(node->idx.get());
+        indexValue = visit(node->idx);
     }
     if(!indexValue){
-        errorHandler.errorReg("Invalid array index expression.", 0);
+        diagnostics.errorReg("Invalid array index expression.", 0);
         return nullptr;
     }
-    auto elementType = TypeTranslate::toMirType(node->type.get());
-    // arrayAddress の型は int[5]*
-    // ここから int[5] を抽出する
-    std::shared_ptr<MIRType> arrayPtrType = arrayAddress->type; // int[5]*
-    std::string arrayPtrTypeName = arrayPtrType->name; // "int[5]*"
-    size_t starPos = arrayPtrTypeName.rfind('*');
-    std::string arrayTypeName = arrayPtrTypeName.substr(0, starPos); // "int[5]"
-    // arrayTypeName は "int[5]" の形式
-    // ここから要素型 "int" とサイズ "5" をパースする
-    size_t openBracketPos = arrayTypeName.find('[');
-    size_t closeBracketPos = arrayTypeName.find(']');
-    std::string elementTypeName = arrayTypeName.substr(0, openBracketPos); // "int"
-    std::string arraySizeStr = arrayTypeName.substr(openBracketPos + 1, closeBracketPos - (openBracketPos + 1)); // "5"
-    size_t arraySize = std::stoul(arraySizeStr); // 5
-
-    std::shared_ptr<MIRType> arrayElementType = std::make_shared<MIRType>(getMirTypeIDFromString(elementTypeName), elementTypeName); // int
-    std::shared_ptr<MIRType> ptrOrArrayType = std::make_shared<MIRType>(arrayElementType, arraySize); // int[5]
-
-    auto gepInst = std::make_shared<MIRGepInstruction>(
+    auto elementType = toMirType(node->type);
+    // arrayAddress の型は int[5]* なので、指す先の配列型をそのまま使う
+    MIRType* ptrOrArrayType = arrayAddress->type->pointeeType; // int[5]
+    if(!ptrOrArrayType || !ptrOrArrayType->isArray()){
+        diagnostics.errorReg("Array reference to a non-array value: " + names.str(node->name), 0);
+        return nullptr;
+    }
+
+    auto gepInst = createInstruction<MIRGepInstruction>(
         arrayAddress,
         indexValue,
         elementType, // int
         ptrOrArrayType, // int[5]
-        newRegisterName()
+        newRegister()
     );
-    currentBlock->addInstruction(gepInst);
-    auto loadInst = std::make_shared<MIRLoadInstruction>(
+    emit(gepInst);
+    auto loadInst = createInstruction<MIRLoadInstruction>(
         gepInst->result,
         elementType,
-        newRegisterName()
+        newRegister()
     );
-    currentBlock->addInstruction(loadInst);
+    emit(loadInst);
     return loadInst->result;
 }
 
 
 
 std::shared_ptr<MIRValue> MIRGen::visit(BinaryOpNode* node) {
-    std::shared_ptr<MIRValue> lval = visit(node->left.get());
-    std::shared_ptr<MIRValue> rval = visit(node->right.get());
+    std::shared_ptr<MIRValue> lval = visit(node->left);
+    std::shared_ptr<MIRValue> rval = visit(node->right);
     if (!lval || !rval) return nullptr;
 
-    std::string op_str;
-    bool isFloat = lval->type->isFloat();
-
-    if (node->op == "+") { op_str = isFloat ? "fadd" : "add"; }
-    else if (node->op == "-") { op_str = isFloat ? "fsub" : "sub"; }
-    else if (node->op == "*") { op_str = isFloat ? "fmul" : "mul"; }
-    else if (node->op == "/") { op_str = isFloat ? "fdiv" : "sdiv"; }
-    else if (node->op == "==") { op_str = isFloat ? "fcmp eq" : "icmp eq"; }
-    else if (node->op == "!=") { op_str = isFloat ? "fcmp ne" : "icmp ne"; }
-    else if (node->op == "<") { op_str = isFloat ? "fcmp lt" : "icmp lt"; }
-    else if (node->op == ">") { op_str = isFloat ? "fcmp gt" : "icmp gt"; }
-    else if (node->op == "<=") { op_str = isFloat ? "fcmp le" : "icmp le"; }
-    else if (node->op == ">=") { op_str = isFloat ? "fcmp ge" : "icmp ge"; }
+    MIROpcode opcode;
+    if (node->op == "+") { opcode = MIROpcode::Add; }
+    else if (node->op == "-") { opcode = MIROpcode::Sub; }
+    else if (node->op == "*") { opcode = MIROpcode::Mul; }
+    else if (node->op == "/") { opcode = MIROpcode::SDiv; }
+    else if (node->op == "==") { opcode = MIROpcode::ICmpEq; }
+    else if (node->op == "!=") { opcode = MIROpcode::ICmpNe; }
+    else if (node->op == "<") { opcode = MIROpcode::ICmpLt; }
+    else if (node->op == ">") { opcode = MIROpcode::ICmpGt; }
+    else if (node->op == "<=") { opcode = MIROpcode::ICmpLe; }
+    else if (node->op == ">=") { opcode = MIROpcode::ICmpGe; }
     else {
-        errorHandler.errorReg("Unknown operator: " + node->op, 0);
+        diagnostics.errorReg("Unknown operator: " + node->op, 0);
         return nullptr;
     }
+    opcode = selectOpcode(opcode, lval->type->isFloat());
 
-    auto binInst = std::make_shared<MIRBinaryInstruction>(op_str, lval, rval, TypeTranslate::toMirType(node->type.get()), newRegisterName());
-    currentBlock->addInstruction(binInst);
+    auto binInst = createInstruction<MIRBinaryInstruction>(opcode, lval, rval, toMirType(node->type), newRegister());
+    emit(binInst);
     return binInst->result;
 }
 
 std::shared_ptr<MIRValue> MIRGen::visit(FunctionCallNode* node) {
-    std::vector<std::shared_ptr<MIRValue>> args;
-    for (const auto& argExpr : node->args) {
-        args.push_back(visit(argExpr.get()));
+    // PrintとInput (値は返さない)
+    if (node->calleeName == printName) {
+        if (node->args.size() != 1) return nullptr;
+        if (auto value = visit(node->args[0])) emitPrint(value);
+        return nullptr;
     }
-
-    // PrintとInput
-    if (node->calleeName == "print") {
-        auto callInst = std::make_shared<MIRCallInstruction>("printf", args, std::make_shared<MIRType>(MIRType::TypeID::Int, "i32"), newRegisterName());
-        currentBlock->addInstruction(callInst);
-        return callInst->result;
+    if (node->calleeName == inputName) {
+        auto target = node->args.size() == 1 ? llvm::dyn_cast<VariableRefNode>(node->args[0]) : nullptr;
+        if (target) emitInput(target);
+        return nullptr;
     }
-    if (node->calleeName == "input") {
-        auto callInst = std::make_shared<MIRCallInstruction>("scanf", args, std::make_shared<MIRType>(MIRType::TypeID::Int, "i32"), newRegisterName());
-        currentBlock->addInstruction(callInst);
-        return callInst->result;
+
+    std::vector<std::shared_ptr<MIRValue>> args;
+    for (const auto& argExpr : node->args) {
+        args.push_back(visit(argExpr));
     }
 
     // 通常の関数呼び出し
-    auto funcSymbol = std::dynamic_pointer_cast<FuncSymbol>(node->symbol);
+    FuncSymbol* funcSymbol = node->symbol;
     if (!funcSymbol) {
-        errorHandler.errorReg("Call to undefined function: " + node->calleeName, 0);
+        diagnostics.errorReg("Call to undefined function: " + names.str(node->calleeName), 0);
         return nullptr;
     }
-    auto callInst = std::make_shared<MIRCallInstruction>(node->calleeName, args, TypeTranslate::toMirType(node->type.get()), newRegisterName());
-    currentBlock->addInstruction(callInst);
+    auto callInst = createInstruction<MIRCallInstruction>(node->calleeName, args, toMirType(node->type), newRegister());
+    emit(callInst);
     return callInst->result;
 }
 
 std::shared_ptr<MIRValue> MIRGen::visit(CastNode* node) { // クラス名変更
-    std::shared_ptr<MIRValue> operand = visit(node->expression.get());
+    std::shared_ptr<MIRValue> operand = visit(node->expression);
     if (!operand) return nullptr;
 
-    std::shared_ptr<MIRType> targetType = TypeTranslate::toMirType(node->type.get());
+    MIRType* targetType = toMirType(node->type);
     if (!targetType || targetType->id == MIRType::TypeID::Unknown) {
-        errorHandler.errorReg("Invalid target type for cast.", 0);
+        diagnostics.errorReg("Invalid target type for cast.", 0);
         return nullptr;
     }
 
@@ -522,21 +528,62 @@ std::shared_ptr<MIRValue> MIRGen::visit(CastNode* node) { // クラス名変更
     } else if (sourceType->isPointer() && targetType->isPointer()) {
         castOp = CastOpcode::PtrCast;
     } else {
-        errorHandler.errorReg("Unsupported cast operation in MIRGen.", 0);
+        diagnostics.errorReg("Unsupported cast operation in MIRGen.", 0);
         return nullptr;
     }
 
-    auto castInst = std::make_shared<MIRCastInstruction>(castOp, operand, targetType, newRegisterName());
-    currentBlock->addInstruction(castInst);
+    auto castInst = createInstruction<MIRCastInstruction>(castOp, operand, targetType, newRegister());
+    emit(castInst);
+    return castInst->result;
+}
+
+std::shared_ptr<MIRValue> MIRGen::convert(std::shared_ptr<MIRValue> value, CastOpcode op, MIRType* targetType) {
+    if (value->type == targetType) return value;
+    auto castInst = createInstruction<MIRCastInstruction>(op, value, targetType, newRegister());
+    emit(castInst);
     return castInst->result;
 }
 
-MIRType::TypeID MIRGen::getMirTypeIDFromString(const std::string& typeName){
-    if (typeName == "int") return MIRType::TypeID::Int;
-    if (typeName == "float") return MIRType::TypeID::Float;
-    if (typeName == "void") return MIRType::TypeID::Void;
-    if (typeName == "bool") return MIRType::TypeID::Bool;
-    // 他の型も必要に応じて追加
-    errorHandler.errorReg("Unknown MIRTypeID for string: " + typeName, 0);
-    return MIRType::TypeID::Void; // エラー時のデフォルト値
+void MIRGen::emitPrint(std::shared_ptr<MIRValue> value) {
+    const char* callee;
+    if (value->type->isBool()) {
+        callee = RuntimePrintBool;
+    } else if (value->type->isInteger()) {
+        callee = RuntimePrintInt;
+        value = convert(value, CastOpcode::IntCast, types.getIntType(64));
+    } else if (value->type->isFloat()) {
+        callee = RuntimePrintFloat;
+        value = convert(value, CastOpcode::FPCast, types.getFloatType(64));
+    } else {
+        diagnostics.errorReg("print: unsupported argument type.", 0);
+        return;
+    }
+    emit(createInstruction<MIRCallInstruction>(names.intern(callee), std::vector<std::shared_ptr<MIRValue>>{value}, nullptr));
+}
+
+void MIRGen::emitInput(VariableRefNode* target) {
+    auto symbol = target->symbol;
+    if (!symbol || !symbolValueMap.count(symbol)) {
+        diagnostics.errorReg("Undefined variable reference: " + names.str(target->name), 0);
+        return;
+    }
+    MIRType* varType = toMirType(target->type);
+    std::shared_ptr<MIRValue> value;
+    if (varType && varType->isInteger()) {
+        auto callInst = createInstruction<MIRCallInstruction>(names.intern(RuntimeInputInt), std::vector<std::shared_ptr<MIRValue>>{}, types.getIntType(64), newRegister());
+        emit(callInst);
+        value = convert(callInst->result, CastOpcode::IntCast, varType);
+    } else if (varType && varType->isFloat()) {
+        auto callInst = createInstruction<MIRCallInstruction>(names.intern(RuntimeInputFloat), std::vector<std::shared_ptr<MIRValue>>{}, types.getFloatType(64), newRegister());
+        emit(callInst);
+        value = convert(callInst->result, CastOpcode::FPCast, varType);
+    } else {
+        diagnostics.errorReg("input: unsupported variable type.", 0);
+        return;
+    }
+    emit(createInstruction<MIRStoreInstruction>(value, symbolValueMap[symbol]));
+}
+
+MIRType* MIRGen::toMirType(TypeNode* type){
+    return TypeTranslate::toMirType(type, types);
 }
@@ -3,6 +3,7 @@
 #include <memory>
 #include <string>
 #include <map>
+#include <unordered_map>
 
 // MIRヘッダー
 #include "mir/MIRModule.h"
@@ -11,42 +12,61 @@
 #include "mir/MIRInstruction.h"
 #include "mir/MIRTerminator.h"
 #include "mir/MIRType.h"
+#include "mir/MIRTypeContext.h"
 #include "mir/MIRValue.h"
 
 // ASTヘッダー
 #include "../ast/AstNode.h"
+#include "../ast/AstVisitor.h"
 #include "../ast/Statement.h"
 #include "../ast/Expression.h"
 #include "../ast/Definition.h"
 
 // セマンティック解析ヘッダー
 #include "../semantic/SemanticAnalysis.h"
+#include "../driver/CompilerInstance.h"
 #include "../types/Type.h" // TypeNode用
 
-class MIRGen {
+class MIRGen : public AstVisitor<MIRGen, std::shared_ptr<MIRValue>> {
+    friend class AstVisitor<MIRGen, std::shared_ptr<MIRValue>>;
 public:
-    MIRGen(SemanticAnalysis& sema);
+    explicit MIRGen(CompilerInstance& compiler);
 
     // MIR生成のトップレベル関数
-    std::unique_ptr<MIRModule> generate(std::shared_ptr<ProgramNode> root);
+    std::unique_ptr<MIRModule> generate(ProgramNode* root);
 
 private:
     // 状態管理
-    SemanticAnalysis& semanticAnalysis; // セマンティック解析への参照
+    StringInterner& names; // 組み込み関数の名前の登録先 (エラーメッセージの名前もここから引く)
+    ErrorHandler& diagnostics; // エラーの登録先
     std::unique_ptr<MIRModule> module; // 生成中のMIRモジュール
+    MIRTypeContext& types; // moduleの型
     std::shared_ptr<MIRFunction> currentFunction = nullptr; // 現在処理中の関数
     std::shared_ptr<MIRBasicBlock> currentBlock = nullptr; // 現在命令を追加中の基本ブロック
+    SourceLocation currentLoc; // 今生成している文・式の位置 (生成する命令に付ける)
+    NameId mainName, printName, inputName; // 特別扱いする関数名
     
     // ASTシンボルとMIRの値（メモリアドレス）のマッピング
-    std::map<std::shared_ptr<Symbol>, std::shared_ptr<MIRValue>> symbolValueMap;
+    std::unordered_map<const Symbol*, std::shared_ptr<MIRValue>> symbolValueMap;
     
-    // 一時レジスタのカウンタ
-    int tempCounter = 0;
-    std::string newRegisterName(); // 新しい一時レジスタ名を生成
+    uint32_t newRegister(); // 現在の関数で新しい一時レジスタの番号を取る
 
     // ヘルパー関数
     void setCurrentBlock(std::shared_ptr<MIRBasicBlock> block); // 現在の基本ブロックを設定
-    std::shared_ptr<MIRBasicBlock> createBasicBlock(const std::string& name); // 新しい基本ブロックを作成
+    std::shared_ptr<MIRBasicBlock> createBasicBlock(const char* name); // 新しい基本ブロックを作成
+    // 現在の関数のアリーナに命令を作る (基本ブロックにはまだつながない)
+    template<typename T, typename... Args>
+    T* createInstruction(Args&&... args){
+        return currentFunction->createInstruction<T>(std::forward<Args>(args)...);
+    }
+    // currentLocを付けて現在の基本ブロックに追加する
+    void emit(MIRInstruction* inst);
+    void terminate(std::shared_ptr<MIRTerminatorInstruction> term);
+    // 型が違えばキャスト命令を追加する
+    std::shared_ptr<MIRValue> convert(std::shared_ptr<MIRValue> value, CastOpcode op, MIRType* targetType);
+    // print/inputをランタイム関数(runtime/LumaRuntime.c)の呼び出しにする
+    void emitPrint(std::shared_ptr<MIRValue> value);
+    void emitInput(VariableRefNode* target);
 
     // ASTノードごとのvisitメソッド
     void visit(ProgramNode* node);
@@ -70,8 +90,10 @@ private:
     std::shared_ptr<MIRValue> visit(BinaryOpNode* node);
     std::shared_ptr<MIRValue> visit(FunctionCallNode* node);
     std::shared_ptr<MIRValue> visit(CastNode* node);
+    // 知らない種類のノード (AstVisitorから呼ばれる)
+    void unhandledStatement(StatementNode* node);
+    std::shared_ptr<MIRValue> unhandledExpr(ExprNode* node);
 
-    MIRType::TypeID getMirTypeIDFromString(const std::string& typeName);
-
+    MIRType* toMirType(TypeNode* type); // TypeTranslate::toMirTypeでmoduleの型にする
 
 };
\ No newline at end of file
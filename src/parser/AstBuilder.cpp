@@ -6,21 +6,23 @@
 #include "../ast/Expression.h"
 #include "../ast/Statement.h"
 #include "../ast/Definition.h"
-#include "common/Global.h"
 #include "types/Type.h"
+#include "types/TypeContext.h"
 #include "types/TypeTranslate.h"
 #include <cstddef>
 #include <iostream> // デバッグ用
 
 antlrcpp::Any AstBuilder::visitProgram(Luma::LumaParser::ProgramContext *ctx) {
-    auto progNode = std::make_shared<ProgramNode>();
+    auto progNode = create<ProgramNode>(ctx->getStart());
+    std::vector<StatementNode*> statements;
 
     for (auto stmtCtx : ctx->statement()) {
         antlrcpp::Any result = visit(stmtCtx);
         if (result.has_value()) {
-            progNode->statements.push_back(std::any_cast<std::shared_ptr<StatementNode>>(result));
+            statements.push_back(std::any_cast<StatementNode*>(result));
         }
     }
+    progNode->statements = context.copyList(statements);
 
     antlrcpp::Any finalResult = progNode;
     return finalResult;
@@ -36,41 +38,43 @@ antlrcpp::Any AstBuilder::visitStatement(Luma::LumaParser::StatementContext *ctx
     if(ctx->returnStatement()) return visit(ctx->returnStatement());
     if(ctx->expr()){
         antlrcpp::Any exprAny = visit(ctx->expr());
-        auto exprNode = std::any_cast<std::shared_ptr<ExprNode>>(exprAny);
-        auto stmtNode = std::make_shared<ExprStatementNode>(exprNode);
-        return std::shared_ptr<StatementNode>(stmtNode);
+        auto exprNode = std::any_cast<ExprNode*>(exprAny);
+        auto stmtNode = create<ExprStatementNode>(ctx->getStart(), exprNode);
+        return static_cast<StatementNode*>(stmtNode);
     }
     return {};
 }
 
 antlrcpp::Any AstBuilder::visitBlock(Luma::LumaParser::BlockContext *ctx){
-    auto blockNode = std::make_shared<BlockNode>();
+    auto blockNode = create<BlockNode>(ctx->getStart());
+    std::vector<StatementNode*> statements;
     for(auto stmtCtx : ctx->statement()){
         antlrcpp::Any result = visit(stmtCtx);
         if(result.has_value()){
-            blockNode->statements.push_back(std::any_cast<std::shared_ptr<StatementNode>>(result));
+            statements.push_back(std::any_cast<StatementNode*>(result));
         }
     }
+    blockNode->statements = context.copyList(statements);
     antlrcpp::Any finalResult = blockNode;
     return finalResult;
 }
 
 antlrcpp::Any AstBuilder::visitFunctionDefinition(Luma::LumaParser::FunctionDefinitionContext *ctx){
-    std::string funcName = ctx->IDENTIFIER()->getText();
-    std::vector<std::string> args;
+    NameId funcName = names.intern(ctx->IDENTIFIER()->getText());
+    std::vector<NameId> args;
     std::vector<std::string> argTypesStr;
     if(ctx->parameterList()){
         for(const auto& argCtx : ctx->parameterList()->parameter()){
-            args.push_back(argCtx->IDENTIFIER()->getText());
+            args.push_back(names.intern(argCtx->IDENTIFIER()->getText()));
             argTypesStr.push_back(argCtx->typeAnnotation()->typeName()->getText());
         }
     }
-    std::vector<std::shared_ptr<TypeNode>> argTypes;
-    for(const auto& argType : argTypesStr) argTypes.push_back(TypeTranslate::toTypeNode(argType));
-    std::shared_ptr<BlockNode> body = std::any_cast<std::shared_ptr<BlockNode>>(visitBlock(ctx->block()));
-    std::shared_ptr<TypeNode> returnType = TypeTranslate::toTypeNode(ctx->typeName()->getText());
-    auto node = std::make_shared<FunctionDefNode>(funcName, args, argTypes, body, returnType);
-    antlrcpp::Any result = std::shared_ptr<StatementNode>(node);
+    std::vector<TypeNode*> argTypes;
+    for(const auto& argType : argTypesStr) argTypes.push_back(TypeTranslate::toTypeNode(argType, types));
+    BlockNode* body = std::any_cast<BlockNode*>(visitBlock(ctx->block()));
+    TypeNode* returnType = TypeTranslate::toTypeNode(ctx->typeName()->getText(), types);
+    auto node = create<FunctionDefNode>(ctx->getStart(), funcName, args, argTypes, body, returnType);
+    antlrcpp::Any result = static_cast<StatementNode*>(node);
     return result;
 }
 antlrcpp::Any AstBuilder::visitParameterList(Luma::LumaParser::ParameterListContext *ctx){
@@ -80,40 +84,40 @@ antlrcpp::Any AstBuilder::visitParameter(Luma::LumaParser::ParameterContext *ctx
     return nullptr;
 }
 antlrcpp::Any AstBuilder::visitReturnStatement(Luma::LumaParser::ReturnStatementContext *ctx){
-    std::shared_ptr<ReturnNode> node = nullptr;
+    ReturnNode* node = nullptr;
     if(ctx->expr()){
-        auto retVal = std::any_cast<std::shared_ptr<ExprNode>>(visit(ctx->expr()));
-        node = std::make_shared<ReturnNode>(retVal);
+        auto retVal = std::any_cast<ExprNode*>(visit(ctx->expr()));
+        node = create<ReturnNode>(ctx->getStart(), retVal);
     }else{
-        node = std::make_shared<ReturnNode>(nullptr);
+        node = create<ReturnNode>(ctx->getStart(), nullptr);
     }
-    return std::shared_ptr<StatementNode>(node);
+    return static_cast<StatementNode*>(node);
 }
 
 antlrcpp::Any AstBuilder::visitVarDecl(Luma::LumaParser::VarDeclContext *ctx) {
-    std::string varName = ctx->IDENTIFIER()->getText();
-    std::shared_ptr<TypeNode> type = nullptr;
-    std::shared_ptr<ExprNode> init = nullptr;
+    NameId varName = names.intern(ctx->IDENTIFIER()->getText());
+    TypeNode* type = nullptr;
+    ExprNode* init = nullptr;
 
     if (ctx->typeAnnotation()) {
         std::string typeNameStr = ctx->typeAnnotation()->typeName()->getText();
-        type = TypeTranslate::toTypeNode(typeNameStr);
+        type = TypeTranslate::toTypeNode(typeNameStr, types);
     }
 
     if (ctx->expr()) {
-        init = std::any_cast<std::shared_ptr<ExprNode>>(visit(ctx->expr()));
+        init = std::any_cast<ExprNode*>(visit(ctx->expr()));
     } else if (ctx->arrayLiteral()) {
-        init = std::any_cast<std::shared_ptr<ExprNode>>(visit(ctx->arrayLiteral()));
+        init = std::any_cast<ExprNode*>(visit(ctx->arrayLiteral()));
     }
 
-    if (dynamic_cast<ArrayTypeNode*>(type.get())) {
-        auto arrayType = std::dynamic_pointer_cast<ArrayTypeNode>(type);
-        auto node = std::make_shared<ArrayDeclNode>(varName, arrayType->arrType, arrayType->size);
+    if (type && type->getKind() == TypeKind::Array) {
+        auto arrayType = static_cast<ArrayTypeNode*>(type);
+        auto node = create<ArrayDeclNode>(ctx->getStart(), varName, arrayType->elementType, arrayType->size);
         node->initializer = init;
-        return std::shared_ptr<StatementNode>(node);
+        return static_cast<StatementNode*>(node);
     } else {
-        auto node = std::make_shared<VarDeclNode>(varName, type, init);
-        return std::shared_ptr<StatementNode>(node);
+        auto node = create<VarDeclNode>(ctx->getStart(), varName, type, init);
+        return static_cast<StatementNode*>(node);
     }
 }
 
@@ -125,36 +129,36 @@ antlrcpp::Any AstBuilder::visitTypeName(Luma::LumaParser::TypeNameContext *ctx){
 }
 
 antlrcpp::Any AstBuilder::visitAssignmentStatement(Luma::LumaParser::AssignmentStatementContext *ctx){
-    std::string varName = ctx->IDENTIFIER()->getText();
+    NameId varName = names.intern(ctx->IDENTIFIER()->getText());
     antlrcpp::Any valAny = visit(ctx->expr());
-    std::shared_ptr<ExprNode> val = std::any_cast<std::shared_ptr<ExprNode>>(valAny);
-    auto node = std::make_shared<AssignmentNode>(varName, val);
-    antlrcpp::Any result = std::shared_ptr<StatementNode>(node);
+    ExprNode* val = std::any_cast<ExprNode*>(valAny);
+    auto node = create<AssignmentNode>(ctx->getStart(), varName, val);
+    antlrcpp::Any result = static_cast<StatementNode*>(node);
     return result;
 }
 
 antlrcpp::Any AstBuilder::visitIfStatement(Luma::LumaParser::IfStatementContext *ctx){
     antlrcpp::Any conditionAny = visit(ctx->expr());
     antlrcpp::Any ifblockAny = visit(ctx->block(0));
-    std::shared_ptr<BlockNode> elseblock = nullptr;
-    std::shared_ptr<ExprNode> condition = std::any_cast<std::shared_ptr<ExprNode>>(conditionAny);
-    std::shared_ptr<BlockNode> ifblock = std::any_cast<std::shared_ptr<BlockNode>>(ifblockAny);
+    BlockNode* elseblock = nullptr;
+    ExprNode* condition = std::any_cast<ExprNode*>(conditionAny);
+    BlockNode* ifblock = std::any_cast<BlockNode*>(ifblockAny);
     if(ctx->block(1)){
         antlrcpp::Any elseblockAny = visit(ctx->block(1));
-        elseblock = std::any_cast<std::shared_ptr<BlockNode>>(elseblockAny);
+        elseblock = std::any_cast<BlockNode*>(elseblockAny);
     }
-    auto node = std::make_shared<IfNode>(condition, ifblock, elseblock);
-    antlrcpp::Any result = std::shared_ptr<StatementNode>(node);
+    auto node = create<IfNode>(ctx->getStart(), condition, ifblock, elseblock);
+    antlrcpp::Any result = static_cast<StatementNode*>(node);
     return result;
 }
 
 antlrcpp::Any AstBuilder::visitConditionForStatement(Luma::LumaParser::ConditionForStatementContext *ctx){
     antlrcpp::Any conditionAny = visit(ctx->expr());
     antlrcpp::Any blockAny = visit(ctx->block());
-    std::shared_ptr<ExprNode> condition = std::any_cast<std::shared_ptr<ExprNode>>(conditionAny);
-    std::shared_ptr<BlockNode> block = std::any_cast<std::shared_ptr<BlockNode>>(blockAny);
-    auto node = std::make_shared<ForNode>(condition, block);
-    antlrcpp::Any result = std::shared_ptr<StatementNode>(node);
+    ExprNode* condition = std::any_cast<ExprNode*>(conditionAny);
+    BlockNode* block = std::any_cast<BlockNode*>(blockAny);
+    auto node = create<ForNode>(ctx->getStart(), condition, block);
+    antlrcpp::Any result = static_cast<StatementNode*>(node);
     return result;
 }
 
@@ -165,44 +169,44 @@ antlrcpp::Any AstBuilder::visitArrayLiteral(Luma::LumaParser::ArrayLiteralContex
 antlrcpp::Any AstBuilder::visitPrimaryExpr(Luma::LumaParser::PrimaryExprContext *ctx){
     if(ctx->INTEGER()){
         int val = std::stoi(ctx->INTEGER()->getText());
-        auto node = std::make_shared<NumberLiteralNode>(val);
-        antlrcpp::Any result = std::shared_ptr<ExprNode>(node);
+        auto node = create<NumberLiteralNode>(ctx->getStart(), val);
+        antlrcpp::Any result = static_cast<ExprNode*>(node);
         return result;
     }else if(ctx->DECIMAL()){
         double val = std::stod(ctx->DECIMAL()->getText());
-        auto node = std::make_shared<DecimalLiteralNode>(val);
-        antlrcpp::Any result = std::shared_ptr<ExprNode>(node);
+        auto node = create<DecimalLiteralNode>(ctx->getStart(), val);
+        antlrcpp::Any result = static_cast<ExprNode*>(node);
         return result;
     }else if(ctx->LPAREN()){
         return visit(ctx->expr());
     }else if(ctx->LBRACKET() && ctx->IDENTIFIER()){
         // 配列参照
-        std::string arrName = ctx->IDENTIFIER()->getText();
+        NameId arrName = names.intern(ctx->IDENTIFIER()->getText());
         antlrcpp::Any exprAny = visit(ctx->expr());
-        std::shared_ptr<ExprNode> exprNode = std::any_cast<std::shared_ptr<ExprNode>>(exprAny);
-        auto node = std::make_shared<ArrayRefNode>(arrName, exprNode);
-        antlrcpp::Any result = std::shared_ptr<ExprNode>(node);
+        ExprNode* exprNode = std::any_cast<ExprNode*>(exprAny);
+        auto node = create<ArrayRefNode>(ctx->getStart(), arrName, exprNode);
+        antlrcpp::Any result = static_cast<ExprNode*>(node);
         return result;
     }else if(ctx->arrayLiteral()){
         // 配列リテラル
-        std::vector<std::shared_ptr<ExprNode>> elem;
+        std::vector<ExprNode*> elem;
         for(auto&& i : ctx->arrayLiteral()->expr()){
             auto exprAny = visit(i);
-            auto exprNode = std::any_cast<std::shared_ptr<ExprNode>>(exprAny);
+            auto exprNode = std::any_cast<ExprNode*>(exprAny);
             elem.push_back(exprNode);
         }
-        auto node = std::make_shared<ArrayLiteralNode>(elem);
-        antlrcpp::Any result = std::shared_ptr<ExprNode>(node);
+        auto node = create<ArrayLiteralNode>(ctx->getStart(), context.copyList(elem));
+        antlrcpp::Any result = static_cast<ExprNode*>(node);
         return result;
     }else if(ctx->IDENTIFIER()){
-        std::string varName = ctx->IDENTIFIER()->getText();
-        auto node = std::make_shared<VariableRefNode>(varName);
-        antlrcpp::Any result = std::shared_ptr<ExprNode>(node);
+        NameId varName = names.intern(ctx->IDENTIFIER()->getText());
+        auto node = create<VariableRefNode>(ctx->getStart(), varName);
+        antlrcpp::Any result = static_cast<ExprNode*>(node);
         return result;
     }else if(ctx->functionCallExpr()){
         return visit(ctx->functionCallExpr());
     }else{
-        errorHandler.errorReg("Unknown primary expr.", 0);
+        diagnostics.errorReg("Unknown primary expr.", 0);
         return nullptr;
     }
 }
@@ -213,26 +217,26 @@ antlrcpp::Any AstBuilder::visitCastExpr(Luma::LumaParser::CastExprContext *ctx){
     // as typenameが続く限りループ処理
     for(size_t i = 0;i < ctx->typeName().size(); i++){
         std::string typeNameStr = ctx->typeName(i)->getText();
-        auto targetType = std::make_shared<BasicTypeNode>(typeNameStr);
-        auto exprToCast = std::any_cast<std::shared_ptr<ExprNode>>(resultAny);
-        auto castNode = std::make_shared<CastNode>(exprToCast, targetType);
-        resultAny = std::shared_ptr<ExprNode>(castNode);
+        auto targetType = TypeTranslate::toTypeNode(typeNameStr, types);
+        auto exprToCast = std::any_cast<ExprNode*>(resultAny);
+        auto castNode = create<CastNode>(ctx->getStart(), exprToCast, targetType);
+        resultAny = static_cast<ExprNode*>(castNode);
     }
     return resultAny;
 }
 
 antlrcpp::Any AstBuilder::visitFunctionCallExpr(Luma::LumaParser::FunctionCallExprContext *ctx){
-    std::string funcName = ctx->IDENTIFIER()->getText();
-    std::vector<std::shared_ptr<ExprNode>> args;
+    NameId funcName = names.intern(ctx->IDENTIFIER()->getText());
+    std::vector<ExprNode*> args;
     if(ctx->argList()){
         for(const auto& exprCtx : ctx->argList()->expr()){
             antlrcpp::Any argAny = visit(exprCtx);
-            std::shared_ptr<ExprNode> arg = std::any_cast<std::shared_ptr<ExprNode>>(argAny);
+            ExprNode* arg = std::any_cast<ExprNode*>(argAny);
             args.push_back(arg);
         }
     }
-    auto node = std::make_shared<FunctionCallNode>(funcName, args);
-    return std::shared_ptr<ExprNode>(node);
+    auto node = create<FunctionCallNode>(ctx->getStart(), funcName, context.copyList(args));
+    return static_cast<ExprNode*>(node);
 }
 
 antlrcpp::Any AstBuilder::visitArgList(Luma::LumaParser::ArgListContext *ctx){
@@ -255,14 +259,14 @@ antlrcpp::Any AstBuilder::visitAdditiveExpr(Luma::LumaParser::AdditiveExprContex
         antlrcpp::Any rhs_any = visit(ctx->multiplicativeExpr(i + 1));
 
         // キャスト
-        auto lhs_expr = std::any_cast<std::shared_ptr<ExprNode>>(lhs_any);
-        auto rhs_expr = std::any_cast<std::shared_ptr<ExprNode>>(rhs_any);
+        auto lhs_expr = std::any_cast<ExprNode*>(lhs_any);
+        auto rhs_expr = std::any_cast<ExprNode*>(rhs_any);
 
         // 新しい左辺を構築
-        auto new_lhs_expr = std::make_shared<BinaryOpNode>(op_text, lhs_expr, rhs_expr);
+        auto new_lhs_expr = create<BinaryOpNode>(ctx->op[i], op_text, lhs_expr, rhs_expr);
         
         // 次のループのために更新
-        lhs_any = std::shared_ptr<ExprNode>(new_lhs_expr);
+        lhs_any = static_cast<ExprNode*>(new_lhs_expr);
     }
 
     // 最終的な結果を返す
@@ -282,14 +286,14 @@ antlrcpp::Any AstBuilder::visitMultiplicativeExpr(Luma::LumaParser::Multiplicati
         antlrcpp::Any rhs_any = visit(ctx->castExpr(i + 1));
 
         // キャスト
-        auto lhs_expr = std::any_cast<std::shared_ptr<ExprNode>>(lhs_any);
-        auto rhs_expr = std::any_cast<std::shared_ptr<ExprNode>>(rhs_any);
+        auto lhs_expr = std::any_cast<ExprNode*>(lhs_any);
+        auto rhs_expr = std::any_cast<ExprNode*>(rhs_any);
 
         // 新しい左辺を構築
-        auto new_lhs_expr = std::make_shared<BinaryOpNode>(op_text, lhs_expr, rhs_expr);
+        auto new_lhs_expr = create<BinaryOpNode>(ctx->op[i], op_text, lhs_expr, rhs_expr);
         
         // 次のループのために更新
-        lhs_any = std::shared_ptr<ExprNode>(new_lhs_expr);
+        lhs_any = static_cast<ExprNode*>(new_lhs_expr);
     }
 
     // 最終的な結果を返す
@@ -302,11 +306,11 @@ antlrcpp::Any AstBuilder::visitComparisonExpr(Luma::LumaParser::ComparisonExprCo
         std::string op_text = ctx->op->getText();
         antlrcpp::Any rhs_any = visit(ctx->additiveExpr(1));
 
-        auto lhs_expr = std::any_cast<std::shared_ptr<ExprNode>>(lhs_any);
-        auto rhs_expr = std::any_cast<std::shared_ptr<ExprNode>>(rhs_any);
+        auto lhs_expr = std::any_cast<ExprNode*>(lhs_any);
+        auto rhs_expr = std::any_cast<ExprNode*>(rhs_any);
 
-        auto new_expr = std::make_shared<BinaryOpNode>(op_text, lhs_expr, rhs_expr);
-        antlrcpp::Any result = std::shared_ptr<ExprNode>(new_expr);
+        auto new_expr = create<BinaryOpNode>(ctx->op, op_text, lhs_expr, rhs_expr);
+        antlrcpp::Any result = static_cast<ExprNode*>(new_expr);
         return result;
     }
     return lhs_any;
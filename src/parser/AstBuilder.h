@@ -1,10 +1,30 @@
 #pragma once
 #include "LumaParser.h"
 #include "../ast/AstNode.h"
+#include "../ast/AstContext.h"
+#include "../driver/CompilerInstance.h"
 #include "LumaParserVisitor.h"
+#include "Token.h"
+#include <utility>
 
 class AstBuilder : public Luma::LumaParserVisitor {
+private:
+    AstContext& context; // ノードの確保先
+    StringInterner& names; // 識別子の登録先
+    TypeContext& types;
+    ErrorHandler& diagnostics;
+    const SourceManager& sources; // トークンの行と列をSourceLocationにする
+    // ノードを確保し、位置をtokenの位置にする (ふつうはctx->getStart()、二項演算子は演算子のトークン)
+    template<typename T, typename... Args>
+    T* create(antlr4::Token* token, Args&&... args){
+        T* node = context.create<T>(std::forward<Args>(args)...);
+        if(token) node->setLocation(sources.getLocation(static_cast<uint32_t>(token->getLine()), static_cast<uint32_t>(token->getCharPositionInLine())));
+        return node;
+    }
 public:
+    explicit AstBuilder(CompilerInstance& compiler)
+        : context(compiler.getAstContext()), names(compiler.getNameTable()), types(compiler.getTypeContext()), diagnostics(compiler.getDiagnostics()),
+          sources(compiler.getSourceManager()) {}
     // program
     antlrcpp::Any visitProgram(Luma::LumaParser::ProgramContext *ctx) override;
     // statement
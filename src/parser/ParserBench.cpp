@@ -0,0 +1,219 @@
+#include "ParserBench.h"
+#include "AstBuilder.h"
+#include "RDParser.h"
+#include "ParserDriver.h"
+#include "LumaLexer.h"
+#include "LumaParser.h"
+#include "ast/AstContext.h"
+#include "ast/AstSerializer.h"
+#include "driver/CompilerInstance.h"
+#include "ast/Statement.h"
+#include "lexer/FastLexer.h"
+#include "lexer/FastTokenSource.h"
+#include <any>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+const char* ParserBench::pathName(Path path){
+    switch(path){
+        case Path::Antlr: return "antlr";
+        case Path::AntlrFastLexer: return "antlr (fast lexer)";
+        case Path::RD: return "rd";
+    }
+    return "unknown";
+}
+
+size_t ParserBench::peakRssKB(){
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage{};
+    if(getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+    return static_cast<size_t>(usage.ru_maxrss) / 1024; // macOSはバイト単位
+#else
+    return static_cast<size_t>(usage.ru_maxrss);
+#endif
+#else
+    return 0;
+#endif
+}
+
+// 1回分の字句解析・構文解析・AST構築 (構文エラーの数を返す)
+static size_t parseOnce(std::string_view source, ParserBench::Path path, CompilerInstance& compiler, ProgramNode*& program){
+    using Path = ParserBench::Path;
+    if(path == Path::RD){
+        FastLexer lexer(source);
+        std::vector<LexToken> lexTokens = lexer.tokenize();
+        RDParser parser(source, lexTokens, compiler);
+        program = parser.parseProgram();
+        return lexer.getErrorCount() + parser.getErrorCount();
+    }
+    std::vector<LexToken> lexTokens;
+    std::unique_ptr<antlr4::ANTLRInputStream> input;
+    std::unique_ptr<antlr4::TokenSource> tokenSource;
+    size_t lexErrors = 0;
+    if(path == Path::AntlrFastLexer){
+        FastLexer lexer(source);
+        lexTokens = lexer.tokenize();
+        lexErrors = lexer.getErrorCount();
+        tokenSource = std::make_unique<FastTokenSource>(source, lexTokens, "bench");
+    }else{
+        input = std::make_unique<antlr4::ANTLRInputStream>(source);
+        tokenSource = std::make_unique<Luma::LumaLexer>(input.get());
+    }
+    antlr4::CommonTokenStream tokens(tokenSource.get());
+    Luma::LumaParser parser(&tokens);
+    bool usedFallback = false;
+    antlr4::tree::ParseTree* tree = ParserDriver::parseProgram(parser, tokens, usedFallback);
+    size_t errors = lexErrors + parser.getNumberOfSyntaxErrors();
+    if(errors) return errors;
+    AstBuilder astBuilder(compiler);
+    try{
+        program = std::any_cast<ProgramNode*>(tree->accept(&astBuilder));
+    }catch(const std::bad_any_cast&){
+        return 1;
+    }
+    return 0;
+}
+
+bool ParserBench::run(std::string_view source, Path path, unsigned iterations, std::ostream& os){
+    size_t rssBefore = peakRssKB();
+    // 1回目はANTLRのDFAキャッシュなどの準備も含むので別に測る
+    ProgramNode* program = nullptr;
+    size_t astNodes = 0, astBytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    {
+        CompilerInstance compiler;
+        compiler.getSourceManager().setSource("<bench>", source);
+        if(parseOnce(source, path, compiler, program) != 0){
+            os << "Parser benchmark aborted: syntax errors in input." << std::endl;
+            return false;
+        }
+        astNodes = compiler.getAstContext().getNodeCount();
+        astBytes = compiler.getAstContext().getBytesAllocated();
+    }
+    double firstMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for(unsigned i = 0; i < iterations; i++){
+        // 1回ごとにASTと文字列表をまとめて解放する
+        CompilerInstance compiler;
+        compiler.getSourceManager().setSource("<bench>", source);
+        parseOnce(source, path, compiler, program);
+    }
+    double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    size_t rssAfter = peakRssKB();
+
+    double megabytes = static_cast<double>(source.size()) * iterations / (1024.0 * 1024.0);
+    os << "--- Parser Benchmark ---" << std::endl;
+    os << std::fixed << std::setprecision(3);
+    os << "  path                " << pathName(path) << std::endl;
+    os << "  input               " << source.size() << " bytes x " << iterations << std::endl;
+    os << "  first parse         " << firstMs << " ms" << std::endl;
+    if(iterations > 0){
+        os << "  average parse       " << totalMs / iterations << " ms" << std::endl;
+        os << "  throughput          " << (totalMs > 0.0 ? megabytes / (totalMs / 1000.0) : 0.0) << " MB/s" << std::endl;
+    }
+    os << "  AST                 " << astNodes << " nodes, " << astBytes / 1024 << " KB" << std::endl;
+    os << "  peak RSS            " << rssAfter << " KB (+" << (rssAfter - rssBefore) << " KB while parsing)" << std::endl;
+    os << "------------------------" << std::endl;
+    return true;
+}
+
+bool ParserBench::runAstLoad(std::string_view source, Path path, unsigned iterations, std::ostream& os){
+    // キャッシュに保存されるのと同じバイト列を作っておく
+    std::string data;
+    size_t astNodes = 0;
+    {
+        CompilerInstance compiler;
+        compiler.getSourceManager().setSource("<bench>", source);
+        ProgramNode* program = nullptr;
+        if(parseOnce(source, path, compiler, program) != 0){
+            os << "AST load benchmark aborted: syntax errors in input." << std::endl;
+            return false;
+        }
+        compiler.getSemanticAnalysis().analyze(program);
+        if(compiler.getSemanticAnalysis().hasErrors()){
+            os << "AST load benchmark aborted: semantic errors in input." << std::endl;
+            return false;
+        }
+        data = AstSerializer::serialize(*program, compiler.getNameTable());
+        astNodes = compiler.getAstContext().getNodeCount();
+    }
+
+    double parseMs = 0.0, loadMs = 0.0;
+    for(unsigned i = 0; i < iterations; i++){
+        auto start = std::chrono::steady_clock::now();
+        CompilerInstance compiler;
+        compiler.getSourceManager().setSource("<bench>", source);
+        ProgramNode* program = nullptr;
+        parseOnce(source, path, compiler, program);
+        compiler.getSemanticAnalysis().analyze(program);
+        parseMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    for(unsigned i = 0; i < iterations; i++){
+        auto start = std::chrono::steady_clock::now();
+        CompilerInstance compiler;
+        compiler.getSourceManager().setSource("<bench>", source);
+        if(!AstSerializer::deserialize(data, compiler)){
+            os << "AST load benchmark aborted: could not load the serialized AST." << std::endl;
+            return false;
+        }
+        loadMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    os << "--- AST Load Benchmark ---" << std::endl;
+    os << std::fixed << std::setprecision(3);
+    os << "  path                " << pathName(path) << std::endl;
+    os << "  input               " << source.size() << " bytes x " << iterations << std::endl;
+    os << "  AST                 " << astNodes << " nodes, " << data.size() << " bytes serialized" << std::endl;
+    if(iterations > 0){
+        os << "  average parse+sema  " << parseMs / iterations << " ms" << std::endl;
+        os << "  average load        " << loadMs / iterations << " ms" << std::endl;
+        os << "  speedup             " << (loadMs > 0.0 ? parseMs / loadMs : 0.0) << "x" << std::endl;
+    }
+    os << "--------------------------" << std::endl;
+    return true;
+}
+
+bool ParserBench::crossCheck(std::string_view source, const ProgramNode& program, CompilerInstance& compiler, std::ostream& os){
+    // 名前を同じ文字列表に登録するので、ANTLRの経路のASTも同じCompilerInstanceに作る
+    ProgramNode* antlrProgram = nullptr;
+    if(parseOnce(source, Path::Antlr, compiler, antlrProgram) != 0 || !antlrProgram){
+        os << "Parser check failed: ANTLR path could not build the AST." << std::endl;
+        return false;
+    }
+    // dumpはstd::coutに書くので、一時的に出力先を差し替えて比べる
+    auto dumpToString = [&compiler](const ProgramNode& node){
+        std::ostringstream out;
+        std::streambuf* old = std::cout.rdbuf(out.rdbuf());
+        node.dump(compiler.getNameTable());
+        std::cout.rdbuf(old);
+        return out.str();
+    };
+    std::string expected = dumpToString(*antlrProgram);
+    std::string actual = dumpToString(program);
+    if(expected != actual){
+        // 最初に食い違った行を表示する
+        std::istringstream expectedLines(expected), actualLines(actual);
+        std::string expectedLine, actualLine;
+        size_t lineNo = 1;
+        while(true){
+            bool moreExpected = static_cast<bool>(std::getline(expectedLines, expectedLine));
+            bool moreActual = static_cast<bool>(std::getline(actualLines, actualLine));
+            if(!moreExpected) expectedLine = "<end>";
+            if(!moreActual) actualLine = "<end>";
+            if(expectedLine != actualLine || (!moreExpected && !moreActual)) break;
+            lineNo++;
+        }
+        os << "Parser mismatch at AST dump line " << lineNo << ": rd '" << actualLine << "', antlr '" << expectedLine << "'" << std::endl;
+        return false;
+    }
+    os << "Parser check passed: " << program.statements.size() << " top-level statements match." << std::endl;
+    return true;
+}
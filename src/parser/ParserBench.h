@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+class ProgramNode;
+class CompilerInstance;
+
+// パーサーの処理速度とメモリ使用量を測る (-bench-parser=<N>)
+// 字句解析からASTができるまでをN回繰り返し、MB/sとピークRSSを表示する
+// ピークRSSはプロセス全体の値なので、経路ごとに別々に実行して比べる
+// RDParserとANTLRの経路のASTの比較 (-dbg-parse-check) もここで行う
+class ParserBench{
+public:
+    enum class Path{
+        Antlr,          // LumaLexer + LumaParser + AstBuilder
+        AntlrFastLexer, // FastLexer + LumaParser + AstBuilder
+        RD              // FastLexer + RDParser
+    };
+    static const char* pathName(Path path);
+    // 構文エラーがあった場合はfalse
+    static bool run(std::string_view source, Path path, unsigned iterations, std::ostream& os);
+    // ソースから構文解析+セマンティック解析でASTを作る場合と、.lumaast(AstCache)から読み込む場合の時間を比べる (-bench-ast-load=<N>)
+    // 構文エラー・意味エラーがあった場合はfalse
+    static bool runAstLoad(std::string_view source, Path path, unsigned iterations, std::ostream& os);
+    // ANTLRの経路でもASTを作り、ダンプが一致するか確かめる (-dbg-parse-check)
+    static bool crossCheck(std::string_view source, const ProgramNode& program, CompilerInstance& compiler, std::ostream& os);
+    // これまでのピークRSS (KB, 取得できない環境では0)
+    static size_t peakRssKB();
+};
@@ -0,0 +1,89 @@
+#include "ParserDriver.h"
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace antlr4;
+
+Luma::LumaParser::ProgramContext* ParserDriver::parseProgram(Luma::LumaParser& parser, CommonTokenStream& tokens, bool& usedFallback){
+    usedFallback = false;
+    // 1段階目: SLL (文脈を見ない予測) で、最初のエラーで打ち切る
+    parser.getInterpreter<atn::ParserATNSimulator>()->setPredictionMode(atn::PredictionMode::SLL);
+    parser.removeErrorListeners();
+    parser.setErrorHandler(std::make_shared<BailErrorStrategy>());
+    try{
+        return parser.program();
+    }catch(const ParseCancellationException&){
+        // 2段階目に進む
+    }
+    // 2段階目: 最初から通常のLLで解析し直し、エラーを表示・回復する
+    usedFallback = true;
+    tokens.seek(0);
+    parser.reset();
+    parser.addErrorListener(&ConsoleErrorListener::INSTANCE);
+    parser.setErrorHandler(std::make_shared<DefaultErrorStrategy>());
+    parser.getInterpreter<atn::ParserATNSimulator>()->setPredictionMode(atn::PredictionMode::LL);
+    return parser.program();
+}
+
+Luma::LumaParser::ProgramContext* ParserDriver::parseProgramWithProfile(Luma::LumaParser& parser, std::ostream& os){
+    parser.setProfile(true);
+    Luma::LumaParser::ProgramContext* tree = parser.program();
+    auto* profiler = dynamic_cast<atn::ProfilingATNSimulator*>(parser.getInterpreter<atn::ParserATNSimulator>());
+    if(!profiler){
+        os << "Parser profiling is not available." << std::endl;
+        return tree;
+    }
+
+    std::vector<atn::DecisionInfo> decisions = profiler->getDecisionInfo();
+    // 予測にかかった時間の長い順 (同じなら先読みの合計が多い順)
+    std::sort(decisions.begin(), decisions.end(), [](const atn::DecisionInfo& a, const atn::DecisionInfo& b){
+        if(a.timeInPrediction != b.timeInPrediction) return a.timeInPrediction > b.timeInPrediction;
+        return a.SLL_TotalLook + a.LL_TotalLook > b.SLL_TotalLook + b.LL_TotalLook;
+    });
+
+    const atn::ATN& atn = parser.getATN();
+    const std::vector<std::string>& ruleNames = parser.getRuleNames();
+    auto ruleOf = [&](size_t decision) -> std::string {
+        if(decision >= atn.decisionToState.size()) return "?";
+        size_t ruleIndex = atn.decisionToState[decision]->ruleIndex;
+        return ruleIndex < ruleNames.size() ? ruleNames[ruleIndex] : "?";
+    };
+
+    long long totalTime = 0, totalFallback = 0;
+    std::map<std::string, long long> timeByRule;
+    os << "--- Parser Profile ---" << std::endl;
+    os << "  " << std::left << std::setw(10) << "decision" << std::setw(20) << "rule" << std::right
+       << std::setw(12) << "invocations" << std::setw(12) << "time(ms)"
+       << std::setw(16) << "SLL look(sum)" << std::setw(14) << "SLL look(max)"
+       << std::setw(14) << "LL fallback" << std::setw(15) << "LL look(sum)" << std::setw(14) << "LL look(max)"
+       << std::setw(13) << "ambiguities" << std::endl;
+    for(const auto& info : decisions){
+        if(info.invocations == 0) continue;
+        std::string rule = ruleOf(info.decision);
+        totalTime += info.timeInPrediction;
+        totalFallback += info.LL_Fallback;
+        timeByRule[rule] += info.timeInPrediction;
+        os << "  " << std::left << std::setw(10) << info.decision << std::setw(20) << rule << std::right
+           << std::setw(12) << info.invocations
+           << std::setw(12) << std::fixed << std::setprecision(3) << info.timeInPrediction / 1e6
+           << std::setw(16) << info.SLL_TotalLook << std::setw(14) << info.SLL_MaxLook
+           << std::setw(14) << info.LL_Fallback << std::setw(15) << info.LL_TotalLook << std::setw(14) << info.LL_MaxLook
+           << std::setw(13) << info.ambiguities.size() << std::endl;
+    }
+
+    // 規則ごとの合計 (どの規則の書き方が遅いかを見る)
+    std::vector<std::pair<std::string, long long>> rules(timeByRule.begin(), timeByRule.end());
+    std::sort(rules.begin(), rules.end(), [](const auto& a, const auto& b){ return a.second > b.second; });
+    os << "  by rule:" << std::endl;
+    for(const auto& [rule, time] : rules){
+        os << "    " << std::left << std::setw(20) << rule << std::right << std::fixed << std::setprecision(3)
+           << time / 1e6 << " ms" << std::endl;
+    }
+    os << "  total prediction time " << std::fixed << std::setprecision(3) << totalTime / 1e6
+       << " ms, LL fallbacks " << totalFallback << std::endl;
+    os << "----------------------" << std::endl;
+    return tree;
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include "antlr4-runtime.h"
+#include "LumaParser.h"
+#include <ostream>
+
+// ANTLRのLumaParserの呼び出し方をまとめたもの
+class ParserDriver{
+public:
+    // まずSLLモードとBailErrorStrategyで速く解析し、失敗したときだけ通常のLLモードでやり直す
+    // SLLで失敗しても構文エラーとは限らない (SLLでは解けない文脈依存の判断があるだけの場合もある) ので、エラーの表示はLLに任せる
+    static Luma::LumaParser::ProgramContext* parseProgram(Luma::LumaParser& parser, antlr4::CommonTokenStream& tokens, bool& usedFallback);
+    // ProfilingATNSimulatorで解析し、先読みのコストが大きい決定の順に表示する (-profile-parser)
+    static Luma::LumaParser::ProgramContext* parseProgramWithProfile(Luma::LumaParser& parser, std::ostream& os);
+};
@@ -0,0 +1,323 @@
+#include "RDParser.h"
+#include "LumaLexer.h"
+#include "ast/Definition.h"
+#include "types/Type.h"
+#include "types/TypeContext.h"
+#include "types/TypeTranslate.h"
+#include <algorithm>
+#include <charconv>
+#include <iostream>
+
+using L = Luma::LumaLexer;
+
+const LexToken& RDParser::peek(size_t ahead) const {
+    // 最後のトークンは必ずEOFなので、それより先はEOFを返す
+    return tokens[std::min(pos + ahead, tokens.size() - 1)];
+}
+
+const LexToken& RDParser::advance(){
+    const LexToken& token = peek();
+    if(pos < tokens.size() - 1) pos++;
+    return token;
+}
+
+bool RDParser::accept(int32_t type){
+    if(!check(type)) return false;
+    advance();
+    return true;
+}
+
+const LexToken& RDParser::expect(int32_t type, const char* expected){
+    if(!check(type)) error(expected);
+    return advance();
+}
+
+void RDParser::error(const char* expected){
+    const LexToken& token = peek();
+    errorAt(token, "mismatched input '" + std::string(token.type < 0 ? "<EOF>" : text(token)) + "' expecting " + expected);
+}
+
+void RDParser::errorAt(const LexToken& token, const std::string& message){
+    errorCount++;
+    // ANTLRのConsoleErrorListenerと同じ形式
+    std::cerr << "line " << token.line << ":" << token.column << " " << message << std::endl;
+    throw SyntaxError{};
+}
+
+void RDParser::synchronize(size_t statementStart){
+    // 文の区切りまで読み飛ばす (何も読めていなければ無限ループしないように1つ進める)
+    while(!check(-1)){
+        if(accept(L::SEMI)) return;
+        if(check(L::RBRACE)){
+            if(pos == statementStart) advance();
+            return;
+        }
+        advance();
+    }
+}
+
+std::string_view RDParser::text(const LexToken& token) const {
+    return source.substr(token.offset, token.length);
+}
+
+ProgramNode* RDParser::parseProgram(){
+    auto progNode = create<ProgramNode>(peek());
+    std::vector<StatementNode*> statements;
+    while(!check(-1)){
+        size_t start = pos;
+        try{
+            if(auto stmt = parseStatement()) statements.push_back(stmt);
+        }catch(const SyntaxError&){
+            synchronize(start);
+        }
+    }
+    progNode->statements = context.copyList(statements);
+    return progNode;
+}
+
+StatementNode* RDParser::parseStatement(){
+    const LexToken& start = peek();
+    switch(peek().type){
+        case L::VAR:
+        case L::LET:
+            return parseVarDecl();
+        case L::LBRACE:{
+            // BlockNodeはStatementNodeではないので、AstBuilderでもASTを作れない (any_castに失敗する)
+            // ここでは構文だけ確かめてエラーにする
+            errorCount++;
+            diagnostics.errorReg(ErrorCode::BLOCK_STATEMENT_NOT_SUPPORTED, {}, SourceLocation::fromOffset(start.offset));
+            parseBlock();
+            return nullptr;
+        }
+        case L::IF: return parseIf();
+        case L::FOR: return parseFor();
+        case L::FN: return parseFunctionDefinition();
+        case L::RETURN: return parseReturn();
+        case L::IDENTIFIER:
+            if(peek(1).type == L::EQ) return parseAssignment();
+            break;
+        default:
+            break;
+    }
+    auto expr = parseExpr();
+    expect(L::SEMI, "';'");
+    return create<ExprStatementNode>(start, expr);
+}
+
+BlockNode* RDParser::parseBlock(){
+    auto blockNode = create<BlockNode>(expect(L::LBRACE, "'{'"));
+    std::vector<StatementNode*> statements;
+    while(!check(L::RBRACE) && !check(-1)){
+        size_t start = pos;
+        try{
+            if(auto stmt = parseStatement()) statements.push_back(stmt);
+        }catch(const SyntaxError&){
+            synchronize(start);
+        }
+    }
+    blockNode->statements = context.copyList(statements);
+    expect(L::RBRACE, "'}'");
+    return blockNode;
+}
+
+StatementNode* RDParser::parseVarDecl(){
+    const LexToken& start = advance(); // var | let
+    NameId varName = names.intern(text(expect(L::IDENTIFIER, "IDENTIFIER")));
+    TypeNode* type = nullptr;
+    ExprNode* init = nullptr;
+    if(accept(L::COLON)) type = TypeTranslate::toTypeNode(parseTypeName(), types);
+    // 文法では (expr | arrayLiteral) だが、配列リテラルはexprのprimaryExprにも含まれ、ANTLRも先にexprを選ぶ
+    if(accept(L::EQ)) init = parseExpr();
+    expect(L::SEMI, "';'");
+
+    if (type && type->getKind() == TypeKind::Array) {
+        auto arrayType = static_cast<ArrayTypeNode*>(type);
+        auto node = create<ArrayDeclNode>(start, varName, arrayType->elementType, arrayType->size);
+        node->initializer = init;
+        return node;
+    }
+    return create<VarDeclNode>(start, varName, type, init);
+}
+
+StatementNode* RDParser::parseAssignment(){
+    const LexToken& start = advance();
+    NameId varName = names.intern(text(start));
+    advance(); // =
+    auto val = parseExpr();
+    expect(L::SEMI, "';'");
+    return create<AssignmentNode>(start, varName, val);
+}
+
+StatementNode* RDParser::parseIf(){
+    const LexToken& start = advance(); // if
+    auto condition = parseExpr();
+    auto ifblock = parseBlock();
+    BlockNode* elseblock = nullptr;
+    if(accept(L::ELSE)) elseblock = parseBlock();
+    return create<IfNode>(start, condition, ifblock, elseblock);
+}
+
+StatementNode* RDParser::parseFor(){
+    const LexToken& start = advance(); // for
+    auto condition = parseExpr();
+    auto block = parseBlock();
+    return create<ForNode>(start, condition, block);
+}
+
+StatementNode* RDParser::parseFunctionDefinition(){
+    const LexToken& start = advance(); // fn
+    NameId funcName = names.intern(text(expect(L::IDENTIFIER, "IDENTIFIER")));
+    expect(L::LPAREN, "'('");
+    std::vector<NameId> args;
+    std::vector<TypeNode*> argTypes;
+    if(!check(L::RPAREN)){
+        do{
+            args.push_back(names.intern(text(expect(L::IDENTIFIER, "IDENTIFIER"))));
+            expect(L::COLON, "':'");
+            argTypes.push_back(TypeTranslate::toTypeNode(parseTypeName(), types));
+        }while(accept(L::COMMA));
+    }
+    expect(L::RPAREN, "')'");
+    expect(L::EQ, "'='");
+    TypeNode* returnType = TypeTranslate::toTypeNode(parseTypeName(), types);
+    BlockNode* body = parseBlock();
+    return create<FunctionDefNode>(start, funcName, args, argTypes, body, returnType);
+}
+
+StatementNode* RDParser::parseReturn(){
+    const LexToken& start = advance(); // return
+    ExprNode* retVal = nullptr;
+    if(!check(L::SEMI)) retVal = parseExpr();
+    expect(L::SEMI, "';'");
+    return create<ReturnNode>(start, retVal);
+}
+
+std::string RDParser::parseTypeName(){
+    switch(peek().type){
+        case L::TYPE_INT64:
+        case L::TYPE_INT32:
+        case L::TYPE_CHAR:
+        case L::TYPE_FLOAT64:
+        case L::TYPE_FLOAT32:
+            break;
+        default:
+            error("{'int', 'i32', 'char', 'float', 'f32'}");
+    }
+    // getText()と同じく、トークンの間の空白を除いてつなげる (例: "int[5]")
+    std::string typeName(text(advance()));
+    while(check(L::LBRACKET)){
+        advance();
+        std::string_view size = text(expect(L::INTEGER, "INTEGER"));
+        expect(L::RBRACKET, "']'");
+        typeName += "[";
+        typeName += size;
+        typeName += "]";
+    }
+    return typeName;
+}
+
+ExprNode* RDParser::parseExpr(){
+    return parseBinary(1);
+}
+
+// 二項演算子の優先順位 (0は二項演算子ではない)
+static int binaryPrecedence(int32_t type){
+    switch(type){
+        case L::MUL: case L::DIV: return 3;
+        case L::ADD: case L::SUB: return 2;
+        case L::EQEQ: case L::NE: case L::LT: case L::GT: case L::LE: case L::GE: return 1;
+        default: return 0;
+    }
+}
+
+ExprNode* RDParser::parseBinary(int minPrecedence){
+    auto lhs = parseCast();
+    while(true){
+        int precedence = binaryPrecedence(peek().type);
+        if(precedence == 0 || precedence < minPrecedence) break;
+        const LexToken& opToken = advance();
+        std::string op(text(opToken));
+        // 左結合なので、右辺は一つ上の優先順位から読む
+        auto rhs = parseBinary(precedence + 1);
+        lhs = create<BinaryOpNode>(opToken, op, lhs, rhs);
+        // 比較は一回だけとする (a < b < c は文法上エラー)
+        if(precedence == 1) break;
+    }
+    return lhs;
+}
+
+ExprNode* RDParser::parseCast(){
+    const LexToken& start = peek();
+    auto result = parsePrimary();
+    // as typenameが続く限りループ処理
+    while(accept(L::AS)){
+        // 宣言の型注釈と同じく組み込みの型だけを引く (知らない型名はnullptrにして、セマンティック解析でエラーにする)
+        auto targetType = TypeTranslate::toTypeNode(parseTypeName(), types);
+        result = create<CastNode>(start, result, targetType);
+    }
+    return result;
+}
+
+template<typename T>
+T RDParser::parseNumber(const LexToken& token){
+    // ソースから直接読む (std::stoi/stodと違い一時的なstd::stringを作らない)
+    std::string_view digits = text(token);
+    if(!digits.empty() && digits.front() == '+') digits.remove_prefix(1); // from_charsは'+'を受け付けない
+    T value{};
+    auto [end, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+    if(ec != std::errc() || end != digits.data() + digits.size()){
+        errorAt(token, "numeric literal out of range '" + std::string(text(token)) + "'");
+    }
+    return value;
+}
+
+ExprNode* RDParser::parsePrimary(){
+    const LexToken& start = peek();
+    switch(peek().type){
+        case L::INTEGER:
+            return create<NumberLiteralNode>(start, parseNumber<int>(advance()));
+        case L::DECIMAL:
+            return create<DecimalLiteralNode>(start, parseNumber<double>(advance()));
+        case L::LPAREN:{
+            advance();
+            auto expr = parseExpr();
+            expect(L::RPAREN, "')'");
+            return expr;
+        }
+        case L::LBRACKET:{
+            // 配列リテラル
+            advance();
+            std::vector<ExprNode*> elem;
+            if(!check(L::RBRACKET)){
+                do{
+                    elem.push_back(parseExpr());
+                }while(accept(L::COMMA));
+            }
+            expect(L::RBRACKET, "']'");
+            return create<ArrayLiteralNode>(start, context.copyList(elem));
+        }
+        case L::IDENTIFIER:{
+            NameId name = names.intern(text(advance()));
+            if(accept(L::LBRACKET)){
+                // 配列参照
+                auto idx = parseExpr();
+                expect(L::RBRACKET, "']'");
+                return create<ArrayRefNode>(start, name, idx);
+            }
+            if(accept(L::LPAREN)){
+                // 関数呼び出し
+                std::vector<ExprNode*> args;
+                if(!check(L::RPAREN)){
+                    do{
+                        args.push_back(parseExpr());
+                    }while(accept(L::COMMA));
+                }
+                expect(L::RPAREN, "')'");
+                return create<FunctionCallNode>(start, name, context.copyList(args));
+            }
+            return create<VariableRefNode>(start, name);
+        }
+        default:
+            error("{INTEGER, DECIMAL, '(', '[', IDENTIFIER}");
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "ast/AstContext.h"
+#include "ast/Statement.h"
+#include "driver/CompilerInstance.h"
+#include "ast/Expression.h"
+#include "lexer/FastLexer.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// grammar/LumaParser.g4 を手書きした再帰下降パーサー (-rd-parser)
+// ANTLRのパースツリーを作らず、FastLexerのトークン列から直接ASTを組み立てる
+// 組み立てるASTはAstBuilderと同じになるようにしている
+class RDParser{
+private:
+    std::string_view source;
+    const std::vector<LexToken>& tokens;
+    AstContext& context; // ノードの確保先
+    StringInterner& names; // 識別子の登録先
+    TypeContext& types;
+    ErrorHandler& diagnostics; // 構文エラー以外のエラーの登録先
+    size_t pos = 0;
+    size_t errorCount = 0;
+    struct SyntaxError{}; // 文の単位まで巻き戻すための例外
+
+    const LexToken& peek(size_t ahead = 0) const;
+    bool check(int32_t type) const {return peek().type == type;}
+    const LexToken& advance();
+    bool accept(int32_t type);
+    const LexToken& expect(int32_t type, const char* expected);
+    [[noreturn]] void error(const char* expected);
+    [[noreturn]] void errorAt(const LexToken& token, const std::string& message);
+    void synchronize(size_t statementStart);
+    std::string_view text(const LexToken& token) const; // ソース(mmapした領域)を指す
+    // ノードを確保し、位置をtokenの位置にする (AstBuilderと同じくノードの先頭のトークン、二項演算子は演算子)
+    template<typename T, typename... Args>
+    T* create(const LexToken& token, Args&&... args){
+        T* node = context.create<T>(std::forward<Args>(args)...);
+        node->setLocation(SourceLocation::fromOffset(token.offset));
+        return node;
+    }
+
+    // 文
+    StatementNode* parseStatement();
+    BlockNode* parseBlock();
+    StatementNode* parseVarDecl();
+    StatementNode* parseAssignment();
+    StatementNode* parseIf();
+    StatementNode* parseFor();
+    StatementNode* parseFunctionDefinition();
+    StatementNode* parseReturn();
+    std::string parseTypeName(); // AstBuilderと同じく typeName の getText() と同じ文字列を返す
+
+    // 式 (二項演算子は優先順位で登る)
+    ExprNode* parseExpr();
+    ExprNode* parseBinary(int minPrecedence);
+    ExprNode* parseCast();
+    ExprNode* parsePrimary();
+    template<typename T> T parseNumber(const LexToken& token);
+public:
+    RDParser(std::string_view src, const std::vector<LexToken>& lexTokens, CompilerInstance& compiler)
+        : source(src), tokens(lexTokens), context(compiler.getAstContext()), names(compiler.getNameTable()), types(compiler.getTypeContext()), diagnostics(compiler.getDiagnostics()) {}
+    // 構文エラーはANTLRと同じ形式で表示し、次の文から解析を続ける
+    ProgramNode* parseProgram();
+    size_t getErrorCount() const {return errorCount;}
+};
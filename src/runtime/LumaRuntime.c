@@ -0,0 +1,27 @@
+#include "LumaRuntime.h"
+#include <inttypes.h>
+#include <stdio.h>
+
+void luma_print_i64(int64_t value){
+    printf("%" PRId64 "\n", value);
+}
+
+void luma_print_f64(double value){
+    printf("%g\n", value);
+}
+
+void luma_print_bool(bool value){
+    puts(value ? "true" : "false");
+}
+
+int64_t luma_input_i64(void){
+    int64_t value = 0;
+    if(scanf("%" SCNd64, &value) != 1) return 0;
+    return value;
+}
+
+double luma_input_f64(void){
+    double value = 0;
+    if(scanf("%lf", &value) != 1) return 0;
+    return value;
+}
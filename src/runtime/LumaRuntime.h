@@ -0,0 +1,19 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// Lumaの組み込み関数 print/input の実装 (Cで書いて、Luma本体と-emit=exeの実行ファイルの両方にリンクする)
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void luma_print_i64(int64_t value);
+void luma_print_f64(double value);
+void luma_print_bool(bool value);
+// 読めなかったときは0を返す
+int64_t luma_input_i64(void);
+double luma_input_f64(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,32 @@
+#pragma once
+#include "runtime/LumaRuntime.h"
+#include <string_view>
+
+// print/inputが呼ぶランタイム関数の一覧
+// MIRGenはprint/inputをこれらの呼び出しにし、LLVMGenは外部関数として宣言する
+// JITはLuma本体にリンクされた実装のアドレスを登録し、-emit=exeはランタイムのライブラリとリンクする
+struct RuntimeFunctionInfo{
+    const char* name;
+    void* address;
+};
+
+inline constexpr const char* RuntimePrintInt = "luma_print_i64";
+inline constexpr const char* RuntimePrintFloat = "luma_print_f64";
+inline constexpr const char* RuntimePrintBool = "luma_print_bool";
+inline constexpr const char* RuntimeInputInt = "luma_input_i64";
+inline constexpr const char* RuntimeInputFloat = "luma_input_f64";
+
+inline const RuntimeFunctionInfo RuntimeFunctionTable[] = {
+    {RuntimePrintInt, reinterpret_cast<void*>(&luma_print_i64)},
+    {RuntimePrintFloat, reinterpret_cast<void*>(&luma_print_f64)},
+    {RuntimePrintBool, reinterpret_cast<void*>(&luma_print_bool)},
+    {RuntimeInputInt, reinterpret_cast<void*>(&luma_input_i64)},
+    {RuntimeInputFloat, reinterpret_cast<void*>(&luma_input_f64)},
+};
+
+inline bool isRuntimeFunction(std::string_view name){
+    for(const auto& function : RuntimeFunctionTable){
+        if(name == function.name) return true;
+    }
+    return false;
+}
@@ -0,0 +1,57 @@
+#include "SemaBench.h"
+#include "SemanticAnalysis.h"
+#include "ast/Definition.h"
+#include "driver/CompilerInstance.h"
+#include "mirgen/MIRGen.h"
+#include "types/TypeContext.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+bool SemaBench::run(CompilerInstance& compiler, ProgramNode* program, unsigned iterations, unsigned threads, std::ostream& os){
+    size_t astNodes = compiler.getAstContext().getNodeCount();
+    double totalMs = 0.0;
+    double minMs = 0.0;
+    double mirTotalMs = 0.0;
+    double mirMinMs = 0.0;
+    for(unsigned i = 0; i < iterations; i++){
+        auto start = std::chrono::steady_clock::now();
+        SemanticAnalysis semanticAnalysis(compiler);
+        semanticAnalysis.setThreads(threads);
+        semanticAnalysis.analyze(program);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if(semanticAnalysis.hasErrors()){
+            os << "Semantic analysis benchmark aborted: semantic errors in input." << std::endl;
+            return false;
+        }
+        totalMs += ms;
+        minMs = i == 0 ? ms : std::min(minMs, ms);
+
+        start = std::chrono::steady_clock::now();
+        MIRGen mirGen(compiler);
+        auto mirModule = mirGen.generate(program);
+        double mirMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if(compiler.getDiagnostics().hasError()){
+            os << "Semantic analysis benchmark aborted: MIR generation failed." << std::endl;
+            return false;
+        }
+        mirTotalMs += mirMs;
+        mirMinMs = i == 0 ? mirMs : std::min(mirMinMs, mirMs);
+    }
+
+    os << "--- Semantic Analysis Benchmark ---" << std::endl;
+    os << std::fixed << std::setprecision(3);
+    os << "  AST                 " << astNodes << " nodes x " << iterations << std::endl;
+    os << "  threads             " << (threads > 0 ? threads : 1) << std::endl;
+    if(iterations > 0){
+        os << "  average analyze     " << totalMs / iterations << " ms" << std::endl;
+        os << "  fastest analyze     " << minMs << " ms" << std::endl;
+        os << "  throughput          " << (totalMs > 0.0 ? static_cast<double>(astNodes) * iterations / (totalMs / 1000.0) / 1e6 : 0.0) << " M nodes/s" << std::endl;
+        os << "  average mir gen     " << mirTotalMs / iterations << " ms" << std::endl;
+        os << "  fastest mir gen     " << mirMinMs << " ms" << std::endl;
+        os << "  mir gen throughput  " << (mirTotalMs > 0.0 ? static_cast<double>(astNodes) * iterations / (mirTotalMs / 1000.0) / 1e6 : 0.0) << " M nodes/s" << std::endl;
+    }
+    os << "  unique types        " << compiler.getTypeContext().getTypeCount() << std::endl;
+    os << "-----------------------------------" << std::endl;
+    return true;
+}
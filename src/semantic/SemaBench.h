@@ -0,0 +1,17 @@
+#pragma once
+#include <cstddef>
+#include <ostream>
+
+class ProgramNode;
+class CompilerInstance;
+
+// 型検査(セマンティック解析)とMIR生成の処理速度を測る (-bench-sema=<N>)
+// 同じASTに対してSemanticAnalysis::analyzeとMIRGen::generateをN回繰り返し、1回あたりの時間を表示する
+// -sema-threads=<N> をつけると、関数本体の解析をN個のスレッドで行う
+// どちらもASTをたどってノードの種類ごとに振り分けるので、大きなASTで振り分けのコストを比べられる
+// 解析はASTに型とシンボルを書き込み直すだけなので、何回繰り返しても結果は変わらない
+class SemaBench{
+public:
+    // 意味エラーがあった場合はfalse
+    static bool run(CompilerInstance& compiler, ProgramNode* program, unsigned iterations, unsigned threads, std::ostream& os);
+};
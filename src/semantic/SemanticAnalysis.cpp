@@ -3,26 +3,41 @@
 #include "ast/Statement.h"
 #include "common/ErrorDef.h"
 #include "common/ErrorHandler.h"
-#include "common/Global.h"
+#include "driver/CompilerInstance.h"
 #include "types/Type.h"
+#include "types/TypeContext.h"
+#include <llvm/Support/Casting.h>
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 
 // コンストラクタ
-SemanticAnalysis::SemanticAnalysis(){
-    // 基本型のポインタを持つ
-    typePtr["int"] = std::make_shared<BasicTypeNode>("int");
-    typePtr["float"] = std::make_shared<BasicTypeNode>("float");
-    typePtr["i32"] = std::make_shared<BasicTypeNode>("i32");
-    typePtr["f32"] = std::make_shared<BasicTypeNode>("f32");
-    typePtr["char"] = std::make_shared<BasicTypeNode>("char");
-    typePtr["bool"] = std::make_shared<BasicTypeNode>("bool");
-    typePtr["void"] = std::make_shared<BasicTypeNode>("void");
+// CompilerInstanceの中で作られるので、ここではcompilerの型・文字列表・エラーしか使わない
+SemanticAnalysis::SemanticAnalysis(CompilerInstance& ci) : compiler(ci){
+    // 基本型のポインタを持つ (型は一意なので、型の比較はポインタの比較で済む)
+    TypeContext& types = compiler.getTypeContext();
+    intType = types.getIntType();
+    floatType = types.getFloatType();
+    boolType = types.getBoolType();
+    voidType = types.getVoidType();
+    unknownType = types.getUnknownType();
+    inputName = compiler.getNameTable().intern("input");
+    printName = compiler.getNameTable().intern("print");
+    diag = &compiler.getDiagnostics();
 }
 
+// 関数本体用のワーカー (nameTableに登録しないので、ワーカースレッドで作ってよい)
+SemanticAnalysis::SemanticAnalysis(const SemanticAnalysis& parent, ErrorHandler& diagnostics)
+    : compiler(parent.compiler), symbols(&parent.symbols), intType(parent.intType), floatType(parent.floatType), boolType(parent.boolType), voidType(parent.voidType), unknownType(parent.unknownType),
+      inputName(parent.inputName), printName(parent.printName), diag(&diagnostics) {}
+
 // 有効な型か判別するヘルパー関数
-bool SemanticAnalysis::is_type(std::string typeName){
+bool SemanticAnalysis::is_type(const std::string& typeName){
     bool isBasicType = (typeName == "int" || typeName == "i32" || typeName == "void" || typeName == "float" || 
                         typeName == "f32" || typeName == "char");
     return isBasicType;
@@ -31,398 +46,451 @@ bool SemanticAnalysis::is_type(std::string typeName){
 // main用
 // エラーがあるか
 bool SemanticAnalysis::hasErrors(){
-    return errorHandler.hasError();
+    return compiler.getDiagnostics().hasError();
 }
 
-void SemanticAnalysis::analyze(std::shared_ptr<ProgramNode> root){
-    globalScope = std::make_shared<Scope>();
-    currentScope = globalScope;
+// 1. 全ての関数のシグネチャをグローバルスコープに登録する (後ろで定義する関数も呼べる)
+// 2. 関数本体をthreads個のスレッドで解析する (グローバルスコープは読むだけ)
+// 3. トップレベルの文 (main関数の本体) を順番に解析する
+// エラーは関数ごと・続いているトップレベルの文ごとのバッファに登録し、最後にソースの順番でcompilerのErrorHandlerにまとめる
+// バッファは記録できる残りの数を共有するので、エラーが大量に出てもlimit個までしか持たない
+void SemanticAnalysis::analyze(ProgramNode* root){
+    symbols.clear();
     currentFunction = nullptr;
-    visit(root.get());
+    auto& statements = root->statements;
+    ErrorHandler& errorHandler = compiler.getDiagnostics();
+    // 文ごとのバッファの番号 (関数は1つずつ、その間のトップレベルの文はまとめて1つ)
+    std::vector<size_t> bufferOf(statements.size());
+    size_t bufferCount = 0;
+    for(size_t i = 0; i < statements.size(); i++){
+        bool isFunction = llvm::isa<FunctionDefNode>(statements[i]);
+        bool continuesRun = i > 0 && !isFunction && !llvm::isa<FunctionDefNode>(statements[i - 1]);
+        bufferOf[i] = continuesRun ? bufferCount - 1 : bufferCount++;
+    }
+    size_t limit = errorHandler.getLimit();
+    std::atomic<size_t> remaining{limit - std::min(limit, errorHandler.size())};
+    std::vector<ErrorHandler> diagnostics(bufferCount);
+    for(auto& buffer : diagnostics){
+        buffer.setLimit(limit);
+        if(limit != 0) buffer.setBudget(&remaining);
+        buffer.setNameTable(&compiler.getNameTable());
+    }
+
+    std::vector<std::pair<size_t, FunctionDefNode*>> functions;
+    for(size_t i = 0; i < statements.size(); i++){
+        if(auto funcDef = llvm::dyn_cast<FunctionDefNode>(statements[i])){
+            diag = &diagnostics[bufferOf[i]];
+            if(declareFunction(funcDef)) functions.push_back({bufferOf[i], funcDef});
+        }
+    }
+
+    std::atomic<size_t> next{0};
+    auto work = [&](){
+        for(size_t k = next++; k < functions.size(); k = next++){
+            auto [index, funcDef] = functions[k];
+            SemanticAnalysis worker(*this, diagnostics[index]);
+            worker.analyzeFunctionBody(funcDef);
+        }
+    };
+    size_t workerCount = std::min<size_t>(threads, functions.size());
+    if(workerCount <= 1){
+        work();
+    }else{
+        std::vector<std::thread> pool;
+        for(size_t t = 0; t < workerCount; t++){
+            pool.emplace_back(work);
+        }
+        for(auto& thread : pool) thread.join();
+    }
+
+    for(size_t i = 0; i < statements.size(); i++){
+        if(llvm::isa<FunctionDefNode>(statements[i])) continue;
+        diag = &diagnostics[bufferOf[i]];
+        visit(statements[i]);
+    }
+
+    diag = &errorHandler;
+    for(auto& buffer : diagnostics){
+        buffer.setBudget(nullptr); // remainingはこの関数を抜けると消える
+        errorHandler.append(buffer);
+    }
 }
 
 void SemanticAnalysis::enterScope(){
-    currentScope = std::make_shared<Scope>(currentScope);
+    symbols.enterScope();
 }
 void SemanticAnalysis::leaveScope(){
-    if(currentScope->parent){
-        currentScope = currentScope->parent;
-    }else{
-        errorHandler.compilerErrorReg(CompilerErrorCode::LEAVESCOPE_WITH_EMPTY_SYMBOLTABLE, {});
+    if(!symbols.leaveScope()){
+        diag->compilerErrorReg(CompilerErrorCode::LEAVESCOPE_WITH_EMPTY_SYMBOLTABLE);
     }
 }
-std::shared_ptr<TypeNode> SemanticAnalysis::visit(ExprNode *node){
-    if(auto cnode = dynamic_cast<BinaryOpNode*>(node)) return visit(cnode);
-    if(auto cnode = dynamic_cast<FunctionCallNode*>(node)) return visit(cnode);
-    if(auto cnode = dynamic_cast<NumberLiteralNode*>(node)) return visit(cnode);
-    if(auto cnode = dynamic_cast<DecimalLiteralNode*>(node)) return visit(cnode);
-    if(auto cnode = dynamic_cast<CastNode*>(node)) return visit(cnode);
-    if(auto cnode = dynamic_cast<VariableRefNode*>(node)) return visit(cnode);
-    if(auto cnode = dynamic_cast<ArrayRefNode*>(node)) return visit(cnode);
-    if(auto cnode = dynamic_cast<ArrayLiteralNode*>(node)) return visit(cnode); // 追加
-    else{
-        // errorHandler.errorReg("SemanticAnalysis::visit(ExprNode *node) failed to find correct type.", -1);
-        errorHandler.compilerErrorReg(CompilerErrorCode::EXPR_VISIT_COULDNOT_CAST, {std::string(typeid(*node).name())});
-        return nullptr;
-    }
+TypeNode* SemanticAnalysis::visit(ExprNode *node){
+    return dispatch(node);
+}
+TypeNode* SemanticAnalysis::unhandledExpr(ExprNode *node){
+    diag->compilerErrorReg(CompilerErrorCode::EXPR_VISIT_COULDNOT_CAST, {static_cast<int>(node->getKind())}, node->getLocation());
+    return nullptr;
 }
 
 void SemanticAnalysis::visit(VarDeclNode *node){
-    if(currentScope->lookupCurrent(node->varName)){
-        errorHandler.errorReg("Variable '" + node->varName + "' already defined in this scope.", 0);
+    if(symbols.lookupCurrent(node->varName)){
+        diag->errorReg(ErrorCode::VARDECL_SYMBOL_ALREADY_DEFINED, {node->varName}, node->getLocation());
         return;
     }
     auto varType = node->type; 
 
     if(node->initializer){
-        auto initType = visit(node->initializer.get());
+        auto initType = visit(node->initializer);
         if (!initType) {
-            errorHandler.errorReg("Cannot determine type of initializer for variable '" + node->varName + "'.", 0);
+            diag->errorReg(ErrorCode::VARDECL_CANNOT_DETERMINE_TYPE, {node->varName}, node->getLocation());
             return;
         }
 
         if (!varType) {
             varType = initType;
             node->type = initType;
-        } else if (varType->getTypeName() != initType->getTypeName()) {
-            errorHandler.errorReg("Initializer type mismatch for variable '" + node->varName + "'.", 0);
+        } else if (varType != initType) {
+            diag->errorReg(ErrorCode::VARDECL_INIT_TYPE_MISMATCH, {node->varName, varType, initType}, node->getLocation());
         }
     }
 
     if (!varType) {
-        errorHandler.errorReg("Variable '" + node->varName + "' has no type and no initializer.", 0);
+        diag->errorReg(ErrorCode::VARDECL_NO_TYPE_AND_INIT, {node->varName}, node->getLocation());
         return;
     }
 
-    if (dynamic_cast<ArrayTypeNode*>(varType.get())) {
-        auto arraySymbol = std::make_shared<ArraySymbol>(node->varName, varType, currentScope);
-        currentScope->define(arraySymbol);
+    if (varType->getKind() == TypeKind::Array) {
+        auto arraySymbol = compiler.getAstContext().createSymbol<ArraySymbol>(node->varName, varType, symbols.depth());
+        symbols.define(arraySymbol);
         node->symbol = arraySymbol;
     } else {
-        auto varSymbol = std::make_shared<VarSymbol>(node->varName, varType, currentScope);
-        currentScope->define(varSymbol);
+        auto varSymbol = compiler.getAstContext().createSymbol<VarSymbol>(node->varName, varType, symbols.depth());
+        symbols.define(varSymbol);
         node->symbol = varSymbol;
     }
 }
 
 void SemanticAnalysis::visit(ArrayDeclNode *node){
-    if(currentScope->lookupCurrent(node->arrayName)){
-        errorHandler.errorReg("Array '" + node->arrayName + "' already defined in this scope.", 0);
+    if(symbols.lookupCurrent(node->arrayName)){
+        diag->errorReg(ErrorCode::VARDECL_SYMBOL_ALREADY_DEFINED, {node->arrayName}, node->getLocation());
         return;
     }
     auto arrayType = node->type;
     // TODO: 初期化式
-    auto arraySymbol = std::make_shared<ArraySymbol>(node->arrayName, arrayType, currentScope);
-    currentScope->define(arraySymbol);
+    auto arraySymbol = compiler.getAstContext().createSymbol<ArraySymbol>(node->arrayName, arrayType, symbols.depth());
+    symbols.define(arraySymbol);
     node->symbol = arraySymbol;
 }
 
-std::shared_ptr<TypeNode> SemanticAnalysis::visit(BinaryOpNode *node){
-    std::shared_ptr<TypeNode> leftType = visit(node->left.get());
-    std::shared_ptr<TypeNode> rightType = visit(node->right.get());
+TypeNode* SemanticAnalysis::visit(BinaryOpNode *node){
+    TypeNode* leftType = visit(node->left);
+    TypeNode* rightType = visit(node->right);
     if(!leftType || !rightType){
         return nullptr;
     }
-    if(leftType->getTypeName() != rightType->getTypeName()){
-        errorHandler.errorReg(ErrorCode::BINARYOP_OPERAND_MISMATCH, {node->op, leftType->getTypeName(), rightType->getTypeName()});
+    if(leftType != rightType){
+        diag->errorReg(ErrorCode::BINARYOP_OPERAND_MISMATCH, {node->op, leftType, rightType}, node->getLocation());
         return nullptr;
     }
     
     // 比較演算子はboolを返す
     if(node->op == "==" || node->op == "!=" || node->op == "<" || node->op == ">" || node->op == "<=" || node->op == ">="){
-        node->type = typePtr["bool"]->shared_from_this();
-        return typePtr["bool"];
+        node->type = boolType;
+        return boolType;
     }
 
-    node->type = leftType->shared_from_this();
+    node->type = leftType;
     return leftType;
 }
 
-std::shared_ptr<TypeNode> SemanticAnalysis::visit(FunctionCallNode *node){
-    auto symbol = currentScope->lookup(node->calleeName);
-    if(node->calleeName == "input" || node->calleeName == "print"){
+TypeNode* SemanticAnalysis::visit(FunctionCallNode *node){
+    auto symbol = symbols.lookup(node->calleeName);
+    if(node->calleeName == inputName || node->calleeName == printName){
+        // print(式) と input(変数) は引数を1つだけ取り、値を返さない
+        if(node->args.size() != 1){
+            diag->errorReg(ErrorCode::FUNCCALL_ARG_SIZE_MISMATCH, {node->calleeName, 1, node->args.size()}, node->getLocation());
+            return nullptr;
+        }
+        if(node->calleeName == inputName && !llvm::isa<VariableRefNode>(node->args[0])){
+            diag->errorReg(ErrorCode::INPUT_NOT_VARIABLE, {}, node->getLocation());
+            return nullptr;
+        }
+        visit(node->args[0]);
         return nullptr;
     }
     if(!symbol){
-        errorHandler.errorReg("Function '" + node->calleeName + "' not defined.", 0);
+        diag->errorReg(ErrorCode::FUNCCALL_NOT_DEFINED, {node->calleeName}, node->getLocation());
         return nullptr;
     }
     if(symbol->kind != SymbolKind::FUNC){
-        errorHandler.errorReg("'" + node->calleeName + "' is not a function.", 0);
+        diag->errorReg(ErrorCode::FUNCCALL_NOT_FUNC_CALL, {node->calleeName}, node->getLocation());
         return nullptr;
     }
-    auto funcSymbol = std::static_pointer_cast<FuncSymbol>(symbol);
+    auto funcSymbol = static_cast<FuncSymbol*>(symbol);
     if(node->args.size() != funcSymbol->parameters.size()){
-        errorHandler.errorReg("Incorrect number of arguments for function '" + node->calleeName + "'.", 0);
+        diag->errorReg(ErrorCode::FUNCCALL_ARG_SIZE_MISMATCH, {node->calleeName, funcSymbol->parameters.size(), node->args.size()}, node->getLocation());
     }
     for(size_t i = 0;i < node->args.size() && i < funcSymbol->parameters.size();i++){
-        auto argType = visit(node->args[i].get());
+        auto argType = visit(node->args[i]);
         auto paramType = funcSymbol->parameters[i]->type;
-        if(argType && paramType && argType.get()->getTypeName() != paramType.get()->getTypeName()){
-            errorHandler.errorReg("Type mismatch for argument " + std::to_string(i + 1) + " of function '"
-            + node->calleeName + "'.", 0);
+        if(argType && paramType && argType != paramType){
+            diag->errorReg(ErrorCode::FUNCCALL_ARG_TYPE_MISMATCH, {i + 1, node->calleeName, paramType, argType}, node->getLocation());
         }
     }
     node->symbol = funcSymbol;
+    node->type = funcSymbol->type;
     return funcSymbol->type;
 }
 
 void SemanticAnalysis::visit(AssignmentNode *node){
-    auto varSymbol = currentScope->lookup(node->varName);
+    auto varSymbol = symbols.lookup(node->varName);
     if(!varSymbol){
-        errorHandler.errorReg(ErrorCode::ASSIGNMENT_NOT_DEFINED, {node->varName});
+        diag->errorReg(ErrorCode::ASSIGNMENT_NOT_DEFINED, {node->varName}, node->getLocation());
         return;
     }
     if(varSymbol->kind != SymbolKind::VAR){
-        errorHandler.errorReg(ErrorCode::ASSIGNMENT_NOT_VARIABLE, {node->varName});
+        diag->errorReg(ErrorCode::ASSIGNMENT_NOT_VARIABLE, {node->varName}, node->getLocation());
         return;
     }
     node->symbol = varSymbol;
-    std::shared_ptr<TypeNode> varType = varSymbol->type;
-    std::shared_ptr<TypeNode> valueType = visit(node->value.get());
+    TypeNode* varType = varSymbol->type;
+    TypeNode* valueType = visit(node->value);
     if(!valueType){
         // visitしたときにエラーメッセージが出ているはず
         return;
     }
-    if(varType->getTypeName() != valueType->getTypeName()){
-        errorHandler.errorReg(ErrorCode::ASSIGNMENT_TYPE_MISMATCH, {valueType->getTypeName(), node->varName, varType->getTypeName()});
+    if(varType != valueType){
+        diag->errorReg(ErrorCode::ASSIGNMENT_TYPE_MISMATCH, {valueType, node->varName, varType}, node->getLocation());
         return;
     }
     return;
 }
 
-std::shared_ptr<TypeNode> SemanticAnalysis::visit(NumberLiteralNode *node){
-    node->type = typePtr["int"]->shared_from_this();
-    return typePtr["int"];
+TypeNode* SemanticAnalysis::visit(NumberLiteralNode *node){
+    node->type = intType;
+    return intType;
 }
-std::shared_ptr<TypeNode> SemanticAnalysis::visit(DecimalLiteralNode *node){
-    node->type = typePtr["float"]->shared_from_this();
-    return typePtr["float"];
+TypeNode* SemanticAnalysis::visit(DecimalLiteralNode *node){
+    node->type = floatType;
+    return floatType;
 }
-std::shared_ptr<TypeNode> SemanticAnalysis::visit(VariableRefNode *node){
-    auto symbol = currentScope->lookup(node->name);
+TypeNode* SemanticAnalysis::visit(VariableRefNode *node){
+    auto symbol = symbols.lookup(node->name);
     if(!symbol){
-        errorHandler.errorReg("Variable '" + node->name + "' not defined.", 0);
+        diag->errorReg(ErrorCode::VARREF_NOT_DEFINED, {node->name}, node->getLocation());
         return nullptr;
     }
     if(symbol->kind != SymbolKind::VAR){
-        errorHandler.errorReg("'" + node->name + "' is not a variable.", 0);
+        diag->errorReg(ErrorCode::VARREF_NOT_VARIABLE, {node->name}, node->getLocation());
         return nullptr;
     }
     node->symbol = symbol;
     node->type = symbol->type;
     return symbol->type;
 }
-std::shared_ptr<TypeNode> SemanticAnalysis::visit(ArrayRefNode *node){
-    auto symbol = currentScope->lookup(node->name);
+TypeNode* SemanticAnalysis::visit(ArrayRefNode *node){
+    auto symbol = symbols.lookup(node->name);
     if(!symbol){
-        errorHandler.errorReg("Array '" + node->name + "' not defined.", 0);
+        diag->errorReg(ErrorCode::ARRAYREF_NOT_DEFINED, {node->name}, node->getLocation());
         return nullptr;
     }
     if(symbol->kind != SymbolKind::ARRAY){
-        errorHandler.errorReg("'" + node->name + "' is not a array.", 0);
+        diag->errorReg(ErrorCode::ARRAYREF_NOT_ARRAY, {node->name}, node->getLocation());
         return nullptr;
     }
     node->symbol = symbol;
 
-    // 配列の要素型を取得
-    std::string arrayTypeName = symbol->type->getTypeName(); // 例: "int[5]"
-    size_t bracketPos = arrayTypeName.find('[');
-    if (bracketPos == std::string::npos) {
-        errorHandler.errorReg("Internal error: Array symbol type name does not contain brackets.", 0);
+    // 配列の要素型を取得 (配列型が要素型を持っている)
+    if (!symbol->type || symbol->type->getKind() != TypeKind::Array) {
+        diag->errorReg(ErrorCode::ARRAYREF_TYPE_NOT_ARRAY, {}, node->getLocation());
         return nullptr;
     }
-    std::string elementTypeName = arrayTypeName.substr(0, bracketPos); // 例: "int"
-
-    std::shared_ptr<TypeNode> elementType = getType(elementTypeName); // 基本型マップから取得
+    TypeNode* elementType = static_cast<ArrayTypeNode*>(symbol->type)->elementType;
     if (!elementType) {
-        errorHandler.errorReg("Internal error: Could not determine element type for array '" + node->name + "'.", 0);
+        diag->errorReg(ErrorCode::ARRAYREF_NO_ELEMENT_TYPE, {node->name}, node->getLocation());
         return nullptr;
     }
     node->type = elementType; // ArrayRefNodeの型は要素型
 
     // インデックス式の型をチェック
-    std::shared_ptr<TypeNode> indexType = visit(node->idx.get());
-    if (!indexType || indexType->getTypeName() != "int") {
-        errorHandler.errorReg("Array index must be an integer for array '" + node->name + "'.", 0);
+    TypeNode* indexType = visit(node->idx);
+    if (!indexType || indexType != intType) {
+        diag->errorReg(ErrorCode::ARRAYREF_INDEX_NOT_INT, {node->name}, node->getLocation());
         return nullptr;
     }
 
     return elementType;
 }
-std::shared_ptr<TypeNode> SemanticAnalysis::visit(CastNode *node){
-    std::shared_ptr<TypeNode> exprType = visit(node->expression.get());
+TypeNode* SemanticAnalysis::visit(CastNode *node){
+    TypeNode* exprType = visit(node->expression);
     if(!exprType){
         // visitするときにエラーが出ているはず
         return nullptr;
     }
     if(!node->type){
-        errorHandler.compilerErrorReg(CompilerErrorCode::CAST_NODE_TYPE_NULL, {});
+        // 組み込みの型でない型名 (配列型など) へのキャスト
+        diag->errorReg(ErrorCode::CAST_INVALID_TYPE, {}, node->getLocation());
         return nullptr;
     }
-    TypeNode* type = node->type.get();
-    std::string typeName;
-    if(auto cnode = dynamic_cast<BasicTypeNode*>(type)) typeName = cnode->getTypeName();
-    else{
-        errorHandler.errorReg(ErrorCode::CAST_TO_NON_BASIC, {});
+    TypeNode* type = node->type;
+    bool isBasic = type->getKind() == TypeKind::Basic;
+    if(!isBasic){
+        diag->errorReg(ErrorCode::CAST_TO_NON_BASIC, {}, node->getLocation());
     }
-    if(!is_type(typeName)){
-        errorHandler.errorReg(ErrorCode::CAST_INVALID_TYPE, {});
+    if(!isBasic || !is_type(type->getTypeName())){
+        diag->errorReg(ErrorCode::CAST_INVALID_TYPE, {}, node->getLocation());
         return nullptr;
     }
     // TODO: 有効なキャストか確かめる処理
     return node->type;
 }
 
-std::shared_ptr<TypeNode> SemanticAnalysis::visit(ArrayLiteralNode *node){
+TypeNode* SemanticAnalysis::visit(ArrayLiteralNode *node){
     if(node->elem.empty()){
         // 警告: 配列リテラルの中身がからです。　的な
         return node->type;
     }
     // 最初の要素の型を基準にして一致しているか確かめる
-    std::shared_ptr<TypeNode> firstElementType = visit(node->elem[0].get());
+    TypeNode* firstElementType = visit(node->elem[0]);
     if(!firstElementType){
         return nullptr;
     }
     for(size_t i = 1;i < node->elem.size();i++){
-        auto elementType = visit(node->elem[i].get());
-        if(elementType->getTypeName() != firstElementType->getTypeName()){
+        auto elementType = visit(node->elem[i]);
+        if(elementType != firstElementType){
             // TODO: エラー: 配列リテラルの要素の型が一致していません。
             return nullptr;
         }
     }
-    auto basicElementType = std::dynamic_pointer_cast<BasicTypeNode>(firstElementType);
-    if(!basicElementType){
+    if(firstElementType->getKind() != TypeKind::Basic){
         // エラー: 配列の要素は基本型である必要があります
         return nullptr;
     }
-    std::string arrayTypeName = basicElementType->getTypeName() + "[" + std::to_string(node->elem.size()) + "]";
-    node->type = std::make_shared<ArrayTypeNode>(arrayTypeName, node->elem.size(), basicElementType);
+    node->type = compiler.getTypeContext().getArrayType(firstElementType, node->elem.size());
     return node->type;
 }
 
 // 式以外
+// トップレベル以外の関数定義は、その場で登録して本体を解析する
 void SemanticAnalysis::visit(FunctionDefNode *node){
+    if(declareFunction(node)) analyzeFunctionBody(node);
+}
+
+bool SemanticAnalysis::declareFunction(FunctionDefNode *node){
     // FuncSymbol作成
     auto returnType = node->returnType;
-    auto funcSymbol = std::make_shared<FuncSymbol>(node->name, returnType, currentScope);
+    auto funcSymbol = compiler.getAstContext().createSymbol<FuncSymbol>(node->name, returnType, symbols.depth());
     // 関数定義
-    if(!currentScope->define(funcSymbol)){
-        errorHandler.errorReg("Function '" + node->name + "' already defined.", 0);
-        return;
+    if(!symbols.define(funcSymbol)){
+        diag->errorReg(ErrorCode::FUNCDEF_ALREADY_DEFINED, {node->name}, node->getLocation());
+        node->symbol = nullptr;
+        return false;
     }
     // ASTノードにシンボル紐づけ
     node->symbol = funcSymbol;
+    // 引数 (呼び出し側の型検査で使うので、本体より先に作る)
+    for(size_t i = 0;i < node->args.size();i++){
+        funcSymbol->addParameter(compiler.getAstContext().createSymbol<VarSymbol>(node->args[i], node->argTypes[i], symbols.depth() + 1));
+    }
+    return true;
+}
 
+void SemanticAnalysis::analyzeFunctionBody(FunctionDefNode *node){
+    auto funcSymbol = node->symbol;
     // 以前の戻り値の型を保存
     auto prevReturnType = currentFunctionReturnType;
-    currentFunctionReturnType = node->returnType.get();
+    currentFunctionReturnType = node->returnType;
 
     // 関数用の新しいスコープに入る
     auto prevFunction = currentFunction;
     currentFunction = funcSymbol;
     enterScope();
-    funcSymbol->funcScope = currentScope;
     // 引数を定義
-    for(size_t i = 0;i < node->args.size();i++){
-        auto argType = node->argTypes[i];
-        auto argSymbol = std::make_shared<VarSymbol>(node->args[i], argType, currentScope);
-        if(!currentScope->define(argSymbol)){
-            errorHandler.errorReg("Argument '" + node->args[i] + "' redefined.", 0);
+    for(size_t i = 0;i < funcSymbol->parameters.size();i++){
+        if(!symbols.define(funcSymbol->parameters[i])){
+            diag->errorReg(ErrorCode::FUNCDEF_ARG_REDEFINED, {node->args[i]}, node->getLocation());
         }
-        funcSymbol->addParameter(argSymbol);
     }
     // 関数本体を解析
-    visit(node->body.get());
+    visit(node->body);
     // スコープとコンテキストを抜ける
     leaveScope();
     currentFunction = prevFunction;
     // 以前の戻り値の型に戻す
     currentFunctionReturnType = prevReturnType;
 }
-void SemanticAnalysis::visit(ProgramNode *node){
-    for(auto stmt : node->statements){
-        visit(stmt.get());
-    }
-}
 void SemanticAnalysis::visit(BlockNode *node){
     enterScope();
     for(auto stmt : node->statements){
-        visit(stmt.get());
+        visit(stmt);
     }
     leaveScope();
 }
 void SemanticAnalysis::visit(IfNode *node){
-    std::shared_ptr<TypeNode> condType = visit(node->condition.get());
-    if(condType->getTypeName() != "bool"){
-        errorHandler.errorReg(ErrorCode::FOR_NOT_BOOL, {condType->getTypeName()});
+    TypeNode* condType = visit(node->condition);
+    if(!condType){
+        // visitしたときにエラーメッセージが出ているはず
+        return;
+    }
+    if(condType != boolType){
+        diag->errorReg(ErrorCode::IF_NOT_BOOL, {condType}, node->condition->getLocation());
         return;
     }
-    visit(node->if_block.get());
+    visit(node->if_block);
     if(node->else_block){
-        visit(node->else_block.get());
+        visit(node->else_block);
     }
 }
 void SemanticAnalysis::visit(ForNode *node){
-    std::shared_ptr<TypeNode> condType = visit(node->condition.get());
-    if(condType->getTypeName() != "bool"){
-        errorHandler.errorReg(ErrorCode::FOR_NOT_BOOL, {condType->getTypeName()});
+    TypeNode* condType = visit(node->condition);
+    if(!condType){
+        // visitしたときにエラーメッセージが出ているはず
         return;
     }
-    visit(node->block.get());
+    if(condType != boolType){
+        diag->errorReg(ErrorCode::FOR_NOT_BOOL, {condType}, node->condition->getLocation());
+        return;
+    }
+    visit(node->block);
 }
 void SemanticAnalysis::visit(ReturnNode *node){
     if(!currentFunctionReturnType){
-        errorHandler.errorReg("Return statement outside of a function.", 0);
+        diag->errorReg(ErrorCode::RETURN_OUTSIDE_FUNCTION, {}, node->getLocation());
         return;
     }
     if(node->returnValue){
-        TypeNode* returnExprType = visit(node->returnValue.get()).get();
+        TypeNode* returnExprType = visit(node->returnValue);
         if(returnExprType){
-            if (returnExprType->getTypeName() == "unknown" || 
-            (dynamic_cast<NumberLiteralNode*>(node->returnValue.get()) && returnExprType->getTypeName()== "int")){
-                node->returnValue->type = currentFunctionReturnType->shared_from_this();
+            if (returnExprType == unknownType || 
+            (llvm::isa<NumberLiteralNode>(node->returnValue) && returnExprType == intType)){
+                node->returnValue->type = currentFunctionReturnType;
                 returnExprType = currentFunctionReturnType;
             }
-            if(returnExprType->getTypeName() != currentFunctionReturnType->getTypeName()){
-                errorHandler.errorReg("Return type mismatch. Expected '" + currentFunctionReturnType->getTypeName() 
-                + "' but got '" + returnExprType->getTypeName() + "'.", 0);
+            if(returnExprType != currentFunctionReturnType){
+                diag->errorReg(ErrorCode::RETURN_TYPE_MISMATCH, {currentFunctionReturnType, returnExprType}, node->getLocation());
             }
         }
     }else{
-        if(currentFunctionReturnType->getTypeName() != "void"){
-            errorHandler.errorReg("Return value expected for function returning '" + currentFunctionReturnType->getTypeName()
-            + "'.", 0);
+        if(currentFunctionReturnType != voidType){
+            diag->errorReg(ErrorCode::RETURN_VALUE_EXPECTED, {currentFunctionReturnType}, node->getLocation());
         }
     }
 }
 void SemanticAnalysis::visit(ExprStatementNode *node){
     if(node->expression){
-        visit(node->expression.get());
+        visit(node->expression);
     }else{
-        errorHandler.warnReg(WarnCode::EXPR_STMT_NO_EXPR, {});
+        diag->warnReg(WarnCode::EXPR_STMT_NO_EXPR, {}, node->getLocation());
     }
 }
 
 void SemanticAnalysis::visit(StatementNode *node){
-    if(auto cnode = dynamic_cast<BlockNode*>(node)) return visit(cnode);
-    if(auto cnode = dynamic_cast<FunctionDefNode*>(node)) return visit(cnode);
-    if(auto cnode = dynamic_cast<IfNode*>(node)) return visit(cnode);
-    if(auto cnode = dynamic_cast<ForNode*>(node)) return visit(cnode);
-    if(auto cnode = dynamic_cast<ReturnNode*>(node)) return visit(cnode);
-    if(auto cnode = dynamic_cast<VarDeclNode*>(node)) return visit(cnode);
-    if(auto cnode = dynamic_cast<AssignmentNode*>(node)) return visit(cnode);
-    if(auto cnode = dynamic_cast<ExprStatementNode*>(node)) return visit(cnode);
-    if(auto cnode = dynamic_cast<ArrayDeclNode*>(node)) return visit(cnode);
-    else{
-        errorHandler.compilerErrorReg(CompilerErrorCode::STMT_VISIT_COULDNOT_CAST, {std::string(typeid(*node).name())});
-    }
+    dispatch(node);
+}
+void SemanticAnalysis::unhandledStatement(StatementNode *node){
+    diag->compilerErrorReg(CompilerErrorCode::STMT_VISIT_COULDNOT_CAST, {static_cast<int>(node->getKind())}, node->getLocation());
 }
 
-std::shared_ptr<TypeNode> SemanticAnalysis::getType(const std::string& name) const {
-    auto it = typePtr.find(name);
-    if (it != typePtr.end()) {
-        return it->second;
-    }
-    return nullptr;
+TypeNode* SemanticAnalysis::getType(const std::string& name) const {
+    return compiler.getTypeContext().lookupBuiltinType(name);
 }
\ No newline at end of file
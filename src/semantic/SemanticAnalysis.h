@@ -1,4 +1,5 @@
 #pragma once
+#include "ast/AstVisitor.h"
 #include "ast/Definition.h"
 #include "types/Type.h"
 #include <llvm/IR/Value.h>
@@ -9,6 +10,7 @@
 #include <map>
 #include <memory>
 #include "Symbol.h"
+#include "common/ErrorHandler.h"
 
 // Forward declarations for AST nodes
 class ProgramNode;
@@ -27,49 +29,70 @@ class DecimalLiteralNode;
 class VariableRefNode;
 class CastNode;
 class ExprNode;
+class CompilerInstance;
 
 
-class SemanticAnalysis{
+class SemanticAnalysis : public AstVisitor<SemanticAnalysis, TypeNode*>{
+    friend class AstVisitor<SemanticAnalysis, TypeNode*>;
 private:
-    std::shared_ptr<Scope> currentScope;
+    CompilerInstance& compiler; // 型・文字列表・エラーの持ち主
+    SymbolTable symbols; // 全てのスコープのシンボル
     void enterScope();
     void leaveScope();
-    // 基本型
-    std::unordered_map<std::string, std::shared_ptr<TypeNode>> typePtr;
-    bool is_type(std::string typeName);
+    // 基本型 (TypeContextの型をそのまま使う)
+    TypeNode* intType;
+    TypeNode* floatType;
+    TypeNode* boolType;
+    TypeNode* voidType;
+    TypeNode* unknownType; // 型が決まらなかった式の型 (名前ではなくポインタで比べる)
+    bool is_type(const std::string& typeName);
     TypeNode* currentFunctionReturnType = nullptr;
+    // 組み込み関数の名前
+    NameId inputName;
+    NameId printName;
+    ErrorHandler* diag; // エラーの登録先 (解析中は文・関数ごとのバッファ)
+    unsigned threads = 0; // 関数本体を並列に解析するスレッド数 (0なら並列化しない)
+    // 関数本体を解析するためのワーカー (グローバルスコープはparentのものを読むだけ)
+    SemanticAnalysis(const SemanticAnalysis& parent, ErrorHandler& diagnostics);
+    // 関数のシグネチャ(FuncSymbolと引数)を今のスコープに登録する (定義済みならfalse)
+    bool declareFunction(FunctionDefNode *node);
+    // declareFunctionで登録した関数の本体を解析する
+    void analyzeFunctionBody(FunctionDefNode *node);
 public:
     // コンストラクタ
-    SemanticAnalysis();
+    explicit SemanticAnalysis(CompilerInstance& compiler);
+    // 関数本体を並列に解析するスレッド数 (-sema-threads)
+    void setThreads(unsigned n) {threads = n;}
     // main用
     // エラーがあるか
     bool hasErrors();
-    std::shared_ptr<TypeNode> getType(const std::string& name) const; // ゲッターを追加
-    void analyze(std::shared_ptr<ProgramNode> root);
+    TypeNode* getType(const std::string& name) const; // ゲッターを追加
+    void analyze(ProgramNode* root);
 private:
     // visit処理
-    std::shared_ptr<TypeNode> visit(BinaryOpNode *node);
-    std::shared_ptr<TypeNode> visit(FunctionCallNode *node);
+    TypeNode* visit(BinaryOpNode *node);
+    TypeNode* visit(FunctionCallNode *node);
     void visit(AssignmentNode *node);
-    std::shared_ptr<TypeNode> visit(NumberLiteralNode *node);
-    std::shared_ptr<TypeNode> visit(DecimalLiteralNode *node);
-    std::shared_ptr<TypeNode> visit(VariableRefNode *node);
-    std::shared_ptr<TypeNode> visit(ArrayRefNode *node);
-    std::shared_ptr<TypeNode> visit(CastNode *node);
-    std::shared_ptr<TypeNode> visit(ArrayLiteralNode *node);
+    TypeNode* visit(NumberLiteralNode *node);
+    TypeNode* visit(DecimalLiteralNode *node);
+    TypeNode* visit(VariableRefNode *node);
+    TypeNode* visit(ArrayRefNode *node);
+    TypeNode* visit(CastNode *node);
+    TypeNode* visit(ArrayLiteralNode *node);
     void visit(VarDeclNode *node);
     void visit(ArrayDeclNode *node);
-    std::shared_ptr<TypeNode> visit(ExprNode *node); // 振り分け用
+    TypeNode* visit(ExprNode *node); // 振り分け用
     // 式以外
     void visit(FunctionDefNode *node);
-    void visit(ProgramNode *node); // 各要素をvisit
     void visit(BlockNode *node); // enterScope() -> visit -> leaveScope()
     void visit(IfNode *node); // conditionをvisit -> boolか確認 -> thenとelseをvisit(blockなのでvisit(if_block)のみでいい)
     void visit(ForNode *node); // Ifと同じ
     void visit(ReturnNode *node); // fnの戻り値と型が同じか調べる
     void visit(ExprStatementNode *node); // 中身のexprを呼び出すだけ
     void visit(StatementNode *node); // 振り分け用
+    // 知らない種類のノード (AstVisitorから呼ばれる)
+    TypeNode* unhandledExpr(ExprNode *node);
+    void unhandledStatement(StatementNode *node);
 private:
-    std::shared_ptr<Scope> globalScope;
-    std::shared_ptr<FuncSymbol> currentFunction;
+    FuncSymbol* currentFunction = nullptr;
 };
\ No newline at end of file
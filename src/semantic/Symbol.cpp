@@ -1,36 +1,61 @@
 #include "Symbol.h"
 
-// シンボルをスコープに定義する
-bool Scope::define(std::shared_ptr<Symbol> sym){
-    if(symbols.count(sym->name)){
-        return false; // このスコープで定義済み
+// シンボルを今のスコープに定義する
+bool SymbolTable::define(Symbol* sym){
+    uint32_t shadowed = NoBinding;
+    auto it = visible.find(sym->name);
+    if(it != visible.end()){
+        if(bindings[it->second].depth == depth()) return false; // このスコープで定義済み
+        shadowed = it->second;
     }
-    symbols[sym->name] = sym;
+    uint32_t index = static_cast<uint32_t>(bindings.size());
+    NameId name = sym->name;
+    bindings.push_back({sym, depth(), shadowed});
+    visible[name] = index;
     return true;
 }
 
-// シンボルを現在のスコープから再帰的に親スコープまで探す
-std::shared_ptr<Symbol> Scope::lookup(const std::string& name){
-    // 現在のスコープ
-    auto it = symbols.find(name);
-    if(it != symbols.end()) return it->second; // 見つかったとき
-    // 見つからなければ親スコープで探す
-    if(parent) return parent->lookup(name); // 再起で全部調べる
+// 今のスコープで定義したシンボルを外し、隠していた外側のシンボルを見えるように戻す
+bool SymbolTable::leaveScope(){
+    if(scopeStarts.empty()) return false;
+    uint32_t start = scopeStarts.back();
+    scopeStarts.pop_back();
+    while(bindings.size() > start){
+        Binding& binding = bindings.back();
+        if(binding.shadowed != NoBinding) visible[binding.symbol->name] = binding.shadowed;
+        else visible.erase(binding.symbol->name);
+        bindings.pop_back();
+    }
+    return true;
+}
+
+Symbol* SymbolTable::lookup(NameId name) const {
+    auto it = visible.find(name);
+    if(it != visible.end()) return bindings[it->second].symbol;
+    if(outer) return outer->lookup(name);
     return nullptr;
 }
 
-// シンボルを現在のスコープのみで探す
-std::shared_ptr<Symbol> Scope::lookupCurrent(const std::string& name){
-    auto it = symbols.find(name);
-    if(it != symbols.end()) return it->second;
+Symbol* SymbolTable::lookupCurrent(NameId name) const {
+    auto it = visible.find(name);
+    if(it != visible.end() && bindings[it->second].depth == depth()) return bindings[it->second].symbol;
     return nullptr;
 }
 
-void Scope::dump(std::ostream& os, int indent) const {
-    os << std::string(indent, ' ') << "Scope {" << std::endl;
-    for(const auto& pair : symbols){
-        pair.second->dump(os, indent + 2);
+void SymbolTable::clear(){
+    bindings.clear();
+    visible.clear();
+    scopeStarts.clear();
+}
+
+// 今見えているシンボルを定義した順に出力する
+void SymbolTable::dump(std::ostream& os, const StringInterner& names, int indent) const {
+    os << std::string(indent, ' ') << "SymbolTable (Depth: " << depth() << ") {" << std::endl;
+    for(uint32_t i = 0; i < bindings.size(); i++){
+        auto it = visible.find(bindings[i].symbol->name);
+        if(it == visible.end() || it->second != i) continue;
+        bindings[i].symbol->dump(os, names, indent + 2);
         os << std::endl;
     }
     os << std::string(indent, ' ') << "}" << std::endl;
-}
\ No newline at end of file
+}
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "types/Type.h"
-#include <map>
+#include "common/StringInterner.h"
+#include <cstdint>
+#include <unordered_map>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -9,7 +11,6 @@
 #include <memory>
 
 class Symbol;
-class Scope;
 
 enum class SymbolKind{
     VAR,
@@ -22,51 +23,50 @@ enum class SymbolKind{
 class Symbol{
 public:
     SymbolKind kind;
-    std::string name;
-    std::shared_ptr<TypeNode> type; // 関数の戻り値・変数の型
-    std::shared_ptr<Scope> scope;
-    Symbol(const std:: string& name, SymbolKind kind, std::shared_ptr<TypeNode> type, std::shared_ptr<Scope> scope)
-        : name(name), kind(kind), type(type), scope(scope) {}
+    NameId name;
+    TypeNode* type; // 関数の戻り値・変数の型
+    uint32_t scopeDepth; // 定義されたスコープの深さ (グローバルが0)
+    Symbol(NameId name, SymbolKind kind, TypeNode* type, uint32_t depth)
+        : name(name), kind(kind), type(type), scopeDepth(depth) {}
     virtual ~Symbol() = default;
-    virtual void dump(std::ostream& os, int indent = 0) const{
-        os << std::string(indent, ' ') << name << "(Kind: " << (int)kind << ", Type: " << 
+    virtual void dump(std::ostream& os, const StringInterner& names, int indent = 0) const{
+        os << std::string(indent, ' ') << names.str(name) << "(Kind: " << (int)kind << ", Type: " << 
         (type ? type->getTypeName() : "N/A") << ")";
     }
 };
 
 class VarSymbol : public Symbol{
 public:
-    VarSymbol(const std::string& name, std::shared_ptr<TypeNode> type, std::shared_ptr<Scope> scope)
-        : Symbol(name, SymbolKind::VAR, type, scope) {}
-    void dump(std::ostream& os, int indent = 0) const override {
-        os << std::string(indent, ' ') << "VarSymbol: " << name << " (Type: " << 
+    VarSymbol(NameId name, TypeNode* type, uint32_t depth)
+        : Symbol(name, SymbolKind::VAR, type, depth) {}
+    void dump(std::ostream& os, const StringInterner& names, int indent = 0) const override {
+        os << std::string(indent, ' ') << "VarSymbol: " << names.str(name) << " (Type: " << 
         (type ? type->getTypeName() : "N/A") << ")";
     }
 };
 
 class ArraySymbol : public Symbol{
 public:
-    ArraySymbol(const std::string& name, std::shared_ptr<TypeNode> type, std::shared_ptr<Scope> scope)
-        : Symbol(name, SymbolKind::ARRAY, type, scope) {}
-    void dump(std::ostream& os, int indent = 0) const override{
-        os << std::string(indent, ' ') << "ArraySymbol: " << name << " (Type: " <<
+    ArraySymbol(NameId name, TypeNode* type, uint32_t depth)
+        : Symbol(name, SymbolKind::ARRAY, type, depth) {}
+    void dump(std::ostream& os, const StringInterner& names, int indent = 0) const override{
+        os << std::string(indent, ' ') << "ArraySymbol: " << names.str(name) << " (Type: " <<
         (type ? type->getTypeName() : "N/A") << ")";
     }
 };
 
 class FuncSymbol : public Symbol{
 public:
-    std::vector<std::shared_ptr<VarSymbol>> parameters;
-    std::shared_ptr<Scope> funcScope; // 関数が作るスコープ
-    FuncSymbol(const std::string& name, std::shared_ptr<TypeNode> returnType, std::shared_ptr<Scope> scope)
-        : Symbol(name, SymbolKind::FUNC, returnType, scope) {}
-    void addParameter(std::shared_ptr<VarSymbol> param) {parameters.push_back(param);}
-    void dump(std::ostream& os, int indent = 0) const override{
-        os << std::string(indent, ' ') << "FuncSymbol: " << name << " (ReturnType: " << 
+    std::vector<VarSymbol*> parameters;
+    FuncSymbol(NameId name, TypeNode* returnType, uint32_t depth)
+        : Symbol(name, SymbolKind::FUNC, returnType, depth) {}
+    void addParameter(VarSymbol* param) {parameters.push_back(param);}
+    void dump(std::ostream& os, const StringInterner& names, int indent = 0) const override{
+        os << std::string(indent, ' ') << "FuncSymbol: " << names.str(name) << " (ReturnType: " << 
         (type ? type->getTypeName() : "N/A") << ")" << std::endl;
         for(const auto& param : parameters){
             os << std::string(indent + 2, ' ');
-            param->dump(os);
+            param->dump(os, names);
             os << std::endl;
         }
     }
@@ -74,21 +74,41 @@ public:
 
 class TypeSymbol : public Symbol{
 public:
-    TypeSymbol(const std::string& name, std::shared_ptr<TypeNode> type, std::shared_ptr<Scope> scope)
-        : Symbol(name, SymbolKind::TYPE, type, scope) {}
-    void dump(std::ostream& os, int indent = 0) const override{
-        os << std::string(indent, ' ') << "TypeSymbol: " << name << " (Represents: " <<
+    TypeSymbol(NameId name, TypeNode* type, uint32_t depth)
+        : Symbol(name, SymbolKind::TYPE, type, depth) {}
+    void dump(std::ostream& os, const StringInterner& names, int indent = 0) const override{
+        os << std::string(indent, ' ') << "TypeSymbol: " << names.str(name) << " (Represents: " <<
         (type ? type->getTypeName() : "N/A") << ")";
     }
 };
 
-class Scope : public std::enable_shared_from_this<Scope>{
+// 全てのスコープのシンボルを1つの表で持つ
+// 名前ごとに今見えているシンボルを1つだけハッシュ表に持ち、外側のスコープで同じ名前のシンボルは束縛のスタックでつなぐ
+// 名前の検索はスコープの深さによらずハッシュ表を1回引くだけで済み、スコープを抜けるときはそのスコープで定義した数だけ戻す
+class SymbolTable{
+private:
+    struct Binding{
+        Symbol* symbol;
+        uint32_t depth; // 定義したスコープの深さ
+        uint32_t shadowed; // 同じ名前で隠したbindingsの添字 (なければNoBinding)
+    };
+    static constexpr uint32_t NoBinding = UINT32_MAX;
+    std::vector<Binding> bindings; // 定義した順 (スコープを抜けるときに後ろから外す)
+    std::unordered_map<NameId, uint32_t> visible; // 名前 -> 今見えているbindingsの添字
+    std::vector<uint32_t> scopeStarts; // 各スコープに入ったときのbindingsの長さ
+    const SymbolTable* outer; // この表で見つからないときに探す表 (関数本体を並列に解析するときのグローバルスコープ。読むだけ)
 public:
-    std::shared_ptr<Scope> parent; // 親スコープ
-    std::map<std::string, std::shared_ptr<Symbol>> symbols; // このスコープに定義されたシンボル
-    Scope(std::shared_ptr<Scope> parent = nullptr) : parent(parent) {}
-    bool define(std::shared_ptr<Symbol> sym);
-    std::shared_ptr<Symbol> lookup(const std::string& name);
-    std::shared_ptr<Symbol> lookupCurrent(const std::string& name);
-    void dump(std::ostream& os, int indent = 0) const;
-};
\ No newline at end of file
+    explicit SymbolTable(const SymbolTable* outer = nullptr) : outer(outer) {}
+    void enterScope() {scopeStarts.push_back(static_cast<uint32_t>(bindings.size()));}
+    // グローバルスコープで呼ばれたときはfalse
+    bool leaveScope();
+    uint32_t depth() const {return static_cast<uint32_t>(scopeStarts.size());}
+    // 今のスコープで定義済みならfalse
+    bool define(Symbol* sym);
+    // 内側のスコープから順に探したときに見つかるシンボル (なければouterから探す)
+    Symbol* lookup(NameId name) const;
+    // 今のスコープで定義されたシンボルだけを探す
+    Symbol* lookupCurrent(NameId name) const;
+    void clear();
+    void dump(std::ostream& os, const StringInterner& names, int indent = 0) const;
+};
@@ -3,11 +3,25 @@
 #include <memory>
 #include <vector>
 
+// 型の種類 (dynamic_castせずに判別する)
+enum class TypeKind{
+    Basic,
+    Array
+};
+
 // すべての型の基底クラス
-class TypeNode : public std::enable_shared_from_this<TypeNode> {
+// 型はTypeContextが一つずつだけ作るので、同じ型かどうかはポインタの比較で判定できる
+class TypeNode{
+protected:
+    TypeKind kind;
+    std::string name; // 表示用の型名 (作るときに一度だけ組み立てる)
+    TypeNode(TypeKind k, const std::string& n) : kind(k), name(n) {}
 public:
     virtual ~TypeNode() = default;
-    virtual std::string getTypeName() const = 0;
+    TypeNode(const TypeNode&) = delete;
+    TypeNode& operator=(const TypeNode&) = delete;
+    TypeKind getKind() const {return kind;}
+    const std::string& getTypeName() const {return name;}
     virtual bool isInteger() const { return false; }
     virtual bool isFloat() const { return false; }
     virtual bool isNumeric() const { return isInteger() || isFloat(); }
@@ -15,22 +29,23 @@ public:
 
 // 基本的な型を表すノード
 class BasicTypeNode: public TypeNode{
+private:
+    bool integer;
+    bool floating;
 public:
-    std::string name;
-    BasicTypeNode(const std::string& n) : name(n){};
-    std::string getTypeName() const override {return name;}
-    bool isInteger() const override { return name == "int" || name == "int32" || name == "i32"; }
-    bool isFloat() const override { return name == "float" || name == "f32"; }
+    BasicTypeNode(const std::string& n)
+        : TypeNode(TypeKind::Basic, n), integer(n == "int" || n == "int32" || n == "i32"), floating(n == "float" || n == "f32") {}
+    bool isInteger() const override { return integer; }
+    bool isFloat() const override { return floating; }
 };
 
 // 配列の型を表すノード
 class ArrayTypeNode : public TypeNode{
 public:
-    std::string name;
+    TypeNode* elementType; // 要素の型
     size_t size;
-    std::shared_ptr<BasicTypeNode> arrType;
-    ArrayTypeNode(const std::string& n, size_t siz, std::shared_ptr<BasicTypeNode> t) : name(n), size(siz), arrType(t) {}
-    std::string getTypeName() const override {return name + "[" + std::to_string(size) + "]";}
+    ArrayTypeNode(TypeNode* elem, size_t siz)
+        : TypeNode(TypeKind::Array, elem->getTypeName() + "[" + std::to_string(siz) + "]"), elementType(elem), size(siz) {}
 };
 
 // ポインタの型を表すノード
@@ -40,4 +55,4 @@ public:
 //     PointerTypeNode(std::shared_ptr<TypeNode> pointee)
 //         : pointeeType(pointee) {}
 //     std::shared_ptr<TypeNode> getPointeeType() const { return pointeeType; }
-// };
\ No newline at end of file
+// };
@@ -0,0 +1,37 @@
+#include "TypeContext.h"
+
+TypeContext::TypeContext(){
+    intType = getBasicType("int");
+    getBasicType("i32");
+    getBasicType("char");
+    floatType = getBasicType("float");
+    getBasicType("f32");
+    boolType = getBasicType("bool");
+    voidType = getBasicType("void");
+    unknownType = std::make_unique<BasicTypeNode>("unknown");
+}
+
+BasicTypeNode* TypeContext::getBasicType(std::string_view name){
+    auto it = basicTypes.find(name);
+    if(it != basicTypes.end()) return it->second.get();
+    auto type = std::make_unique<BasicTypeNode>(std::string(name));
+    BasicTypeNode* result = type.get();
+    basicTypes.emplace(result->getTypeName(), std::move(type));
+    return result;
+}
+
+BasicTypeNode* TypeContext::lookupBuiltinType(std::string_view name) const {
+    if(name == "int" || name == "i32" || name == "char" || name == "float" ||
+       name == "f32" || name == "bool" || name == "void"){
+        auto it = basicTypes.find(name);
+        if(it != basicTypes.end()) return it->second.get();
+    }
+    return nullptr;
+}
+
+ArrayTypeNode* TypeContext::getArrayType(TypeNode* elementType, size_t size){
+    std::lock_guard<std::mutex> lock(arrayTypesMutex);
+    auto& slot = arrayTypes[{elementType, size}];
+    if(!slot) slot = std::make_unique<ArrayTypeNode>(elementType, size);
+    return slot.get();
+}
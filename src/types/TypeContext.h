@@ -0,0 +1,45 @@
+#pragma once
+#include "types/Type.h"
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+// 型を一意に作って持っておく (コンパイル1回で共有。CompilerInstanceが持つ)
+// 同じ型は必ず同じポインタになるので、型の比較はポインタの比較で済む
+// 型はTypeContextが最後まで持っているので、AST・シンボルは生ポインタで参照する
+class TypeContext{
+private:
+    struct ArrayKeyHash{
+        size_t operator()(const std::pair<TypeNode*, size_t>& key) const noexcept {
+            return std::hash<TypeNode*>()(key.first) ^ (std::hash<size_t>()(key.second) * 31);
+        }
+    };
+    std::unordered_map<std::string_view, std::unique_ptr<BasicTypeNode>> basicTypes; // キーは型自身の名前を指す
+    std::unordered_map<std::pair<TypeNode*, size_t>, std::unique_ptr<ArrayTypeNode>, ArrayKeyHash> arrayTypes;
+    std::mutex arrayTypesMutex; // 配列型は関数本体の並列な解析中にも作られる
+    // よく使う基本型
+    BasicTypeNode* intType;
+    BasicTypeNode* floatType;
+    BasicTypeNode* boolType;
+    BasicTypeNode* voidType;
+    // 型が決まらなかった式の型 (名前で引けないように表には入れない。ポインタの比較だけで判定する)
+    std::unique_ptr<BasicTypeNode> unknownType;
+public:
+    TypeContext();
+    // 名前に対応する基本型 (なければ作る。構文解析中にメインスレッドだけで呼ぶこと)
+    BasicTypeNode* getBasicType(std::string_view name);
+    // 言語の組み込みの基本型 (int, i32, char, float, f32, bool, void) だけを返す (それ以外はnullptr)
+    BasicTypeNode* lookupBuiltinType(std::string_view name) const;
+    // 要素の型と長さに対応する配列型 (なければ作る。複数のスレッドから呼んでよい)
+    ArrayTypeNode* getArrayType(TypeNode* elementType, size_t size);
+    BasicTypeNode* getIntType() const {return intType;}
+    BasicTypeNode* getFloatType() const {return floatType;}
+    BasicTypeNode* getBoolType() const {return boolType;}
+    BasicTypeNode* getVoidType() const {return voidType;}
+    BasicTypeNode* getUnknownType() const {return unknownType.get();}
+    size_t getTypeCount() const {return basicTypes.size() + arrayTypes.size();}
+};
@@ -1,13 +1,14 @@
 #include "TypeTranslate.h"
 #include "mir/MIRType.h"
 #include "types/Type.h"
+#include "types/TypeContext.h"
 #include <llvm-18/llvm/IR/DerivedTypes.h>
 #include <llvm-18/llvm/IR/IRBuilder.h>
 #include <memory>
 
 llvm::Type* TypeTranslate::toLlvmType(TypeNode *type, llvm::LLVMContext &context){
     if(!type) return nullptr;
-    std::string typeName = type->getTypeName();
+    const std::string& typeName = type->getTypeName();
     if(typeName == "int") return llvm::Type::getInt64Ty(context);
     if(typeName == "i32") return llvm::Type::getInt32Ty(context);
     if(typeName == "char") return llvm::Type::getInt8Ty(context);
@@ -19,22 +20,13 @@ llvm::Type* TypeTranslate::toLlvmType(TypeNode *type, llvm::LLVMContext &context
     return nullptr;
 }
 
-llvm::Type* TypeTranslate::toLlvmType(MIRType* mirType, llvm::LLVMContext &context){
+llvm::Type* TypeTranslate::toLlvmType(const MIRType* mirType, llvm::LLVMContext &context){
     if(!mirType) return llvm::Type::getVoidTy(context);
     switch(mirType->id){
-        case MIRType::TypeID::Int:{
-            if(mirType->name == "char") return llvm::Type::getInt8Ty(context);
-            if(mirType->name == "bool") return llvm::Type::getInt1Ty(context);
-            if(mirType->name == "i32") return llvm::Type::getInt32Ty(context);
-            if(mirType->name == "i64") return llvm::Type::getInt64Ty(context);
-            if(mirType->name == "int") return llvm::Type::getInt64Ty(context);
-            return llvm::Type::getInt64Ty(context);
-        }
-        case MIRType::TypeID::Float:{
-            if(mirType->name == "f32") return llvm::Type::getFloatTy(context);
-            if(mirType->name == "float") return llvm::Type::getDoubleTy(context);
-            return llvm::Type::getDoubleTy(context);
-        }
+        case MIRType::TypeID::Int:
+            return llvm::Type::getIntNTy(context, mirType->bitWidth);
+        case MIRType::TypeID::Float:
+            return mirType->bitWidth == 32 ? llvm::Type::getFloatTy(context) : llvm::Type::getDoubleTy(context);
         case MIRType::TypeID::Bool:
             return llvm::Type::getInt1Ty(context);
         case MIRType::TypeID::Void:
@@ -50,10 +42,10 @@ llvm::Type* TypeTranslate::toLlvmType(MIRType* mirType, llvm::LLVMContext &conte
             return st;
         }
         case MIRType::TypeID::Ptr:
-            // TODO: 型名をつけたポインタを返すようにする
-            return llvm::PointerType::getInt8Ty(context);
+            // LLVMのポインタは指す先の型を持たない
+            return llvm::PointerType::get(context, 0);
         case MIRType::TypeID::Array: {
-            llvm::Type* llvmElementType = toLlvmType(mirType->elementType.get(), context);
+            llvm::Type* llvmElementType = toLlvmType(mirType->elementType, context);
             if (!llvmElementType) {
                 // エラーハンドリング
                 return llvm::Type::getVoidTy(context);
@@ -69,63 +61,31 @@ llvm::Type* TypeTranslate::toLlvmType(MIRType* mirType, llvm::LLVMContext &conte
     }
 }
 
-std::shared_ptr<MIRType> TypeTranslate::toMirType(TypeNode* typeNode){
+MIRType* TypeTranslate::toMirType(TypeNode* typeNode, MIRTypeContext& types){
     if(!typeNode){
-        return std::make_shared<MIRType>(MIRType::TypeID::Void);
+        return types.getVoidType();
     }
-    std::string typeName = typeNode->getTypeName();
-
-    // 配列型の場合の処理 (例: "int[5]")
-    size_t bracketPos = typeName.find('[');
-    if (bracketPos != std::string::npos) {
-        std::string baseTypeName = typeName.substr(0, bracketPos);
-        std::string sizeStr = typeName.substr(bracketPos + 1, typeName.length() - bracketPos - 2);
-        size_t arraySize = 0;
-        try {
-            arraySize = std::stoul(sizeStr);
-        } catch (const std::exception& e) {
-            // エラーハンドリング
-            return std::make_shared<MIRType>(MIRType::TypeID::Unknown);
-        }
-
-        // 配列の要素型を再帰的に取得
-        std::shared_ptr<MIRType> elemType = nullptr;
-        if(baseTypeName == "int") elemType = std::make_shared<MIRType>(MIRType::TypeID::Int, "int");
-        else if(baseTypeName == "i32") elemType = std::make_shared<MIRType>(MIRType::TypeID::Int, "i32");
-        else if(baseTypeName == "float") elemType = std::make_shared<MIRType>(MIRType::TypeID::Float, "float");
-        else if(baseTypeName == "f32") elemType = std::make_shared<MIRType>(MIRType::TypeID::Float, "f32");
-        else if(baseTypeName == "bool") elemType = std::make_shared<MIRType>(MIRType::TypeID::Bool, "bool");
-        else if(baseTypeName == "void") elemType = std::make_shared<MIRType>(MIRType::TypeID::Void, "void");
-
-        if (elemType) {
-            return std::make_shared<MIRType>(elemType, arraySize); // 配列型コンストラクタを使用
-        }
+    if(MIRType* cached = types.lookupAstType(typeNode)) return cached;
+    MIRType* result = types.getUnknownType();
+    if(typeNode->getKind() == TypeKind::Array){
+        // 配列型は要素の型を再帰的に変換する (型名を解析しなくても要素の型と長さを持っている)
+        auto* arrayType = static_cast<ArrayTypeNode*>(typeNode);
+        result = types.getArrayType(toMirType(arrayType->elementType, types), arrayType->size);
+    }else{
+        // 基本型 (ASTの型は一意なので、名前を見るのは型ごとに1回だけ)
+        const std::string& typeName = typeNode->getTypeName();
+        if(typeName == "int") result = types.getIntType(64);
+        else if(typeName == "i32") result = types.getIntType(32);
+        else if(typeName == "char") result = types.getIntType(8);
+        else if(typeName == "float") result = types.getFloatType(64);
+        else if(typeName == "f32") result = types.getFloatType(32);
+        else if(typeName == "bool") result = types.getBoolType();
+        else if(typeName == "void") result = types.getVoidType();
     }
-
-    // 基本型の処理
-    if(typeName == "int") return std::make_shared<MIRType>(MIRType::TypeID::Int, "int");
-    if(typeName == "i32") return std::make_shared<MIRType>(MIRType::TypeID::Int, "i32");
-    if(typeName == "float") return std::make_shared<MIRType>(MIRType::TypeID::Float, "float");
-    if(typeName == "f32") return std::make_shared<MIRType>(MIRType::TypeID::Float, "f32");
-    if(typeName == "bool") return std::make_shared<MIRType>(MIRType::TypeID::Bool, "bool");
-    if(typeName == "void") return std::make_shared<MIRType>(MIRType::TypeID::Void, "void");
-
-    if(auto* arrayType = dynamic_cast<ArrayTypeNode*>(typeNode)){
-        auto elemType = toMirType(arrayType->arrType.get());
-        size_t size = arrayType->size;
-        return std::make_shared<MIRType>(elemType, size);
-    }
-    // ポインタ用?
-    // if(auto* ptrType = dynamic_cast<PointerTypeNode*>(typeNode)) {
-    //     auto pointeeType = toMirType(ptrType->pointeeType);
-    //     return std::make_shared<MIRType>(pointeeType);
-    // }
-    return std::make_shared<MIRType>(MIRType::TypeID::Unknown);
+    types.cacheAstType(typeNode, result);
+    return result;
 }
 
-std::shared_ptr<TypeNode> TypeTranslate::toTypeNode(const std::string& typeName){
-    if(typeName == "int" || typeName == "i32" || typeName == "char" || 
-       typeName == "float" || typeName == "f32" || typeName == "bool" ||
-       typeName == "void") return std::make_shared<BasicTypeNode>(typeName);
-    return nullptr;
+TypeNode* TypeTranslate::toTypeNode(const std::string& typeName, const TypeContext& types){
+    return types.lookupBuiltinType(typeName);
 }
\ No newline at end of file
@@ -1,13 +1,17 @@
 #pragma once
 #include "mir/MIRType.h"
+#include "mir/MIRTypeContext.h"
 #include "types/Type.h"
+#include "types/TypeContext.h"
 #include <llvm/IR/Type.h>
 #include <llvm/IR/LLVMContext.h>
 
 class TypeTranslate{
 public:
     static llvm::Type* toLlvmType(TypeNode* type, llvm::LLVMContext& context);
-    static llvm::Type* toLlvmType(MIRType* mirType, llvm::LLVMContext& context);
-    static std::shared_ptr<MIRType> toMirType(TypeNode* type);
-    static std::shared_ptr<TypeNode> toTypeNode(const std::string& typeName);
+    // 型の形(ビット数・要素の型・長さ)だけから作る。同じ型を何度も変換する場合はLLVMGen::toLlvmTypeのキャッシュを使う
+    static llvm::Type* toLlvmType(const MIRType* mirType, llvm::LLVMContext& context);
+    // 変換結果はtypesに覚えておくので、同じASTの型は2回目から表を引くだけ
+    static MIRType* toMirType(TypeNode* type, MIRTypeContext& types);
+    static TypeNode* toTypeNode(const std::string& typeName, const TypeContext& types);
 };
\ No newline at end of file
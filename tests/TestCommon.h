@@ -0,0 +1,20 @@
+#pragma once
+#include <iostream>
+
+// テスト用の簡単なチェック
+// 失敗した条件と場所を表示して数え、main の最後で testResult() を返す
+inline int testFailures = 0;
+
+#define EXPECT(cond) \
+    do{ \
+        if(!(cond)){ \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": EXPECT(" #cond ") failed\n"; \
+            testFailures++; \
+        } \
+    }while(0)
+
+inline int testResult(){
+    if(testFailures == 0) std::cout << "All checks passed." << std::endl;
+    else std::cerr << testFailures << " check(s) failed." << std::endl;
+    return testFailures == 0 ? 0 : 1;
+}
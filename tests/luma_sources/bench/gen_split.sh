@@ -0,0 +1,16 @@
+#!/bin/sh
+# -jit-threads のベンチマーク用に、関数をN個(既定10000)持つプログラムを作る
+# 各関数は次の関数を呼ぶので、mainから全部の関数が使われる
+# 使い方: sh tests/luma_sources/bench/gen_split.sh [N] > split.luma
+N=${1:-10000}
+awk -v n="$N" 'BEGIN{
+    for(i = 0; i < n; i++){
+        printf "fn split%d(a: int, b: int) = int{\n", i
+        printf "    var x = a * %d + b;\n", i % 97 + 1
+        printf "    if x > 1000{\n        x = x - b * 2;\n    } else {\n        x = x + a;\n    }\n"
+        if(i + 1 < n) printf "    return x + split%d(b, a) / 1000;\n", i + 1
+        else printf "    return x;\n"
+        printf "}\n\n"
+    }
+    printf "fn main() = int{\n    return split0(3, 5);\n}\n"
+}'
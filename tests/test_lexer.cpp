@@ -0,0 +1,92 @@
+// FastLexerのトークン列がANTLRのLumaLexerと1トークンずつ一致するかのテスト
+// tests/luma_sources以下の全ファイルと、手書きの境界ケースを確かめる
+#include "TestCommon.h"
+#include "LumaLexer.h"
+#include "antlr4-runtime.h"
+#include "lexer/FastLexer.h"
+#include "lexer/FastTokenSource.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// ANTLRのLumaLexerが報告するエラーの数
+static size_t antlrErrorCount(const std::string& source){
+    antlr4::ANTLRInputStream input(source);
+    Luma::LumaLexer lexer(&input);
+    lexer.removeErrorListeners();
+    lexer.getAllTokens();
+    return lexer.getNumberOfSyntaxErrors();
+}
+
+// トークン列とエラーの数が一致すればtrue
+static bool checkSource(const std::string& name, const std::string& source){
+    FastLexer lexer(source);
+    std::vector<LexToken> tokens = lexer.tokenize();
+    std::ostringstream log;
+    bool ok = FastTokenSource::crossCheck(source, tokens, log);
+    size_t antlrErrors = antlrErrorCount(source);
+    if(lexer.getErrorCount() != antlrErrors){
+        log << "Error count mismatch: fast " << lexer.getErrorCount() << ", antlr " << antlrErrors << "\n";
+        ok = false;
+    }
+    if(!ok) std::cerr << "[" << name << "] " << log.str();
+    return ok;
+}
+
+static std::string readFile(const std::filesystem::path& path){
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+int main(){
+    // tests/luma_sources以下のファイル
+    size_t fileCount = 0;
+    for(const auto& entry : std::filesystem::recursive_directory_iterator(LUMA_SOURCES_DIR)){
+        if(!entry.is_regular_file() || entry.path().extension() != ".luma") continue;
+        fileCount++;
+        EXPECT(checkSource(entry.path().string(), readFile(entry.path())));
+    }
+    EXPECT(fileCount > 0);
+
+    // 境界ケース
+    const std::vector<std::pair<std::string, std::string>> cases = {
+        {"empty", ""},
+        {"only whitespace", " \t\n\r\n  "},
+        // 符号付きリテラルは演算子より長く一致する
+        {"signed literals", "a-1 a - -1 +2 -3.5 +0.25 1-2 x=-7 y+-8"},
+        {"decimal without fraction", "1. 2.x .5 -. 3..4"},
+        // キーワードで始まる識別子
+        {"keyword prefixes", "iff forx varx lets elsee fnx returns asx int64 i32x floaty f32a chars ifelse"},
+        {"keywords", "var let if else for fn return as int i32 float f32 char"},
+        {"operators", "= == != > >= < <= + - * / : ; , ( ) { } [ ] ===<=>="},
+        // 認識できない文字 (!は次の文字ごと読み飛ばされる)
+        {"bad characters", "var a = 1 $ 2; b @ c # d ! e !x !"},
+        {"bad character at end", "a = 1;\n?"},
+        {"multibyte", "var あ = 1; b = \"い\"; c = 3;"},
+        {"CRLF", "var a = 1;\r\nvar b = 2;\r\nif a < b {\r\n    a = b;\r\n}\r\n"},
+        {"lone CR", "a\rb\r\rc = 1;"},
+        {"tabs", "\tvar\ta\t=\t1;\n\t\tb"},
+        {"no trailing newline", "fn main() = int{ return 0; }"},
+    };
+    for(const auto& [name, source] : cases){
+        EXPECT(checkSource(name, source));
+    }
+
+    // SSE2は16バイトずつ読むので、空白・識別子・数字の列がチャンクの境界をまたぐ長さと、
+    // ファイルの末尾がチャンクの途中で終わる長さをすべて試す
+    for(size_t length = 1; length <= 48; length++){
+        std::string run(length, 'a');
+        std::string digits(length, '7');
+        std::string spaces(length, ' ');
+        EXPECT(checkSource("identifier " + std::to_string(length), run));
+        EXPECT(checkSource("digits " + std::to_string(length), digits));
+        EXPECT(checkSource("spaces " + std::to_string(length), "x" + spaces + "y" + spaces));
+        EXPECT(checkSource("mixed " + std::to_string(length), "var " + run + "1 = -" + digits + "." + digits + ";" + spaces));
+        EXPECT(checkSource("bad tail " + std::to_string(length), run + "$"));
+    }
+    return testResult();
+}
@@ -0,0 +1,303 @@
+// MIRの制御フロー解析(MIRCFGAnalysis)のテスト
+// 手で組み立てたMIRFunctionで、支配木・支配辺境・ループ・後支配木・キャッシュの作り直しを確かめる
+#include "TestCommon.h"
+#include "mir/MIRCFGAnalysis.h"
+#include "mir/MIRFunction.h"
+#include "mir/MIRTypeContext.h"
+#include <llvm/Support/Casting.h>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+// テスト用の関数を組み立てる
+class FunctionBuilder{
+private:
+    MIRTypeContext& types;
+public:
+    MIRFunction function;
+    explicit FunctionBuilder(MIRTypeContext& typeContext) : types(typeContext), function(NameId(), typeContext.getVoidType()) {}
+    std::shared_ptr<MIRBasicBlock> block(const char* name){
+        auto bb = std::make_shared<MIRBasicBlock>(name);
+        function.addBasicBlock(bb);
+        return bb;
+    }
+    void br(const std::shared_ptr<MIRBasicBlock>& from, const std::shared_ptr<MIRBasicBlock>& to){
+        from->setTerminator(std::make_shared<MIRBranchInstruction>(to));
+    }
+    void condBr(const std::shared_ptr<MIRBasicBlock>& from, const std::shared_ptr<MIRBasicBlock>& trueBlock, const std::shared_ptr<MIRBasicBlock>& falseBlock){
+        auto cond = std::make_shared<MIRLiteralValue>(types.getBoolType(), "true");
+        from->setTerminator(std::make_shared<MIRConditionBranchInstruction>(cond, trueBlock, falseBlock));
+    }
+    void ret(const std::shared_ptr<MIRBasicBlock>& from){
+        from->setTerminator(std::make_shared<MIRReturnInstruction>());
+    }
+};
+
+static bool sameBlocks(std::vector<MIRBasicBlock*> actual, std::vector<MIRBasicBlock*> expected){
+    std::sort(actual.begin(), actual.end());
+    std::sort(expected.begin(), expected.end());
+    return actual == expected;
+}
+
+// entry -> (then | else) -> merge
+static void testDiamond(MIRTypeContext& types){
+    FunctionBuilder b(types);
+    auto entry = b.block("entry");
+    auto thenBlock = b.block("if.then");
+    auto elseBlock = b.block("if.else");
+    auto merge = b.block("if.end");
+    b.condBr(entry, thenBlock, elseBlock);
+    b.br(thenBlock, merge);
+    b.br(elseBlock, merge);
+    b.ret(merge);
+
+    MIRFunctionAnalysis analysis(b.function);
+    const MIRCFG& cfg = analysis.getCFG();
+    EXPECT(cfg.getReversePostOrder().size() == 4);
+    EXPECT(cfg.getReversePostOrder().front() == entry.get());
+    EXPECT(cfg.getReversePostOrder().back() == merge.get());
+    EXPECT(sameBlocks(cfg.getPredecessors(merge.get()), {thenBlock.get(), elseBlock.get()}));
+
+    const MIRDominatorTree& dom = analysis.getDominatorTree();
+    EXPECT(dom.getImmediateDominator(entry.get()) == nullptr);
+    EXPECT(dom.getImmediateDominator(thenBlock.get()) == entry.get());
+    EXPECT(dom.getImmediateDominator(elseBlock.get()) == entry.get());
+    EXPECT(dom.getImmediateDominator(merge.get()) == entry.get());
+    EXPECT(dom.dominates(entry.get(), merge.get()));
+    EXPECT(!dom.dominates(thenBlock.get(), merge.get()));
+    EXPECT(dom.dominates(merge.get(), merge.get()));
+    EXPECT(!dom.properlyDominates(merge.get(), merge.get()));
+
+    const MIRDominanceFrontier& df = analysis.getDominanceFrontier();
+    EXPECT(sameBlocks(df.getFrontier(thenBlock.get()), {merge.get()}));
+    EXPECT(sameBlocks(df.getFrontier(elseBlock.get()), {merge.get()}));
+    EXPECT(df.getFrontier(entry.get()).empty());
+    EXPECT(df.getFrontier(merge.get()).empty());
+
+    const MIRDominatorTree& postDom = analysis.getPostDominatorTree();
+    EXPECT(postDom.isPostDominatorTree());
+    EXPECT(sameBlocks(postDom.getRoots(), {merge.get()}));
+    EXPECT(postDom.getImmediateDominator(entry.get()) == merge.get());
+    EXPECT(postDom.getImmediateDominator(thenBlock.get()) == merge.get());
+    EXPECT(postDom.dominates(merge.get(), entry.get()));
+    EXPECT(!postDom.dominates(thenBlock.get(), entry.get()));
+
+    EXPECT(analysis.getLoops().getLoopCount() == 0);
+}
+
+// MIRGenのforと同じ形の二重ループ
+// entry -> outer.cond -> outer.body -> inner.cond -> inner.body -> inner.inc -> inner.cond
+//                                                 -> inner.end -> outer.inc -> outer.cond
+//       outer.cond -> outer.end
+static void testNestedLoops(MIRTypeContext& types){
+    FunctionBuilder b(types);
+    auto entry = b.block("entry");
+    auto outerCond = b.block("for.cond");
+    auto outerBody = b.block("for.body");
+    auto innerCond = b.block("for.cond");
+    auto innerBody = b.block("for.body");
+    auto innerInc = b.block("for.inc");
+    auto innerEnd = b.block("for.end");
+    auto outerInc = b.block("for.inc");
+    auto outerEnd = b.block("for.end");
+    b.br(entry, outerCond);
+    b.condBr(outerCond, outerBody, outerEnd);
+    b.br(outerBody, innerCond);
+    b.condBr(innerCond, innerBody, innerEnd);
+    b.br(innerBody, innerInc);
+    b.br(innerInc, innerCond);
+    b.br(innerEnd, outerInc);
+    b.br(outerInc, outerCond);
+    b.ret(outerEnd);
+
+    MIRFunctionAnalysis analysis(b.function);
+    const MIRLoopForest& loops = analysis.getLoops();
+    EXPECT(loops.getLoopCount() == 2);
+    EXPECT(loops.getTopLevelLoops().size() == 1);
+
+    MIRLoop* outer = loops.getLoopFor(outerCond.get());
+    MIRLoop* inner = loops.getLoopFor(innerCond.get());
+    EXPECT(outer && inner && outer != inner);
+    if(!outer || !inner) return;
+    EXPECT(outer->header == outerCond.get());
+    EXPECT(inner->header == innerCond.get());
+    EXPECT(outer->parent == nullptr);
+    EXPECT(inner->parent == outer);
+    EXPECT(outer->subLoops.size() == 1 && outer->subLoops[0] == inner);
+    EXPECT(outer->depth == 1);
+    EXPECT(inner->depth == 2);
+    EXPECT(sameBlocks(outer->latches, {outerInc.get()}));
+    EXPECT(sameBlocks(inner->latches, {innerInc.get()}));
+    EXPECT(outer->blocks.front() == outerCond.get());
+    EXPECT(sameBlocks(inner->blocks, {innerCond.get(), innerBody.get(), innerInc.get()}));
+    EXPECT(outer->blocks.size() == 7);
+    EXPECT(outer->contains(innerBody.get()));
+    EXPECT(!outer->contains(outerEnd.get()));
+    EXPECT(!inner->contains(innerEnd.get()));
+
+    EXPECT(loops.getLoopDepth(entry.get()) == 0);
+    EXPECT(loops.getLoopDepth(outerBody.get()) == 1);
+    EXPECT(loops.getLoopDepth(innerEnd.get()) == 1);
+    EXPECT(loops.getLoopDepth(innerBody.get()) == 2);
+    EXPECT(loops.getLoopDepth(outerEnd.get()) == 0);
+    EXPECT(loops.getLoopFor(innerInc.get()) == inner);
+    EXPECT(loops.getLoopFor(outerInc.get()) == outer);
+    EXPECT(loops.isLoopHeader(outerCond.get()));
+    EXPECT(loops.isLoopHeader(innerCond.get()));
+    EXPECT(!loops.isLoopHeader(innerBody.get()));
+
+    const MIRDominanceFrontier& df = analysis.getDominanceFrontier();
+    EXPECT(sameBlocks(df.getFrontier(innerInc.get()), {innerCond.get()}));
+    EXPECT(sameBlocks(df.getFrontier(innerCond.get()), {outerCond.get(), innerCond.get()}));
+}
+
+// 自分自身に戻る辺を持つブロック
+// entry -> loop -> (loop | exit)
+static void testSelfLoop(MIRTypeContext& types){
+    FunctionBuilder b(types);
+    auto entry = b.block("entry");
+    auto loop = b.block("loop");
+    auto exit = b.block("exit");
+    b.br(entry, loop);
+    b.condBr(loop, loop, exit);
+    b.ret(exit);
+
+    MIRFunctionAnalysis analysis(b.function);
+    const MIRCFG& cfg = analysis.getCFG();
+    EXPECT(sameBlocks(cfg.getPredecessors(loop.get()), {entry.get(), loop.get()}));
+
+    const MIRLoopForest& loops = analysis.getLoops();
+    EXPECT(loops.getLoopCount() == 1);
+    MIRLoop* selfLoop = loops.getLoopFor(loop.get());
+    EXPECT(selfLoop != nullptr);
+    if(!selfLoop) return;
+    EXPECT(selfLoop->header == loop.get());
+    EXPECT(sameBlocks(selfLoop->latches, {loop.get()}));
+    EXPECT(sameBlocks(selfLoop->blocks, {loop.get()}));
+    EXPECT(selfLoop->depth == 1);
+    EXPECT(loops.getLoopFor(exit.get()) == nullptr);
+
+    EXPECT(sameBlocks(analysis.getDominanceFrontier().getFrontier(loop.get()), {loop.get()}));
+    EXPECT(analysis.getDominatorTree().getImmediateDominator(exit.get()) == loop.get());
+}
+
+// エントリーから辿れないブロック
+// entry -> exit、dead -> exit
+static void testUnreachableBlock(MIRTypeContext& types){
+    FunctionBuilder b(types);
+    auto entry = b.block("entry");
+    auto exit = b.block("exit");
+    auto dead = b.block("dead");
+    b.br(entry, exit);
+    b.br(dead, exit);
+    b.ret(exit);
+
+    MIRFunctionAnalysis analysis(b.function);
+    const MIRCFG& cfg = analysis.getCFG();
+    EXPECT(cfg.getBlockCount() == 3);
+    EXPECT(cfg.isReachable(entry.get()));
+    EXPECT(!cfg.isReachable(dead.get()));
+    EXPECT(cfg.getRpoIndex(dead.get()) == MIRCFG::NoIndex);
+    EXPECT(cfg.getReversePostOrder().size() == 2);
+    EXPECT(sameBlocks(cfg.getPredecessors(exit.get()), {entry.get(), dead.get()}));
+
+    const MIRDominatorTree& dom = analysis.getDominatorTree();
+    EXPECT(!dom.contains(dead.get()));
+    EXPECT(dom.getImmediateDominator(dead.get()) == nullptr);
+    EXPECT(!dom.dominates(entry.get(), dead.get()));
+    EXPECT(!dom.dominates(dead.get(), exit.get()));
+    // 辿れない先行ブロックがあっても、exitの直接の支配ブロックはentryのまま
+    EXPECT(dom.getImmediateDominator(exit.get()) == entry.get());
+    EXPECT(analysis.getDominanceFrontier().getFrontier(dead.get()).empty());
+    EXPECT(analysis.getLoops().getLoopCount() == 0);
+
+    // 後支配木では出口に辿り着けるので木に入る
+    const MIRDominatorTree& postDom = analysis.getPostDominatorTree();
+    EXPECT(postDom.contains(dead.get()));
+    EXPECT(postDom.getImmediateDominator(dead.get()) == exit.get());
+}
+
+// 出口に辿り着けない無限ループ
+// entry -> (loop | exit)、loop -> loop
+static void testInfiniteLoop(MIRTypeContext& types){
+    FunctionBuilder b(types);
+    auto entry = b.block("entry");
+    auto loop = b.block("loop");
+    auto exit = b.block("exit");
+    b.condBr(entry, loop, exit);
+    b.br(loop, loop);
+    b.ret(exit);
+
+    MIRFunctionAnalysis analysis(b.function);
+    const MIRDominatorTree& postDom = analysis.getPostDominatorTree();
+    EXPECT(!postDom.contains(loop.get()));
+    EXPECT(postDom.contains(entry.get()));
+    EXPECT(postDom.contains(exit.get()));
+    EXPECT(postDom.getImmediateDominator(loop.get()) == nullptr);
+    EXPECT(postDom.getImmediateDominator(entry.get()) == exit.get());
+    EXPECT(!postDom.dominates(exit.get(), loop.get()));
+    EXPECT(!postDom.dominates(loop.get(), loop.get()));
+    EXPECT(sameBlocks(postDom.getRoots(), {exit.get()}));
+    EXPECT(sameBlocks(analysis.getCFG().getExitBlocks(), {exit.get()}));
+
+    // 前向きの支配木とループには普通に入る
+    EXPECT(analysis.getDominatorTree().getImmediateDominator(loop.get()) == entry.get());
+    EXPECT(analysis.getLoops().isLoopHeader(loop.get()));
+}
+
+// CFGを変えるとMIRFunctionAnalysisが結果を作り直す
+static void testAnalysisRebuild(MIRTypeContext& types){
+    FunctionBuilder b(types);
+    auto entry = b.block("entry");
+    auto thenBlock = b.block("if.then");
+    auto elseBlock = b.block("if.else");
+    auto merge = b.block("if.end");
+    b.condBr(entry, thenBlock, elseBlock);
+    b.br(thenBlock, merge);
+    b.br(elseBlock, merge);
+    b.ret(merge);
+
+    MIRFunctionAnalysis analysis(b.function);
+    EXPECT(analysis.getCFG().getSuccessors(entry.get()).size() == 2);
+    EXPECT(analysis.getDominatorTree().getImmediateDominator(merge.get()) == entry.get());
+    EXPECT(analysis.getLoops().getLoopCount() == 0);
+
+    // setTerminator: elseに行かなくなるとmergeの直接の支配ブロックはthenになる
+    uint64_t version = b.function.cfgVersion;
+    b.br(entry, thenBlock);
+    EXPECT(b.function.cfgVersion != version);
+    EXPECT(analysis.getCFG().getSuccessors(entry.get()).size() == 1);
+    EXPECT(!analysis.getCFG().isReachable(elseBlock.get()));
+    EXPECT(analysis.getDominatorTree().getImmediateDominator(merge.get()) == thenBlock.get());
+    EXPECT(analysis.getDominanceFrontier().getFrontier(thenBlock.get()).empty());
+
+    // addBasicBlock: merge -> loop -> (loop | else) にするとブロック数とループが増える (elseは出口にする)
+    auto loop = b.block("loop");
+    EXPECT(analysis.getCFG().getBlockCount() == 5);
+    b.br(merge, loop);
+    b.ret(elseBlock);
+    b.condBr(loop, loop, elseBlock);
+    EXPECT(analysis.getCFG().isReachable(loop.get()));
+    EXPECT(analysis.getCFG().isReachable(elseBlock.get()));
+    EXPECT(analysis.getLoops().getLoopCount() == 1);
+    EXPECT(analysis.getLoops().isLoopHeader(loop.get()));
+    EXPECT(analysis.getDominatorTree().getImmediateDominator(elseBlock.get()) == loop.get());
+
+    // invalidateCFG: setTerminatorを通さずに分岐先を書き換えたとき
+    auto* branch = llvm::cast<MIRConditionBranchInstruction>(loop->terminator.get());
+    branch->trueBlock = elseBlock;
+    b.function.invalidateCFG();
+    EXPECT(analysis.getLoops().getLoopCount() == 0);
+    EXPECT(analysis.getCFG().getSuccessors(loop.get()).size() == 1);
+}
+
+int main(){
+    MIRTypeContext types;
+    testDiamond(types);
+    testNestedLoops(types);
+    testSelfLoop(types);
+    testUnreachableBlock(types);
+    testInfiniteLoop(types);
+    testAnalysisRebuild(types);
+    return testResult();
+}